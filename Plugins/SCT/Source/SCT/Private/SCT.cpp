@@ -22,12 +22,14 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #include "SCT.h"
+#include "SCTMemory.h"
 
 #define LOCTEXT_NAMESPACE "FSCTLiveLinkModule"
 
 void FSCTModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+	kh::RegisterLLMTags();
 }
 
 void FSCTModule::ShutdownModule()
@@ -0,0 +1,697 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTBenchmarkCommandlet.h"
+#include "SCTCaptureWriter.h"
+#include "SCTPosePredictor.h"
+#include "SCTProtocol.h"
+#include "SCTSkeletonLayout.h"
+#include "SCTSpatialSkeletonAsset.h"
+#include "SpatialDataDeserializer.h"
+
+#include "Dom/JsonObject.h"
+#include "Math/RandomStream.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "UObject/Package.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSCTBenchmark, Log, All);
+
+static constexpr int32 BenchmarkFileVersion = 1;
+static constexpr int32 MinIterations = 3;
+static constexpr int32 BulkBlockSize = 4096;
+
+// Results are summed into this so the reads can't be optimized away
+static volatile float BenchmarkSink = 0.0f;
+
+struct FBenchmarkResult
+{
+	FString Name;
+	FString Unit;
+	int64 Items = 0;
+	int64 Bytes = 0;
+	int32 Iterations = 0;
+	double BestSeconds = TNumericLimits<double>::Max();
+
+	double GetItemsPerSecond() const { return Items / BestSeconds; }
+	double GetMBPerSecond() const { return Bytes / BestSeconds / (1024.0 * 1024.0); }
+};
+
+struct FPredictionResult
+{
+	FString Name;
+	FString Model;
+	double Delay = 0.0;
+	int32 Samples = 0;
+	double MeanPositionError = 0.0;
+	double P95PositionError = 0.0;
+	double MeanRotationError = 0.0;
+	double P95RotationError = 0.0;
+};
+
+struct FBenchmarkSize
+{
+	const TCHAR* Name;
+	bool bLarge;
+};
+
+// A hand held camera walking around, in device space (meters, radians), with a little tracking noise
+static void WriteCameraFrame(kh::FCaptureWriter& Writer, int32 Frame, FRandomStream& Random)
+{
+	const double Time = Frame / 60.0;
+	const FVector Noise(Random.FRandRange(-0.001f, 0.001f), Random.FRandRange(-0.001f, 0.001f), Random.FRandRange(-0.001f, 0.001f));
+	const FVector Position = FVector(FMath::Sin(Time * 0.7) * 1.5f, 1.4f + FMath::Sin(Time * 3.1) * 0.05f, FMath::Cos(Time * 0.5) * 1.5f) + Noise;
+	const FVector Rotation(FMath::Sin(Time * 0.9) * 0.2f, Time * 0.35f + FMath::Sin(Time * 1.7) * 0.3f, FMath::Sin(Time * 2.3) * 0.05f);
+
+	Writer.CameraFrame(Time, Position, Rotation, 0.0f, 1.0 / 120.0);
+}
+
+static void WriteSkeletonFrame(kh::FCaptureWriter& Writer, int32 Frame, int32 JointCount)
+{
+	const float Time = Frame / 60.0f;
+	TArray<FMatrix, TInlineAllocator<64>> Joints;
+	for (int32 i = 0; i < JointCount; ++i)
+	{
+		const FQuat Rotation(FVector(FMath::Sin(i * 1.3f), FMath::Cos(i * 0.7f), 0.5f).GetSafeNormal(), 0.8f * FMath::Sin(Time * 2.0f + i));
+		Joints.Add(FTransform(Rotation, FVector(i * 0.05f, 1.0f + FMath::Sin(Time + i) * 0.1f, 0.0f)).ToMatrixWithScale());
+	}
+	Writer.SkeletonFrame(Joints.GetData(), JointCount, 1);
+}
+
+static TArray<FName> MakeJointNames(int32 JointCount)
+{
+	TArray<FName> Names;
+	for (int32 i = 0; i < JointCount; ++i)
+	{
+		Names.Add(FName(*FString::Printf(TEXT("joint_%d"), i)));
+	}
+	return Names;
+}
+
+template<typename FunctionType>
+static FBenchmarkResult RunBenchmark(const FString& Name, const TCHAR* Unit, int64 Items, int64 Bytes, double MinTime, FunctionType&& Function)
+{
+	FBenchmarkResult Result;
+	Result.Name = Name;
+	Result.Unit = Unit;
+	Result.Items = Items;
+	Result.Bytes = Bytes;
+
+	// Warm up once, then keep the fastest iteration, the one least disturbed by the rest of the machine
+	Function();
+
+	const double StartTime = FPlatformTime::Seconds();
+	do
+	{
+		const double IterationStart = FPlatformTime::Seconds();
+		Function();
+		Result.BestSeconds = FMath::Min(Result.BestSeconds, FMath::Max(FPlatformTime::Seconds() - IterationStart, 1e-9));
+		++Result.Iterations;
+	}
+	while (Result.Iterations < MinIterations || FPlatformTime::Seconds() - StartTime < MinTime);
+
+	UE_LOG(LogSCTBenchmark, Display, TEXT("%-32s %14.0f %s/s %10.1f MB/s (%d iterations)"), *Name, Result.GetItemsPerSecond(), Unit, Result.GetMBPerSecond(), Result.Iterations);
+	return Result;
+}
+
+static void RunThroughputBenchmarks(const FString& Filter, const TArray<FBenchmarkSize>& Sizes, double MinTime, TArray<FBenchmarkResult>& OutResults)
+{
+	const int32 JointCount = kh::FSCTBodySkeletonLayout::JointCount;
+	const int32 SkeletonFrameSize = kh::GetSkeletonFrameSize(JointCount) + kh::CameraFrameSize;
+
+	auto ShouldRun = [&Filter](const FString& Name) { return Filter.IsEmpty() || Name.Contains(Filter); };
+
+	for (const FBenchmarkSize& Size : Sizes)
+	{
+		const FString Suffix = FString(TEXT("/")) + Size.Name;
+		FRandomStream Random(1234);
+
+		FString Name = TEXT("SerializeScalar") + Suffix;
+		if (ShouldRun(Name))
+		{
+			const int32 Count = Size.bLarge ? 16 * 1024 * 1024 : 4096;
+			TArray<uint8> Bytes;
+			Bytes.Reserve(Count * sizeof(float));
+			kh::FCaptureWriter Writer(Bytes);
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Writer.Float(Random.FRand());
+			}
+
+			OutResults.Add(RunBenchmark(Name, TEXT("values"), Count, Bytes.Num(), MinTime, [&]()
+			{
+				FMRSerializeFromBuffer FromBuffer(Bytes.GetData(), Bytes.Num());
+				float Sum = 0.0f;
+				for (int32 i = 0; i < Count; ++i)
+				{
+					float Value;
+					FromBuffer >> Value;
+					Sum += Value;
+				}
+				BenchmarkSink += Sum;
+			}));
+		}
+
+		Name = TEXT("SerializeBulk") + Suffix;
+		if (ShouldRun(Name))
+		{
+			const int32 BlockCount = Size.bLarge ? 16 * 1024 : 16;
+			TArray<uint8> Bytes;
+			Bytes.SetNumZeroed(BlockCount * BulkBlockSize);
+			TArray<uint8> Block;
+			Block.SetNumUninitialized(BulkBlockSize);
+
+			OutResults.Add(RunBenchmark(Name, TEXT("blocks"), BlockCount, Bytes.Num(), MinTime, [&]()
+			{
+				FMRSerializeFromBuffer FromBuffer(Bytes.GetData(), Bytes.Num());
+				for (int32 i = 0; i < BlockCount; ++i)
+				{
+					FromBuffer.ReadBinary(Block.GetData(), BulkBlockSize);
+				}
+				BenchmarkSink += Block[0];
+			}));
+		}
+
+		Name = TEXT("TransformConversion") + Suffix;
+		if (ShouldRun(Name))
+		{
+			const int32 Count = Size.bLarge ? 1024 * 1024 : 1024;
+			TArray<uint8> Bytes;
+			Bytes.Reserve(Count * kh::SkeletonJointSize);
+			kh::FCaptureWriter Writer(Bytes);
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Writer.Matrix(FTransform(FRotator(Random.FRandRange(-180.0f, 180.0f), Random.FRandRange(-180.0f, 180.0f), 0.0f), Random.GetUnitVector()).ToMatrixWithScale());
+			}
+
+			OutResults.Add(RunBenchmark(Name, TEXT("transforms"), Count, Bytes.Num(), MinTime, [&]()
+			{
+				FMRSerializeFromBuffer FromBuffer(Bytes.GetData(), Bytes.Num());
+				FTransform Transform;
+				float Sum = 0.0f;
+				for (int32 i = 0; i < Count; ++i)
+				{
+					FromBuffer >> Transform;
+					Sum += Transform.GetRotation().W;
+				}
+				BenchmarkSink += Sum;
+			}));
+		}
+
+		Name = TEXT("DeserialiseCamera") + Suffix;
+		if (ShouldRun(Name))
+		{
+			const int32 Count = Size.bLarge ? 1000000 : 600;
+			USCTSpatialCameraAsset* Asset = NewObject<USCTSpatialCameraAsset>(GetTransientPackage());
+			Asset->AddToRoot();
+			Asset->FrameCount = Count;
+			Asset->FrameData.Reserve(Count * kh::CameraFrameSize);
+			kh::FCaptureWriter Writer(Asset->FrameData);
+			for (int32 i = 0; i < Count; ++i)
+			{
+				WriteCameraFrame(Writer, i, Random);
+			}
+
+			kh::FSpatialDataDeserializer Deserializer;
+			Deserializer.InitWithCameraAsset(Asset);
+
+			OutResults.Add(RunBenchmark(Name, TEXT("frames"), Count, Asset->FrameData.Num(), MinTime, [&]()
+			{
+				for (int32 i = 0; i < Count; ++i)
+				{
+					Deserializer.StepFrame(true);
+					Deserializer.DeserialiseCamera();
+				}
+				BenchmarkSink += Deserializer.GetCameraTransform().GetLocation().X;
+			}));
+
+			Asset->RemoveFromRoot();
+		}
+
+		Name = TEXT("DeserialiseSkeleton") + Suffix;
+		if (ShouldRun(Name))
+		{
+			const int32 Count = Size.bLarge ? 50000 : 600;
+			USCTSpatialSkeletonAsset* Asset = NewObject<USCTSpatialSkeletonAsset>(GetTransientPackage());
+			Asset->AddToRoot();
+			Asset->FrameCount = Count;
+			Asset->SkeletonDefinition.JointNames = MakeJointNames(JointCount);
+			Asset->SkeletonDefinition.ParentIndices.Append(kh::FSCTBodySkeletonLayout::ParentIndices, JointCount);
+			Asset->SkeletonDefinition.NeutralTransforms.SetNum(JointCount);
+			Asset->FrameData.Reserve(Count * SkeletonFrameSize);
+			kh::FCaptureWriter Writer(Asset->FrameData);
+			for (int32 i = 0; i < Count; ++i)
+			{
+				WriteSkeletonFrame(Writer, i, JointCount);
+				WriteCameraFrame(Writer, i, Random);
+			}
+
+			kh::FSpatialDataDeserializer Deserializer;
+			Deserializer.InitWithSkeletonAsset(Asset);
+
+			// Skeleton frames are interleaved with camera frames, so both are read like the replay pawn does
+			OutResults.Add(RunBenchmark(Name, TEXT("frames"), Count, Asset->FrameData.Num(), MinTime, [&]()
+			{
+				for (int32 i = 0; i < Count; ++i)
+				{
+					Deserializer.StepFrame(true);
+					Deserializer.DeserialiseSkeleton();
+					Deserializer.DeserialiseCamera();
+				}
+				BenchmarkSink += Deserializer.GetSkeletonTransforms().Transforms[0].GetLocation().X;
+			}));
+
+			Asset->RemoveFromRoot();
+		}
+
+		Name = TEXT("GeometryPart") + Suffix;
+		if (ShouldRun(Name))
+		{
+			// A grid, about two triangles per vertex
+			const int32 VertexCount = Size.bLarge ? 1024 * 1024 : 1024;
+			const int32 IndexCount = VertexCount * 6;
+			TArray<uint8> Bytes;
+			Bytes.Reserve(16 + VertexCount * 12 + IndexCount * 4);
+			kh::FCaptureWriter Writer(Bytes);
+			Writer.Int64(VertexCount);
+			for (int32 i = 0; i < VertexCount; ++i)
+			{
+				Writer.Vector(FVector((float)(i % 1024), 0.0f, (float)(i / 1024)) * 0.01f);
+			}
+			Writer.Int64(IndexCount);
+			for (int32 i = 0; i < IndexCount; ++i)
+			{
+				Writer.UInt32(Random.RandHelper(VertexCount));
+			}
+
+			TArray<FVector> Vertices;
+			TArray<int32> Indices;
+
+			OutResults.Add(RunBenchmark(Name, TEXT("vertices"), VertexCount, Bytes.Num(), MinTime, [&]()
+			{
+				FMRSerializeFromBuffer FromBuffer(Bytes.GetData(), Bytes.Num());
+				kh::FSpatialDataDeserializer::ReadMeshPart(FromBuffer, Vertices, Indices);
+				BenchmarkSink += Vertices.Last().X + Indices.Last();
+			}));
+		}
+	}
+}
+
+static bool LoadCameraTrack(const FString& CapturePath, TArray<double>& OutTimes, TArray<FTransform>& OutPoses)
+{
+	TArray<uint8> SyntheticFrames;
+	const TArray<uint8>* FrameData = &SyntheticFrames;
+	int32 FrameCount = 0;
+	int32 JointCount = 0;
+	const kh::FProtocolDecoder* Decoder = &kh::GetCurrentProtocolDecoder();
+
+	if (CapturePath.IsEmpty())
+	{
+		// A minute of synthetic camera motion
+		FrameCount = 3600;
+		FRandomStream Random(5678);
+		kh::FCaptureWriter Writer(SyntheticFrames);
+		for (int32 i = 0; i < FrameCount; ++i)
+		{
+			WriteCameraFrame(Writer, i, Random);
+		}
+	}
+	else
+	{
+		USCTSpatialCameraAsset* Asset = LoadObject<USCTSpatialCameraAsset>(nullptr, *CapturePath);
+		if (Asset == nullptr)
+		{
+			UE_LOG(LogSCTBenchmark, Error, TEXT("Could not load capture %s"), *CapturePath);
+			return false;
+		}
+
+		// Assets built in code leave the version unset, those are in the current layout
+		Decoder = Asset->Version == 0 ? &kh::GetCurrentProtocolDecoder() : kh::FindProtocolDecoder(Asset->Version);
+		if (Decoder == nullptr)
+		{
+			UE_LOG(LogSCTBenchmark, Error, TEXT("Capture %s has unsupported version %d"), *CapturePath, Asset->Version);
+			return false;
+		}
+
+		if (USCTSpatialSkeletonAsset* SkeletonAsset = Cast<USCTSpatialSkeletonAsset>(Asset))
+		{
+			JointCount = SkeletonAsset->SkeletonDefinition.JointNames.Num();
+		}
+
+		const int32 FrameSize = Decoder->GetFrameSize(JointCount > 0, JointCount);
+		FrameCount = FMath::Min(Asset->FrameCount, Asset->FrameData.Num() / FrameSize);
+		FrameData = &Asset->FrameData;
+	}
+
+	FMRSerializeFromBuffer FromBuffer(const_cast<uint8*>(FrameData->GetData()), FrameData->Num());
+	TArray<FTransform> Joints;
+	Joints.SetNum(JointCount);
+	FTransform CameraTransform;
+	kh::FCameraFrameMetaData CameraMetaData;
+
+	for (int32 i = 0; i < FrameCount; ++i)
+	{
+		if (JointCount > 0)
+		{
+			Decoder->ReadSkeletonFrame(FromBuffer, Joints);
+		}
+		Decoder->ReadCameraFrame(FromBuffer, CameraTransform, CameraMetaData);
+
+		// Duplicated timestamps would make the ground truth ambiguous
+		if (OutTimes.Num() > 0 && CameraMetaData.Timestamp <= OutTimes.Last())
+			continue;
+
+		OutTimes.Add(CameraMetaData.Timestamp);
+		OutPoses.Add(CameraTransform);
+	}
+
+	return OutTimes.Num() > 1;
+}
+
+static double GetPercentile(TArray<double>& Values, double Percentile)
+{
+	if (Values.Num() == 0)
+		return 0.0;
+
+	Values.Sort();
+	return Values[FMath::Min(FMath::FloorToInt(Values.Num() * Percentile), Values.Num() - 1)];
+}
+
+/**
+ * Replays the camera as if every frame arrived Delay seconds late, and compares what each model would show with
+ * the recorded pose at that time. "Hold" is no prediction, the latency the models are hiding
+ */
+static void RunPredictionEvaluation(const TArray<double>& Times, const TArray<FTransform>& Poses, const TArray<double>& Delays, TArray<FPredictionResult>& OutResults)
+{
+	struct FModel
+	{
+		const TCHAR* Name;
+		bool bPredict;
+		kh::EPosePredictionModel Model;
+	};
+	const FModel Models[] =
+	{
+		{ TEXT("Hold"), false, kh::EPosePredictionModel::ConstantVelocity },
+		{ TEXT("ConstantVelocity"), true, kh::EPosePredictionModel::ConstantVelocity },
+		{ TEXT("AlphaBeta"), true, kh::EPosePredictionModel::AlphaBeta },
+	};
+
+	for (const double Delay : Delays)
+	{
+		for (const FModel& Model : Models)
+		{
+			kh::FPosePredictionSettings Settings;
+			Settings.bEnabled = true;
+			Settings.Model = Model.Model;
+
+			kh::FPosePredictor Predictor;
+			TArray<double> PositionErrors;
+			TArray<double> RotationErrors;
+			int32 Target = 0;
+
+			for (int32 i = 0; i < Times.Num(); ++i)
+			{
+				Predictor.AddSample(Times[i], Poses[i], Settings);
+
+				const double TargetTime = Times[i] + Delay;
+				if (TargetTime > Times.Last())
+					break;
+
+				while (Target + 1 < Times.Num() - 1 && Times[Target + 1] <= TargetTime)
+				{
+					++Target;
+				}
+
+				const double Alpha = FMath::Clamp((TargetTime - Times[Target]) / (Times[Target + 1] - Times[Target]), 0.0, 1.0);
+				FTransform Truth;
+				Truth.Blend(Poses[Target], Poses[Target + 1], (float)Alpha);
+
+				const FTransform Shown = Model.bPredict ? Predictor.Predict(Delay, Settings) : Poses[i];
+				PositionErrors.Add(FVector::Dist(Shown.GetLocation(), Truth.GetLocation()));
+				RotationErrors.Add(FMath::RadiansToDegrees(Shown.GetRotation().AngularDistance(Truth.GetRotation())));
+			}
+
+			FPredictionResult Result;
+			Result.Name = FString::Printf(TEXT("%s/%.3f"), Model.Name, Delay);
+			Result.Model = Model.Name;
+			Result.Delay = Delay;
+			Result.Samples = PositionErrors.Num();
+			for (int32 i = 0; i < Result.Samples; ++i)
+			{
+				Result.MeanPositionError += PositionErrors[i] / Result.Samples;
+				Result.MeanRotationError += RotationErrors[i] / Result.Samples;
+			}
+			Result.P95PositionError = GetPercentile(PositionErrors, 0.95);
+			Result.P95RotationError = GetPercentile(RotationErrors, 0.95);
+
+			UE_LOG(LogSCTBenchmark, Display, TEXT("%-32s %8.3f cm mean %8.3f cm p95 %8.3f deg mean %8.3f deg p95"), *Result.Name, Result.MeanPositionError, Result.P95PositionError, Result.MeanRotationError, Result.P95RotationError);
+			OutResults.Add(Result);
+		}
+	}
+}
+
+static TSharedRef<FJsonObject> ToJson(const FString& Input, const TArray<FBenchmarkResult>& Benchmarks, const TArray<FPredictionResult>& Predictions)
+{
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetNumberField(TEXT("Version"), BenchmarkFileVersion);
+	Root->SetStringField(TEXT("Platform"), FString(FPlatformProperties::IniPlatformName()));
+	Root->SetStringField(TEXT("CPU"), FPlatformMisc::GetCPUBrand().TrimStartAndEnd());
+	Root->SetStringField(TEXT("Date"), FDateTime::UtcNow().ToIso8601());
+	Root->SetStringField(TEXT("PredictionInput"), Input);
+
+	TArray<TSharedPtr<FJsonValue>> BenchmarkValues;
+	for (const FBenchmarkResult& Result : Benchmarks)
+	{
+		TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+		Object->SetStringField(TEXT("Name"), Result.Name);
+		Object->SetStringField(TEXT("Unit"), Result.Unit);
+		Object->SetNumberField(TEXT("Items"), Result.Items);
+		Object->SetNumberField(TEXT("Bytes"), Result.Bytes);
+		Object->SetNumberField(TEXT("Iterations"), Result.Iterations);
+		Object->SetNumberField(TEXT("BestSeconds"), Result.BestSeconds);
+		Object->SetNumberField(TEXT("ItemsPerSecond"), Result.GetItemsPerSecond());
+		Object->SetNumberField(TEXT("MBPerSecond"), Result.GetMBPerSecond());
+		BenchmarkValues.Add(MakeShared<FJsonValueObject>(Object));
+	}
+	Root->SetArrayField(TEXT("Benchmarks"), BenchmarkValues);
+
+	TArray<TSharedPtr<FJsonValue>> PredictionValues;
+	for (const FPredictionResult& Result : Predictions)
+	{
+		TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+		Object->SetStringField(TEXT("Name"), Result.Name);
+		Object->SetStringField(TEXT("Model"), Result.Model);
+		Object->SetNumberField(TEXT("Delay"), Result.Delay);
+		Object->SetNumberField(TEXT("Samples"), Result.Samples);
+		Object->SetNumberField(TEXT("MeanPositionErrorCm"), Result.MeanPositionError);
+		Object->SetNumberField(TEXT("P95PositionErrorCm"), Result.P95PositionError);
+		Object->SetNumberField(TEXT("MeanRotationErrorDeg"), Result.MeanRotationError);
+		Object->SetNumberField(TEXT("P95RotationErrorDeg"), Result.P95RotationError);
+		PredictionValues.Add(MakeShared<FJsonValueObject>(Object));
+	}
+	Root->SetArrayField(TEXT("Prediction"), PredictionValues);
+
+	return Root;
+}
+
+static bool SaveJson(const TSharedRef<FJsonObject>& Root, const FString& Path)
+{
+	FString Text;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Text);
+	if (FJsonSerializer::Serialize(Root, Writer) == false || FFileHelper::SaveStringToFile(Text, *Path) == false)
+	{
+		UE_LOG(LogSCTBenchmark, Error, TEXT("Could not write %s"), *Path);
+		return false;
+	}
+
+	UE_LOG(LogSCTBenchmark, Display, TEXT("Wrote %s"), *Path);
+	return true;
+}
+
+static TMap<FString, TSharedPtr<FJsonObject>> GetEntriesByName(const TSharedPtr<FJsonObject>& Root, const TCHAR* ArrayName)
+{
+	TMap<FString, TSharedPtr<FJsonObject>> Entries;
+	const TArray<TSharedPtr<FJsonValue>>* Values = nullptr;
+	if (Root->TryGetArrayField(ArrayName, Values))
+	{
+		for (const TSharedPtr<FJsonValue>& Value : *Values)
+		{
+			const TSharedPtr<FJsonObject>* Object = nullptr;
+			FString Name;
+			if (Value->TryGetObject(Object) && (*Object)->TryGetStringField(TEXT("Name"), Name))
+			{
+				Entries.Add(Name, *Object);
+			}
+		}
+	}
+	return Entries;
+}
+
+/** Returns the number of regressions against the baseline */
+static int32 CompareWithBaseline(const FString& BaselinePath, const FString& Input, const TArray<FBenchmarkResult>& Benchmarks, const TArray<FPredictionResult>& Predictions, double Tolerance)
+{
+	FString Text;
+	TSharedPtr<FJsonObject> Baseline;
+	if (FFileHelper::LoadFileToString(Text, *BaselinePath) == false || FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Text), Baseline) == false || Baseline.IsValid() == false)
+	{
+		UE_LOG(LogSCTBenchmark, Error, TEXT("Could not read baseline %s"), *BaselinePath);
+		return 1;
+	}
+
+	UE_LOG(LogSCTBenchmark, Display, TEXT("Comparing with %s, %.0f%% tolerance"), *BaselinePath, Tolerance * 100.0);
+	int32 Regressions = 0;
+
+	const TMap<FString, TSharedPtr<FJsonObject>> BaselineBenchmarks = GetEntriesByName(Baseline, TEXT("Benchmarks"));
+	for (const FBenchmarkResult& Result : Benchmarks)
+	{
+		const TSharedPtr<FJsonObject>* Entry = BaselineBenchmarks.Find(Result.Name);
+		double BaselineRate = 0.0;
+		if (Entry == nullptr || (*Entry)->TryGetNumberField(TEXT("ItemsPerSecond"), BaselineRate) == false || BaselineRate <= 0.0)
+			continue;
+
+		const double Ratio = Result.GetItemsPerSecond() / BaselineRate;
+		const bool bRegressed = Ratio < 1.0 - Tolerance;
+		Regressions += bRegressed ? 1 : 0;
+		UE_LOG(LogSCTBenchmark, Display, TEXT("%-32s %+7.1f%% %s"), *Result.Name, (Ratio - 1.0) * 100.0, bRegressed ? TEXT("REGRESSION") : TEXT(""));
+	}
+
+	// Prediction error only depends on the input, so it is only compared when the input is the same
+	FString BaselineInput;
+	if (Baseline->TryGetStringField(TEXT("PredictionInput"), BaselineInput) && BaselineInput == Input)
+	{
+		// Below these the difference is noise
+		const double MinPositionError = 0.01;
+		const double MinRotationError = 0.01;
+
+		const TMap<FString, TSharedPtr<FJsonObject>> BaselinePredictions = GetEntriesByName(Baseline, TEXT("Prediction"));
+		for (const FPredictionResult& Result : Predictions)
+		{
+			const TSharedPtr<FJsonObject>* Entry = BaselinePredictions.Find(Result.Name);
+			double BaselinePosition = 0.0;
+			double BaselineRotation = 0.0;
+			if (Entry == nullptr || (*Entry)->TryGetNumberField(TEXT("MeanPositionErrorCm"), BaselinePosition) == false || (*Entry)->TryGetNumberField(TEXT("MeanRotationErrorDeg"), BaselineRotation) == false)
+				continue;
+
+			const bool bRegressed = Result.MeanPositionError > BaselinePosition * (1.0 + Tolerance) + MinPositionError
+				|| Result.MeanRotationError > BaselineRotation * (1.0 + Tolerance) + MinRotationError;
+			Regressions += bRegressed ? 1 : 0;
+			UE_LOG(LogSCTBenchmark, Display, TEXT("%-32s %8.3f cm (was %.3f) %8.3f deg (was %.3f) %s"), *Result.Name, Result.MeanPositionError, BaselinePosition, Result.MeanRotationError, BaselineRotation, bRegressed ? TEXT("REGRESSION") : TEXT(""));
+		}
+	}
+
+	if (Regressions > 0)
+	{
+		UE_LOG(LogSCTBenchmark, Error, TEXT("%d regressions against %s"), Regressions, *BaselinePath);
+	}
+	return Regressions;
+}
+
+USCTBenchmarkCommandlet::USCTBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 USCTBenchmarkCommandlet::Main(const FString& Params)
+{
+	const TCHAR* Stream = *Params;
+
+	FString Filter;
+	FString CapturePath;
+	FString DelayList = TEXT("0.033,0.066,0.1");
+	FString OutputPath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("SCT"), FString::Printf(TEXT("Benchmark-%s.json"), *FDateTime::Now().ToString()));
+	FString BaselinePath;
+	float MinTime = 1.0f;
+	float Tolerance = 0.1f;
+
+	FParse::Value(Stream, TEXT("Filter="), Filter);
+	FParse::Value(Stream, TEXT("Capture="), CapturePath);
+	FParse::Value(Stream, TEXT("Delays="), DelayList, false);
+	FParse::Value(Stream, TEXT("Output="), OutputPath);
+	FParse::Value(Stream, TEXT("Baseline="), BaselinePath);
+	FParse::Value(Stream, TEXT("MinTime="), MinTime);
+	FParse::Value(Stream, TEXT("Tolerance="), Tolerance);
+	const bool bUpdateBaseline = FParse::Param(Stream, TEXT("UpdateBaseline"));
+
+	// Baselines are per platform, checked in next to the plugin
+	const FString DefaultBaselinePath = FPaths::Combine(FPaths::ProjectPluginsDir(), TEXT("SCT"), TEXT("Benchmarks"), FString(FPlatformProperties::IniPlatformName()) + TEXT(".json"));
+	if (BaselinePath.IsEmpty())
+	{
+		BaselinePath = DefaultBaselinePath;
+	}
+
+	TArray<FBenchmarkSize> Sizes;
+	if (FParse::Param(Stream, TEXT("Small")) || FParse::Param(Stream, TEXT("Large")) == false)
+	{
+		Sizes.Add({ TEXT("Small"), false });
+	}
+	if (FParse::Param(Stream, TEXT("Large")) || FParse::Param(Stream, TEXT("Small")) == false)
+	{
+		Sizes.Add({ TEXT("Large"), true });
+	}
+
+	TArray<FBenchmarkResult> Benchmarks;
+	RunThroughputBenchmarks(Filter, Sizes, FMath::Max(MinTime, 0.0f), Benchmarks);
+
+	TArray<FPredictionResult> Predictions;
+	const FString Input = CapturePath.IsEmpty() ? TEXT("Synthetic") : CapturePath;
+	if (Filter.IsEmpty() || FString(TEXT("Prediction")).Contains(Filter))
+	{
+		TArray<FString> DelayStrings;
+		DelayList.ParseIntoArray(DelayStrings, TEXT(","));
+		TArray<double> Delays;
+		for (const FString& Delay : DelayStrings)
+		{
+			Delays.Add(FCString::Atod(*Delay));
+		}
+
+		TArray<double> Times;
+		TArray<FTransform> Poses;
+		if (LoadCameraTrack(CapturePath, Times, Poses) == false)
+			return 1;
+
+		RunPredictionEvaluation(Times, Poses, Delays, Predictions);
+	}
+
+	UE_LOG(LogSCTBenchmark, Verbose, TEXT("Sink %f"), BenchmarkSink);
+
+	const TSharedRef<FJsonObject> Results = ToJson(Input, Benchmarks, Predictions);
+	if (SaveJson(Results, OutputPath) == false)
+		return 1;
+
+	if (bUpdateBaseline)
+		return SaveJson(Results, BaselinePath) ? 0 : 1;
+
+	if (FPaths::FileExists(BaselinePath))
+		return CompareWithBaseline(BaselinePath, Input, Benchmarks, Predictions, Tolerance) > 0 ? 1 : 0;
+
+	UE_LOG(LogSCTBenchmark, Display, TEXT("No baseline at %s, run with -UpdateBaseline to record one"), *BaselinePath);
+	return 0;
+}
@@ -22,6 +22,12 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #include "SCTBlueprintFunctionLibrary.h"
+#include "SCTSkeletonLayout.h"
+#include "SCTLiveLinkPlaybackSource.h"
+#include "ILiveLinkClient.h"
+#include "Features/IModularFeatures.h"
+
+static_assert((int32)EJointIndex::Foot_r + 1 == kh::FSCTBodySkeletonLayout::JointCount, "EJointIndex must match the body skeleton layout");
 
 FVector USCTBlueprintFunctionLibrary::GetJointLocationFromPawnByEnum(ASCTReplaySkeletonPawn* pawn, EJointIndex Joint)
 {
@@ -34,4 +40,18 @@ FVector USCTBlueprintFunctionLibrary::GetJointLocationFromPawnByEnum(ASCTReplayS
 FTransform USCTBlueprintFunctionLibrary::GetCameraTransformFromPawn(ASCTReplaySkeletonPawn* pawn)
 {
 	return pawn->GetCameraTransform();
+}
+
+bool USCTBlueprintFunctionLibrary::AddLiveLinkPlaybackSource(const TArray<USCTSpatialCameraAsset*>& Captures, bool bLoop, float PlaybackRate)
+{
+	IModularFeatures& ModularFeatures = IModularFeatures::Get();
+	if (ModularFeatures.IsModularFeatureAvailable(ILiveLinkClient::ModularFeatureName) == false)
+		return false;
+
+	FSCTLiveLinkPlaybackSettings Settings;
+	Settings.bLoop = bLoop;
+	Settings.PlaybackRate = PlaybackRate;
+
+	ILiveLinkClient& LiveLinkClient = ModularFeatures.GetModularFeature<ILiveLinkClient>(ILiveLinkClient::ModularFeatureName);
+	return LiveLinkClient.AddSource(MakeShared<FSCTLiveLinkPlaybackSource>(Captures, Settings)).IsValid();
 }
\ No newline at end of file
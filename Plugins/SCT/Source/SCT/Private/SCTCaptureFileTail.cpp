@@ -0,0 +1,180 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTCaptureFileTail.h"
+#include "SCTMemory.h"
+#include "SCTStats.h"
+
+#include "HAL/PlatformFilemanager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSCTCaptureFileTail, Log, All);
+
+namespace kh
+{
+	// Bounds how long a single Poll can take when it finds a file that is already large
+	static constexpr int64 MaxReadPerPoll = 64 * 1024 * 1024;
+
+	FCaptureFileTail::FCaptureFileTail(const FString& InPath)
+		: Path(InPath)
+		, File(nullptr)
+		, Generation(0)
+	{
+		Reset();
+	}
+
+	FCaptureFileTail::~FCaptureFileTail()
+	{
+		delete File;
+	}
+
+	void FCaptureFileTail::Reset()
+	{
+		delete File;
+		File = nullptr;
+		ReadOffset = 0;
+		bIsValid = true;
+		bHasHeader = false;
+		Decoder = nullptr;
+		FrameSize = 0;
+		Header = FSpatialHeader();
+		UserAnchors.Reset();
+		SkeletonDefinition = FSCTSkeletonDefinition();
+		Pending.Reset();
+		FrameData.Reset();
+	}
+
+	int32 FCaptureFileTail::Poll()
+	{
+		if (bIsValid == false)
+			return 0;
+
+		SCT_SCOPE_CYCLE_COUNTER(STAT_SCT_PollTail);
+		SCT_LLM_SCOPE(Captures);
+
+		// The writer keeps the file open, so it must be opened for shared access
+		if (File == nullptr)
+		{
+			File = FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Path, true);
+			if (File == nullptr)
+				return 0;
+		}
+
+		const int64 Size = File->Size();
+		if (Size < ReadOffset)
+		{
+			UE_LOG(LogSCTCaptureFileTail, Display, TEXT("[SCT Tail] %s was replaced, reading it again"), *Path);
+			Reset();
+			++Generation;
+			return 0;
+		}
+
+		const int32 NewBytes = (int32)FMath::Min(Size - ReadOffset, MaxReadPerPoll);
+		if (NewBytes == 0)
+			return 0;
+
+		const int32 FramesBefore = GetFrameCount();
+
+		if (bHasHeader == false)
+		{
+			const int32 PendingSize = Pending.Num();
+			Pending.AddUninitialized(NewBytes);
+			if (File->Seek(ReadOffset) == false || File->Read(Pending.GetData() + PendingSize, NewBytes) == false)
+			{
+				Pending.SetNum(PendingSize, false);
+				return 0;
+			}
+			ReadOffset += NewBytes;
+			INC_DWORD_STAT_BY(STAT_SCT_BytesRead, NewBytes);
+
+			if (ParseHeader() == false)
+				return 0;
+
+			FrameData = MoveTemp(Pending);
+			Pending.Reset();
+		}
+		else
+		{
+			// Read straight behind the partial frame, so the bulk of the data is only copied once
+			const int32 FrameDataSize = FrameData.Num();
+			FrameData.Append(Pending);
+			Pending.Reset();
+
+			const int32 ReadStart = FrameData.Num();
+			FrameData.AddUninitialized(NewBytes);
+			if (File->Seek(ReadOffset) == false || File->Read(FrameData.GetData() + ReadStart, NewBytes) == false)
+			{
+				Pending.Append(FrameData.GetData() + FrameDataSize, ReadStart - FrameDataSize);
+				FrameData.SetNum(FrameDataSize, false);
+				return 0;
+			}
+			ReadOffset += NewBytes;
+			INC_DWORD_STAT_BY(STAT_SCT_BytesRead, NewBytes);
+		}
+
+		const int32 CompleteSize = FrameData.Num() / FrameSize * FrameSize;
+		Pending.Append(FrameData.GetData() + CompleteSize, FrameData.Num() - CompleteSize);
+		FrameData.SetNum(CompleteSize, false);
+
+		return GetFrameCount() - FramesBefore;
+	}
+
+	bool FCaptureFileTail::ParseHeader()
+	{
+		FMRSerializeFromBuffer FromBuffer(Pending.GetData(), Pending.Num());
+
+		FSpatialHeader NewHeader;
+		ReadHeaderFromBuffer(FromBuffer, NewHeader);
+		if (FromBuffer.HasOverflow())
+			return false;
+
+		const FProtocolDecoder* NewDecoder = FindProtocolDecoder(NewHeader.Version);
+		if (NewDecoder == nullptr)
+		{
+			UE_LOG(LogSCTCaptureFileTail, Error, TEXT("[SCT Tail] Unsupported version (%d) in %s. Make sure your plugin and App versions match"), NewHeader.Version, *Path);
+			bIsValid = false;
+			return false;
+		}
+
+		NewDecoder->ReadUserAnchors(FromBuffer, UserAnchors);
+		if (FromBuffer.HasOverflow() == false && NewHeader.CaptureType == (int32)ECaptureType::Skeleton)
+		{
+			NewDecoder->ReadSkeletonDefinition(FromBuffer, SkeletonDefinition);
+		}
+
+		// Not all of it is on disk yet
+		if (FromBuffer.HasOverflow())
+		{
+			UserAnchors.Reset();
+			return false;
+		}
+
+		Header = NewHeader;
+		Decoder = NewDecoder;
+		FrameSize = Decoder->GetFrameSize(IsSkeletonCapture(), SkeletonDefinition.JointNames.Num());
+		Pending.RemoveAt(0, FromBuffer.Tell(), false);
+		bHasHeader = true;
+
+		UE_LOG(LogSCTCaptureFileTail, Display, TEXT("[SCT Tail] Following %s"), *Path);
+		return true;
+	}
+}
@@ -0,0 +1,90 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SCTProtocol.h"
+#include "SCTSpatialSkeletonAsset.h"
+
+class IFileHandle;
+
+namespace kh
+{
+	/**
+	 * Follows a capture file that is still being written, for example while it syncs from the device.
+	 * Every Poll reads only the bytes appended since the last one, parses the header once it is complete and
+	 * moves whole frames into the frame data. A trailing partial frame is held back until the rest of it arrives.
+	 * If the file shrinks it was replaced, and is read again from the start
+	 */
+	class FCaptureFileTail
+	{
+	public:
+		FCaptureFileTail(const FString& InPath);
+		~FCaptureFileTail();
+
+		/** Reads what was appended since the last call, returns the number of new complete frames */
+		int32 Poll();
+
+		bool HasHeader() const { return bHasHeader; }
+		/** False once the file turned out not to be a capture this plugin can read */
+		bool IsValid() const { return bIsValid; }
+		/** Counts up every time the file was replaced and read again from the start */
+		int32 GetGeneration() const { return Generation; }
+
+		const FSpatialHeader& GetHeader() const { return Header; }
+		const TArray<FVector>& GetUserAnchors() const { return UserAnchors; }
+		const FSCTSkeletonDefinition& GetSkeletonDefinition() const { return SkeletonDefinition; }
+		bool IsSkeletonCapture() const { return Header.CaptureType == (int32)ECaptureType::Skeleton; }
+
+		/** Readers for the frames, nullptr until the header was read */
+		const FProtocolDecoder* GetDecoder() const { return Decoder; }
+		int32 GetFrameSize() const { return FrameSize; }
+		int32 GetFrameCount() const { return FrameSize > 0 ? FrameData.Num() / FrameSize : 0; }
+		/** The complete frames read so far. The array grows on Poll, so don't keep pointers into it across calls */
+		const TArray<uint8>& GetFrameData() const { return FrameData; }
+
+		SIZE_T GetAllocatedSize() const { return UserAnchors.GetAllocatedSize() + SkeletonDefinition.GetAllocatedSize() + Pending.GetAllocatedSize() + FrameData.GetAllocatedSize(); }
+
+	private:
+		void Reset();
+		bool ParseHeader();
+
+		FString Path;
+		IFileHandle* File;
+		int64 ReadOffset;
+		int32 Generation;
+		bool bIsValid;
+
+		bool bHasHeader;
+		FSpatialHeader Header;
+		TArray<FVector> UserAnchors;
+		FSCTSkeletonDefinition SkeletonDefinition;
+		const FProtocolDecoder* Decoder;
+		int32 FrameSize;
+
+		// Bytes of an incomplete header or frame
+		TArray<uint8> Pending;
+		TArray<uint8> FrameData;
+	};
+}
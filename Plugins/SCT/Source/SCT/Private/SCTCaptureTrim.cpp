@@ -0,0 +1,198 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTCaptureTrim.h"
+#include "SCTCaptureWriter.h"
+#include "SCTProtocol.h"
+
+#include "Algo/BinarySearch.h"
+
+namespace kh
+{
+	/** One frame read in device space, as it is written */
+	struct FTrimFrame
+	{
+		int32 Index = INDEX_NONE;
+		uint32 SkeletonCount = 0;
+		sct::CameraFrame Camera;
+		TArray<sct::Matrix4> Joints;
+	};
+
+	static void ReadTrimFrame(const sct::FrameLayout& Layout, const uint8* Data, int32 FrameSize, bool bSkeleton, int32 JointCount, int32 Index, FTrimFrame& OutFrame)
+	{
+		if (OutFrame.Index == Index)
+			return;
+
+		sct::ByteReader Reader(Data + (SIZE_T)Index * FrameSize, FrameSize);
+		if (bSkeleton)
+		{
+			OutFrame.Joints.SetNumUninitialized(JointCount);
+			OutFrame.SkeletonCount = Layout.ReadSkeletonFrame(Reader, OutFrame.Joints.GetData(), OutFrame.Joints.Num());
+		}
+		Layout.ReadCameraFrame(Reader, OutFrame.Camera);
+		OutFrame.Index = Index;
+	}
+
+	// The rotation playback builds from a camera frame, see FSpatialDataDeserializer::ConvertCameraFrame
+	static FQuat CameraRotationToQuat(const sct::Vec3& Rotation)
+	{
+		return FRotator(FMath::RadiansToDegrees(Rotation.X), FMath::RadiansToDegrees(-Rotation.Y), FMath::RadiansToDegrees(-Rotation.Z)).Quaternion();
+	}
+
+	static FVector QuatToCameraRotation(const FQuat& Quat)
+	{
+		const FRotator Rotator = Quat.Rotator();
+		return FVector(FMath::DegreesToRadians(Rotator.Pitch), -FMath::DegreesToRadians(Rotator.Yaw), -FMath::DegreesToRadians(Rotator.Roll));
+	}
+
+	static FMatrix BlendJoint(const sct::Matrix4& A, const sct::Matrix4& B, float Alpha)
+	{
+		FMatrix MatrixA;
+		FMatrix MatrixB;
+		FMemory::Memcpy(MatrixA.M, A.M, sizeof(MatrixA.M));
+		FMemory::Memcpy(MatrixB.M, B.M, sizeof(MatrixB.M));
+
+		const FTransform TransformA(MatrixA);
+		const FTransform TransformB(MatrixB);
+		const FTransform Blended(
+			FQuat::Slerp(TransformA.GetRotation(), TransformB.GetRotation(), Alpha),
+			FMath::Lerp(TransformA.GetTranslation(), TransformB.GetTranslation(), Alpha),
+			FMath::Lerp(TransformA.GetScale3D(), TransformB.GetScale3D(), Alpha));
+		return Blended.ToMatrixWithScale();
+	}
+
+	bool TrimCaptureFrames(const FSCTCaptureTrimSettings& Settings, int32& InOutVersion, bool bSkeleton, int32 JointCount, TArray<uint8>& InOutFrameData, int32& InOutFrameCount, FString& OutError)
+	{
+		if (Settings.IsSet() == false)
+			return true;
+
+		const sct::FrameLayout* Layout = sct::FindLayout(InOutVersion);
+		if (Layout == nullptr)
+		{
+			OutError = FString::Printf(TEXT("Unsupported version %d"), InOutVersion);
+			return false;
+		}
+
+		const int32 FrameSize = Layout->GetFrameSize(bSkeleton, JointCount);
+		const int32 FrameCount = FMath::Min(InOutFrameCount, InOutFrameData.Num() / FrameSize);
+		if (FrameCount == 0)
+		{
+			OutError = TEXT("The capture has no frames to trim");
+			return false;
+		}
+
+		TArray<double> Timestamps;
+		Timestamps.SetNumUninitialized(FrameCount);
+		for (int32 i = 0; i < FrameCount; ++i)
+		{
+			sct::ByteReader Reader(InOutFrameData.GetData() + (SIZE_T)(i + 1) * FrameSize - Layout->CameraFrameSize, Layout->CameraFrameSize);
+			sct::CameraFrame Camera;
+			Layout->ReadCameraFrame(Reader, Camera);
+			Timestamps[i] = Camera.Timestamp;
+		}
+
+		const double Start = Timestamps[0] + Settings.StartTime;
+		const double End = Settings.EndTime > 0.0f ? FMath::Min(Timestamps.Last(), Timestamps[0] + Settings.EndTime) : Timestamps.Last();
+		if (End < Start)
+		{
+			OutError = FString::Printf(TEXT("No frames between %.3f and %.3f s, the capture is %.3f s long"), Settings.StartTime, Settings.EndTime, Timestamps.Last() - Timestamps[0]);
+			return false;
+		}
+
+		if (Settings.bResample == false)
+		{
+			// The frames themselves are kept, only the ones outside the window are dropped
+			const int32 First = Algo::LowerBound(Timestamps, Start);
+			const int32 Last = Algo::UpperBound(Timestamps, End) - 1;
+			if (First > Last)
+			{
+				OutError = FString::Printf(TEXT("No frames between %.3f and %.3f s"), Settings.StartTime, Settings.EndTime);
+				return false;
+			}
+
+			InOutFrameData.RemoveAt(0, First * FrameSize, false);
+			InOutFrameData.SetNum((Last - First + 1) * FrameSize, false);
+			InOutFrameCount = Last - First + 1;
+			return true;
+		}
+
+		const double Interval = Settings.FrameRate.AsInterval();
+		if (Interval <= 0.0 || FMath::IsFinite(Interval) == false)
+		{
+			OutError = FString::Printf(TEXT("Can't resample to %s"), *Settings.FrameRate.ToPrettyText().ToString());
+			return false;
+		}
+
+		// Frames sit exactly on the target rate from Start, the tolerance keeps a last frame that lands on End
+		const int32 ResampledCount = FMath::FloorToInt((End - Start) / Interval + 1e-6) + 1;
+		const sct::FrameLayout& OutLayout = *sct::FindLayout(SpatialProtocolVersion);
+
+		TArray<uint8> Resampled;
+		Resampled.Reserve(ResampledCount * OutLayout.GetFrameSize(bSkeleton, JointCount));
+		FCaptureWriter Writer(Resampled);
+
+		FTrimFrame FrameA;
+		FTrimFrame FrameB;
+		int32 Segment = 0;
+		for (int32 i = 0; i < ResampledCount; ++i)
+		{
+			const double Time = Start + i * Interval;
+			while (Segment + 2 < FrameCount && Timestamps[Segment + 1] <= Time)
+			{
+				++Segment;
+			}
+
+			const int32 Next = FMath::Min(Segment + 1, FrameCount - 1);
+			const double Span = Timestamps[Next] - Timestamps[Segment];
+			const float Alpha = Span > 0.0 ? (float)FMath::Clamp((Time - Timestamps[Segment]) / Span, 0.0, 1.0) : 0.0f;
+
+			// Moving on to the next segment, the frame read last time starts it
+			if (FrameB.Index == Segment)
+			{
+				Swap(FrameA, FrameB);
+			}
+			ReadTrimFrame(*Layout, InOutFrameData.GetData(), FrameSize, bSkeleton, JointCount, Segment, FrameA);
+			ReadTrimFrame(*Layout, InOutFrameData.GetData(), FrameSize, bSkeleton, JointCount, Next, FrameB);
+
+			if (bSkeleton)
+			{
+				Writer.UInt32(FrameA.SkeletonCount);
+				for (int32 Joint = 0; Joint < JointCount; ++Joint)
+				{
+					Writer.Matrix(BlendJoint(FrameA.Joints[Joint], FrameB.Joints[Joint], Alpha));
+				}
+			}
+
+			const sct::CameraFrame& A = FrameA.Camera;
+			const sct::CameraFrame& B = FrameB.Camera;
+			const FVector Position = FMath::Lerp(FVector(A.Position.X, A.Position.Y, A.Position.Z), FVector(B.Position.X, B.Position.Y, B.Position.Z), Alpha);
+			const FQuat Rotation = FQuat::Slerp(CameraRotationToQuat(A.Rotation), CameraRotationToQuat(B.Rotation), Alpha);
+			Writer.CameraFrame(Time, Position, QuatToCameraRotation(Rotation), FMath::Lerp(A.ExposureOffset, B.ExposureOffset, Alpha), FMath::Lerp(A.ExposureDuration, B.ExposureDuration, (double)Alpha));
+		}
+
+		InOutFrameData = MoveTemp(Resampled);
+		InOutFrameCount = ResampledCount;
+		InOutVersion = SpatialProtocolVersion;
+		return true;
+	}
+}
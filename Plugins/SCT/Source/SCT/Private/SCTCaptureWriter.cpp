@@ -0,0 +1,123 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTCaptureWriter.h"
+
+namespace kh
+{
+	void FCaptureWriter::Double(double Value)
+	{
+		uint64 Bits;
+		FMemory::Memcpy(&Bits, &Value, sizeof(Bits));
+		for (int32 i = 0; i < 8; ++i)
+		{
+			Bytes.Add((uint8)(Bits >> (56 - i * 8)));
+		}
+	}
+
+	void FCaptureWriter::Vector(const FVector& Value)
+	{
+		Float(Value.X);
+		Float(Value.Y);
+		Float(Value.Z);
+	}
+
+	void FCaptureWriter::Matrix(const FMatrix& Value)
+	{
+		for (int32 Row = 0; Row < 4; ++Row)
+		{
+			for (int32 Column = 0; Column < 4; ++Column)
+			{
+				Float(Value.M[Row][Column]);
+			}
+		}
+	}
+
+	void FCaptureWriter::String(const FString& Value)
+	{
+		FTCHARToUTF8 Converted(*Value);
+		Int32(Converted.Length());
+		Bytes.Append((const uint8*)Converted.Get(), Converted.Length());
+	}
+
+	void FCaptureWriter::Header(const FSpatialHeader& Header)
+	{
+		Int32(Header.Version);
+		Int32(Header.FrameCount);
+		Int32(Header.DeviceOrientation);
+		Float(Header.HorizontalFOV);
+		Float(Header.VerticalFOV);
+		Float(Header.FocalLengthX);
+		Float(Header.FocalLengthY);
+		Int32(Header.CaptureType);
+	}
+
+	void FCaptureWriter::UserAnchors(const TArray<FVector>& Anchors)
+	{
+		Int32(Anchors.Num());
+		for (const FVector& Anchor : Anchors)
+		{
+			Vector(Anchor);
+		}
+	}
+
+	void FCaptureWriter::SkeletonDefinition(const TArray<FString>& JointNames, const TArray<int32>& ParentIndices, const TArray<FMatrix>& NeutralPose)
+	{
+		check(JointNames.Num() == NeutralPose.Num());
+
+		Int32(JointNames.Num());
+		for (const FString& Name : JointNames)
+		{
+			String(Name);
+		}
+
+		Int32(ParentIndices.Num());
+		for (const int32 Parent : ParentIndices)
+		{
+			Int32(Parent);
+		}
+
+		for (const FMatrix& Joint : NeutralPose)
+		{
+			Matrix(Joint);
+		}
+	}
+
+	void FCaptureWriter::CameraFrame(double Timestamp, const FVector& Position, const FVector& Rotation, float ExposureOffset, double ExposureDuration)
+	{
+		Double(Timestamp);
+		Vector(Position);
+		Vector(Rotation);
+		Float(ExposureOffset);
+		Double(ExposureDuration);
+	}
+
+	void FCaptureWriter::SkeletonFrame(const FMatrix* Joints, int32 JointCount, int32 SkeletonCount)
+	{
+		UInt32(SkeletonCount);
+		for (int32 i = 0, e = JointCount * SkeletonCount; i < e; ++i)
+		{
+			Matrix(Joints[i]);
+		}
+	}
+}
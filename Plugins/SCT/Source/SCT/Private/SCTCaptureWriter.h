@@ -0,0 +1,61 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SCTProtocol.h"
+
+namespace kh
+{
+	/**
+	 * Appends values in the capture format, the counterpart of FMRSerializeFromBuffer: native byte order, except doubles
+	 * which are big endian. Positions and matrices are in device space, Y up and meters, see Protocol.md
+	 */
+	class FCaptureWriter
+	{
+	public:
+		explicit FCaptureWriter(TArray<uint8>& InBytes) : Bytes(InBytes) {}
+
+		void Int32(int32 Value) { Bytes.Append((const uint8*)&Value, sizeof(Value)); }
+		void UInt32(uint32 Value) { Bytes.Append((const uint8*)&Value, sizeof(Value)); }
+		void Int64(int64 Value) { Bytes.Append((const uint8*)&Value, sizeof(Value)); }
+		void Float(float Value) { Bytes.Append((const uint8*)&Value, sizeof(Value)); }
+		void Double(double Value);
+		void Vector(const FVector& Value);
+		/** Row by row, the layout the frame readers expect */
+		void Matrix(const FMatrix& Value);
+		/** Length prefixed UTF-8 */
+		void String(const FString& Value);
+
+		void Header(const FSpatialHeader& Header);
+		void UserAnchors(const TArray<FVector>& Anchors);
+		void SkeletonDefinition(const TArray<FString>& JointNames, const TArray<int32>& ParentIndices, const TArray<FMatrix>& NeutralPose);
+		void CameraFrame(double Timestamp, const FVector& Position, const FVector& Rotation, float ExposureOffset, double ExposureDuration);
+		/** Joints holds JointCount model space matrices for every skeleton in turn */
+		void SkeletonFrame(const FMatrix* Joints, int32 JointCount, int32 SkeletonCount);
+
+	private:
+		TArray<uint8>& Bytes;
+	};
+}
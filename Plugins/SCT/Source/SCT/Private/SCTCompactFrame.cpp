@@ -0,0 +1,475 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTCompactFrame.h"
+
+namespace kh
+{
+	static constexpr uint32 MaxRotationValue = (1u << CompactRotationBits) - 1;
+	static constexpr float RotationRange = 0.70710678f; // Smallest three components are at most 1/sqrt(2)
+	static constexpr int32 WidthBits = 5;
+
+	static FORCEINLINE uint32 ZigZag(int32 Value)
+	{
+		return (uint32)((Value << 1) ^ (Value >> 31));
+	}
+
+	static FORCEINLINE int32 UnZigZag(uint32 Value)
+	{
+		return (int32)(Value >> 1) ^ -(int32)(Value & 1);
+	}
+
+	static FORCEINLINE int32 BitsNeeded(uint32 Value)
+	{
+		return Value == 0 ? 0 : FMath::FloorLog2(Value) + 1;
+	}
+
+	static void QuantizeRotation(const FQuat& Rotation, FCompactJoint& OutJoint)
+	{
+		float Components[4] = { Rotation.X, Rotation.Y, Rotation.Z, Rotation.W };
+
+		int32 Largest = 0;
+		for (int32 i = 1; i < 4; ++i)
+		{
+			if (FMath::Abs(Components[i]) > FMath::Abs(Components[Largest]))
+			{
+				Largest = i;
+			}
+		}
+
+		// q and -q are the same rotation, pick the one where the dropped component is positive
+		const float Sign = Components[Largest] < 0.0f ? -1.0f : 1.0f;
+
+		OutJoint.LargestComponent = (uint8)Largest;
+		for (int32 i = 0, Out = 0; i < 4; ++i)
+		{
+			if (i == Largest)
+				continue;
+
+			const float Normalized = Sign * Components[i] / RotationRange * 0.5f + 0.5f;
+			OutJoint.Components[Out++] = (uint16)FMath::Clamp(FMath::RoundToInt(Normalized * MaxRotationValue), 0, (int32)MaxRotationValue);
+		}
+	}
+
+	static FQuat DequantizeRotation(const FCompactJoint& Joint)
+	{
+		float Components[4];
+		float SumSquared = 0.0f;
+		for (int32 i = 0, In = 0; i < 4; ++i)
+		{
+			if (i == Joint.LargestComponent)
+				continue;
+
+			const float Value = ((float)Joint.Components[In++] / MaxRotationValue * 2.0f - 1.0f) * RotationRange;
+			Components[i] = Value;
+			SumSquared += Value * Value;
+		}
+		Components[Joint.LargestComponent] = FMath::Sqrt(FMath::Max(0.0f, 1.0f - SumSquared));
+
+		FQuat Rotation(Components[0], Components[1], Components[2], Components[3]);
+		Rotation.Normalize();
+		return Rotation;
+	}
+
+	static void WriteFloat(FCompactBitWriter& Writer, float Value)
+	{
+		uint32 Bits = 0;
+		FMemory::Memcpy(&Bits, &Value, sizeof(Bits));
+		Writer.WriteBits(Bits, 32);
+	}
+
+	static float ReadFloat(FCompactBitReader& Reader)
+	{
+		const uint32 Bits = Reader.ReadBits(32);
+		float Value = 0.0f;
+		FMemory::Memcpy(&Value, &Bits, sizeof(Value));
+		return Value;
+	}
+
+	static void WriteFullRotation(FCompactBitWriter& Writer, const FCompactJoint& Joint)
+	{
+		Writer.WriteBits(Joint.LargestComponent, 2);
+		for (int32 c = 0; c < 3; ++c)
+		{
+			Writer.WriteBits(Joint.Components[c], CompactRotationBits);
+		}
+	}
+
+	static void ReadFullRotation(FCompactBitReader& Reader, FCompactJoint& OutJoint)
+	{
+		OutJoint.LargestComponent = (uint8)Reader.ReadBits(2);
+		for (int32 c = 0; c < 3; ++c)
+		{
+			OutJoint.Components[c] = (uint16)Reader.ReadBits(CompactRotationBits);
+		}
+	}
+
+	void FCompactSkeleton::Init(const TArray<int32>& InParentIndices)
+	{
+		ParentIndices = InParentIndices;
+
+		const int32 JointCount = ParentIndices.Num();
+		EvaluationOrder.Reset(JointCount);
+
+		// Joints with a missing, out of range or cyclic parent are treated as roots
+		TBitArray<> Visited(false, JointCount);
+		for (int32 Pass = 0; Pass < JointCount && EvaluationOrder.Num() < JointCount; ++Pass)
+		{
+			for (int32 i = 0; i < JointCount; ++i)
+			{
+				const int32 Parent = ParentIndices[i];
+				if (Visited[i] == false && (Parent < 0 || Parent >= JointCount || Visited[Parent]))
+				{
+					Visited[i] = true;
+					EvaluationOrder.Add(i);
+				}
+			}
+		}
+
+		for (int32 i = 0; i < JointCount; ++i)
+		{
+			if (Visited[i] == false)
+			{
+				ParentIndices[i] = INDEX_NONE;
+				EvaluationOrder.Add(i);
+			}
+			else if (ParentIndices[i] >= JointCount)
+			{
+				ParentIndices[i] = INDEX_NONE;
+			}
+		}
+	}
+
+	bool FCompactFrameEncoder::Init(const TArray<int32>& InParentIndices, const FCompactFrameSettings& InSettings)
+	{
+		// The joint count is sent in 8 bits
+		const bool bIsSupported = InParentIndices.Num() <= CompactMaxJoints;
+		FCompactSkeleton::Init(bIsSupported ? InParentIndices : TArray<int32>());
+
+		Settings = InSettings;
+		Settings.KeyframeInterval = FMath::Max(Settings.KeyframeInterval, 1);
+
+		for (FCompactPose& Pose : History)
+		{
+			Pose.bIsValid = false;
+			Pose.Joints.SetNumUninitialized(GetJointCount());
+		}
+		Current.Joints.SetNumUninitialized(GetJointCount());
+		ModelRotations.SetNumUninitialized(GetJointCount());
+
+		NextKeyframeId = 0;
+		LastAckedKeyframeId = INDEX_NONE;
+		FramesSinceKeyframe = 0;
+		bForceKeyframe = true;
+
+		return bIsSupported;
+	}
+
+	void FCompactFrameEncoder::Quantize(const FTransform* Joints, FCompactPose& OutPose)
+	{
+		const FVector RootLocation = Joints[0].GetLocation();
+
+		for (int32 JointIndex : EvaluationOrder)
+		{
+			const int32 Parent = ParentIndices[JointIndex];
+			FCompactJoint& Joint = OutPose.Joints[JointIndex];
+
+			// Relative to the parent as the receiver will rebuild it, so quantization error doesn't add up along chains
+			const FQuat ModelRotation = Joints[JointIndex].GetRotation();
+			FQuat LocalRotation = Parent != INDEX_NONE ? ModelRotations[Parent].Inverse() * ModelRotation : ModelRotation;
+			LocalRotation.Normalize();
+
+			QuantizeRotation(LocalRotation, Joint);
+			const FQuat Dequantized = DequantizeRotation(Joint);
+			ModelRotations[JointIndex] = Parent != INDEX_NONE ? ModelRotations[Parent] * Dequantized : Dequantized;
+
+			const FVector Offset = (Joints[JointIndex].GetLocation() - RootLocation) * CompactPositionScale;
+			Joint.Position[0] = (int16)FMath::Clamp(FMath::RoundToInt(Offset.X), -MAX_int16, (int32)MAX_int16);
+			Joint.Position[1] = (int16)FMath::Clamp(FMath::RoundToInt(Offset.Y), -MAX_int16, (int32)MAX_int16);
+			Joint.Position[2] = (int16)FMath::Clamp(FMath::RoundToInt(Offset.Z), -MAX_int16, (int32)MAX_int16);
+		}
+	}
+
+	const FCompactPose* FCompactFrameEncoder::FindReference() const
+	{
+		const int32 ReferenceId = Settings.bUseAcks ? LastAckedKeyframeId : (int32)(uint16)(NextKeyframeId - 1);
+		if (ReferenceId == INDEX_NONE)
+			return nullptr;
+
+		const FCompactPose& Reference = History[ReferenceId % CompactKeyframeHistory];
+		return Reference.bIsValid && Reference.KeyframeId == ReferenceId ? &Reference : nullptr;
+	}
+
+	void FCompactFrameEncoder::Acknowledge(uint16 KeyframeId)
+	{
+		const FCompactPose& Pose = History[KeyframeId % CompactKeyframeHistory];
+		if (Pose.bIsValid == false || Pose.KeyframeId != KeyframeId)
+			return;
+
+		// Acks can arrive out of order, only ever move forward
+		if (LastAckedKeyframeId == INDEX_NONE || (int16)(KeyframeId - (uint16)LastAckedKeyframeId) > 0)
+		{
+			LastAckedKeyframeId = KeyframeId;
+		}
+	}
+
+	void FCompactFrameEncoder::Encode(const FTransform* Joints, TArray<uint8>& OutBytes)
+	{
+		FCompactBitWriter Writer(OutBytes);
+
+		const int32 JointCount = GetJointCount();
+		check(JointCount <= CompactMaxJoints);
+		if (Joints == nullptr || JointCount == 0)
+		{
+			Writer.WriteBits(0, 8);
+			Writer.Flush();
+			return;
+		}
+
+		Quantize(Joints, Current);
+
+		++FramesSinceKeyframe;
+		const FCompactPose* Reference = FindReference();
+		const bool bIsKeyframe = bForceKeyframe || Reference == nullptr || FramesSinceKeyframe >= Settings.KeyframeInterval;
+
+		uint16 KeyframeId = 0;
+		if (bIsKeyframe)
+		{
+			KeyframeId = NextKeyframeId++;
+			FramesSinceKeyframe = 0;
+			bForceKeyframe = false;
+
+			FCompactPose& Keyframe = History[KeyframeId % CompactKeyframeHistory];
+			FMemory::Memcpy(Keyframe.Joints.GetData(), Current.Joints.GetData(), JointCount * sizeof(FCompactJoint));
+			Keyframe.KeyframeId = KeyframeId;
+			Keyframe.bIsValid = true;
+
+			// Without acks the receiver is assumed to have every keyframe, an ack would point at an overwritten slot
+			if (Settings.bUseAcks && LastAckedKeyframeId != INDEX_NONE && (uint16)(KeyframeId - (uint16)LastAckedKeyframeId) >= CompactKeyframeHistory)
+			{
+				LastAckedKeyframeId = INDEX_NONE;
+			}
+		}
+		else
+		{
+			KeyframeId = Reference->KeyframeId;
+		}
+
+		Writer.WriteBits(CompactFrame_HasSkeleton | (bIsKeyframe ? CompactFrame_Keyframe : 0), 8);
+		Writer.WriteBits(KeyframeId, 16);
+		Writer.WriteBits(JointCount, 8);
+
+		const FVector RootLocation = Joints[0].GetLocation();
+		WriteFloat(Writer, RootLocation.X);
+		WriteFloat(Writer, RootLocation.Y);
+		WriteFloat(Writer, RootLocation.Z);
+
+		if (bIsKeyframe)
+		{
+			for (const FCompactJoint& Joint : Current.Joints)
+			{
+				WriteFullRotation(Writer, Joint);
+			}
+
+			for (int32 i = 1; i < JointCount; ++i)
+			{
+				for (int32 c = 0; c < 3; ++c)
+				{
+					Writer.WriteBits((uint16)Current.Joints[i].Position[c], 16);
+				}
+			}
+		}
+		else
+		{
+			// One bit width per frame for each kind of delta, small motions cost a few bits per value
+			uint32 MaxRotationDelta = 0;
+			uint32 MaxPositionDelta = 0;
+			for (int32 i = 0; i < JointCount; ++i)
+			{
+				const FCompactJoint& Joint = Current.Joints[i];
+				const FCompactJoint& ReferenceJoint = Reference->Joints[i];
+				for (int32 c = 0; c < 3; ++c)
+				{
+					if (Joint.LargestComponent == ReferenceJoint.LargestComponent)
+					{
+						MaxRotationDelta = FMath::Max(MaxRotationDelta, ZigZag((int32)Joint.Components[c] - ReferenceJoint.Components[c]));
+					}
+					MaxPositionDelta = FMath::Max(MaxPositionDelta, ZigZag((int32)Joint.Position[c] - ReferenceJoint.Position[c]));
+				}
+			}
+
+			const int32 RotationWidth = BitsNeeded(MaxRotationDelta);
+			const int32 PositionWidth = BitsNeeded(MaxPositionDelta);
+			Writer.WriteBits(RotationWidth, WidthBits);
+			Writer.WriteBits(PositionWidth, WidthBits);
+
+			for (int32 i = 0; i < JointCount; ++i)
+			{
+				const FCompactJoint& Joint = Current.Joints[i];
+				const FCompactJoint& ReferenceJoint = Reference->Joints[i];
+				if (Joint.LargestComponent == ReferenceJoint.LargestComponent)
+				{
+					Writer.WriteBits(1, 1);
+					for (int32 c = 0; c < 3; ++c)
+					{
+						Writer.WriteBits(ZigZag((int32)Joint.Components[c] - ReferenceJoint.Components[c]), RotationWidth);
+					}
+				}
+				else
+				{
+					Writer.WriteBits(0, 1);
+					WriteFullRotation(Writer, Joint);
+				}
+			}
+
+			for (int32 i = 1; i < JointCount; ++i)
+			{
+				for (int32 c = 0; c < 3; ++c)
+				{
+					Writer.WriteBits(ZigZag((int32)Current.Joints[i].Position[c] - Reference->Joints[i].Position[c]), PositionWidth);
+				}
+			}
+		}
+
+		Writer.Flush();
+	}
+
+	void FCompactFrameDecoder::Init(const TArray<int32>& InParentIndices)
+	{
+		FCompactSkeleton::Init(InParentIndices);
+
+		for (FCompactPose& Pose : History)
+		{
+			Pose.bIsValid = false;
+			Pose.Joints.SetNumUninitialized(GetJointCount());
+		}
+		Current.Joints.SetNumUninitialized(GetJointCount());
+		ModelRotations.SetNumUninitialized(GetJointCount());
+	}
+
+	ECompactDecodeResult FCompactFrameDecoder::Decode(FMRSerializeFromBuffer& FromBuffer, TArray<FTransform>& InOutJoints, FCompactFrameInfo& OutInfo)
+	{
+		FCompactBitReader Reader(FromBuffer);
+
+		const uint32 Flags = Reader.ReadBits(8);
+		OutInfo.bIsKeyframe = (Flags & CompactFrame_Keyframe) != 0;
+		OutInfo.bHasSkeleton = (Flags & CompactFrame_HasSkeleton) != 0;
+		OutInfo.KeyframeId = 0;
+
+		if (OutInfo.bHasSkeleton == false)
+			return Reader.HasOverflow() ? ECompactDecodeResult::Malformed : ECompactDecodeResult::Decoded;
+
+		OutInfo.KeyframeId = (uint16)Reader.ReadBits(16);
+		const int32 JointCount = (int32)Reader.ReadBits(8);
+
+		FVector RootLocation;
+		RootLocation.X = ReadFloat(Reader);
+		RootLocation.Y = ReadFloat(Reader);
+		RootLocation.Z = ReadFloat(Reader);
+
+		if (Reader.HasOverflow() || JointCount != GetJointCount() || JointCount == 0)
+			return ECompactDecodeResult::Malformed;
+
+		if (OutInfo.bIsKeyframe)
+		{
+			for (FCompactJoint& Joint : Current.Joints)
+			{
+				ReadFullRotation(Reader, Joint);
+			}
+
+			Current.Joints[0].Position[0] = Current.Joints[0].Position[1] = Current.Joints[0].Position[2] = 0;
+			for (int32 i = 1; i < JointCount; ++i)
+			{
+				for (int32 c = 0; c < 3; ++c)
+				{
+					Current.Joints[i].Position[c] = (int16)(uint16)Reader.ReadBits(16);
+				}
+			}
+		}
+		else
+		{
+			const FCompactPose& Reference = History[OutInfo.KeyframeId % CompactKeyframeHistory];
+			if (Reference.bIsValid == false || Reference.KeyframeId != OutInfo.KeyframeId)
+				return ECompactDecodeResult::MissingKeyframe;
+
+			const int32 RotationWidth = (int32)Reader.ReadBits(WidthBits);
+			const int32 PositionWidth = (int32)Reader.ReadBits(WidthBits);
+
+			for (int32 i = 0; i < JointCount; ++i)
+			{
+				FCompactJoint& Joint = Current.Joints[i];
+				const FCompactJoint& ReferenceJoint = Reference.Joints[i];
+				if (Reader.ReadBits(1) != 0)
+				{
+					Joint.LargestComponent = ReferenceJoint.LargestComponent;
+					for (int32 c = 0; c < 3; ++c)
+					{
+						const int32 Value = ReferenceJoint.Components[c] + UnZigZag(Reader.ReadBits(RotationWidth));
+						Joint.Components[c] = (uint16)FMath::Clamp(Value, 0, (int32)MaxRotationValue);
+					}
+				}
+				else
+				{
+					ReadFullRotation(Reader, Joint);
+				}
+			}
+
+			Current.Joints[0].Position[0] = Current.Joints[0].Position[1] = Current.Joints[0].Position[2] = 0;
+			for (int32 i = 1; i < JointCount; ++i)
+			{
+				for (int32 c = 0; c < 3; ++c)
+				{
+					Current.Joints[i].Position[c] = (int16)(Reference.Joints[i].Position[c] + UnZigZag(Reader.ReadBits(PositionWidth)));
+				}
+			}
+		}
+
+		if (Reader.HasOverflow())
+			return ECompactDecodeResult::Malformed;
+
+		if (OutInfo.bIsKeyframe)
+		{
+			FCompactPose& Keyframe = History[OutInfo.KeyframeId % CompactKeyframeHistory];
+			FMemory::Memcpy(Keyframe.Joints.GetData(), Current.Joints.GetData(), JointCount * sizeof(FCompactJoint));
+			Keyframe.KeyframeId = OutInfo.KeyframeId;
+			Keyframe.bIsValid = true;
+		}
+
+		InOutJoints.SetNum(JointCount, false);
+		for (int32 JointIndex : EvaluationOrder)
+		{
+			const int32 Parent = ParentIndices[JointIndex];
+			const FCompactJoint& Joint = Current.Joints[JointIndex];
+
+			const FQuat LocalRotation = DequantizeRotation(Joint);
+			ModelRotations[JointIndex] = Parent != INDEX_NONE ? ModelRotations[Parent] * LocalRotation : LocalRotation;
+
+			FTransform& Transform = InOutJoints[JointIndex];
+			Transform.SetRotation(ModelRotations[JointIndex]);
+			Transform.SetLocation(RootLocation + FVector(Joint.Position[0], Joint.Position[1], Joint.Position[2]) / CompactPositionScale);
+			Transform.SetScale3D(FVector::OneVector);
+		}
+
+		return ECompactDecodeResult::Decoded;
+	}
+}
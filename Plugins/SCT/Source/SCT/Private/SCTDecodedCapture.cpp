@@ -0,0 +1,157 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTDecodedCapture.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+#include "SCTMemory.h"
+#include "SCTProtocol.h"
+#include "SpatialDataDeserializer.h"
+
+#if WITH_EDITOR
+#include "DerivedDataCacheInterface.h"
+#include "Misc/SecureHash.h"
+#endif
+
+DEFINE_LOG_CATEGORY_STATIC(LogSCTDecodedCapture, Log, All);
+
+#if WITH_EDITOR
+// Change to a new guid whenever the decoded layout or the frame readers change, so cached results are rebuilt
+#define SCT_DECODED_CAPTURE_VERSION TEXT("035C0222-0931-434F-9FFF-6ADDA1025CF3")
+#endif
+
+void FSCTDecodedCapture::Decode(const TArray<uint8>& FrameData, int32 Version, int32 FrameCount, int32 InJointCount)
+{
+	SCT_LLM_SCOPE(DecodedTracks);
+	Empty();
+	JointCount = FMath::Max(InJointCount, 0);
+
+	// Assets built in code leave the version unset. Reading any other version with another version's layout would
+	// produce garbage rather than fail
+	const kh::FProtocolDecoder* Decoder = Version == 0 ? &kh::GetCurrentProtocolDecoder() : kh::FindProtocolDecoder(Version);
+	if (Decoder == nullptr)
+	{
+		UE_LOG(LogSCTDecodedCapture, Warning, TEXT("Can't decode capture of unknown protocol version %d, leaving it empty"), Version);
+		return;
+	}
+
+	const int32 FrameSize = Decoder->GetFrameSize(JointCount > 0, JointCount);
+	FrameCount = FMath::Clamp(FrameCount, 0, FrameData.Num() / FMath::Max(FrameSize, 1));
+
+	Timestamps.SetNumUninitialized(FrameCount);
+	ExposureOffsets.SetNumUninitialized(FrameCount);
+	ExposureDurations.SetNumUninitialized(FrameCount);
+	CameraTransforms.SetNumUninitialized(FrameCount);
+	JointTransforms.SetNum(FrameCount * JointCount);
+
+	// Only read from, the buffer just doesn't take const data
+	FMRSerializeFromBuffer FromBuffer(const_cast<uint8*>(FrameData.GetData()), FrameData.Num());
+	TArray<FTransform> Joints;
+	Joints.SetNum(JointCount);
+
+	for (int32 Frame = 0; Frame < FrameCount; ++Frame)
+	{
+		if (JointCount > 0)
+		{
+			Decoder->ReadSkeletonFrame(FromBuffer, Joints);
+			FMemory::Memcpy(JointTransforms.GetData() + Frame * JointCount, Joints.GetData(), JointCount * sizeof(FTransform));
+		}
+
+		kh::FCameraFrameMetaData MetaData;
+		Decoder->ReadCameraFrame(FromBuffer, CameraTransforms[Frame], MetaData);
+		Timestamps[Frame] = MetaData.Timestamp;
+		ExposureOffsets[Frame] = MetaData.ExposureOffset;
+		ExposureDurations[Frame] = MetaData.ExposureDuration;
+	}
+}
+
+void FSCTDecodedCapture::Empty()
+{
+	JointCount = 0;
+	Timestamps.Empty();
+	ExposureOffsets.Empty();
+	ExposureDurations.Empty();
+	CameraTransforms.Empty();
+	JointTransforms.Empty();
+}
+
+#if WITH_EDITOR
+bool FSCTDecodedCapture::CacheDerivedData(const TArray<uint8>& FrameData, int32 Version, int32 FrameCount, int32 InJointCount)
+{
+	SCT_LLM_SCOPE(DecodedTracks);
+
+	FSHA1 Sha;
+	Sha.Update(FrameData.GetData(), FrameData.Num());
+	Sha.Update((const uint8*)&Version, sizeof(Version));
+	Sha.Update((const uint8*)&FrameCount, sizeof(FrameCount));
+	Sha.Update((const uint8*)&InJointCount, sizeof(InJointCount));
+	Sha.Final();
+	FSHAHash Hash;
+	Sha.GetHash(Hash.Hash);
+
+	const FString Key = FDerivedDataCacheInterface::BuildCacheKey(TEXT("SCTCAPTURE"), SCT_DECODED_CAPTURE_VERSION, *Hash.ToString());
+
+	TArray<uint8> Data;
+	if (GetDerivedDataCacheRef().GetSynchronous(*Key, Data))
+	{
+		FMemoryReader Reader(Data, true);
+		Reader << *this;
+		if (Reader.IsError() == false && JointCount == FMath::Max(InJointCount, 0))
+			return true;
+
+		UE_LOG(LogSCTDecodedCapture, Warning, TEXT("Discarding unreadable cached capture %s"), *Key);
+	}
+
+	Decode(FrameData, Version, FrameCount, InJointCount);
+
+	Data.Reset();
+	FMemoryWriter Writer(Data, true);
+	Writer << *this;
+	GetDerivedDataCacheRef().Put(*Key, Data);
+	return false;
+}
+#endif
+
+SIZE_T FSCTDecodedCapture::GetAllocatedSize() const
+{
+	return Timestamps.GetAllocatedSize() + ExposureOffsets.GetAllocatedSize() + ExposureDurations.GetAllocatedSize()
+		+ CameraTransforms.GetAllocatedSize() + JointTransforms.GetAllocatedSize();
+}
+
+FArchive& operator<<(FArchive& Ar, FSCTDecodedCapture& Decoded)
+{
+	Ar << Decoded.JointCount;
+	Ar << Decoded.Timestamps;
+	Ar << Decoded.ExposureOffsets;
+	Ar << Decoded.ExposureDurations;
+	Ar << Decoded.CameraTransforms;
+	Ar << Decoded.JointTransforms;
+
+	if (Ar.IsLoading() && (Decoded.JointTransforms.Num() != Decoded.CameraTransforms.Num() * Decoded.JointCount
+		|| Decoded.Timestamps.Num() != Decoded.CameraTransforms.Num()))
+	{
+		Ar.SetError();
+	}
+	return Ar;
+}
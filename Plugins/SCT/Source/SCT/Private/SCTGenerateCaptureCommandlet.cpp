@@ -0,0 +1,148 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTGenerateCaptureCommandlet.h"
+#include "SCTCaptureWriter.h"
+#include "SCTSyntheticCapture.h"
+
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/Parse.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSCTGenerateCapture, Log, All);
+
+// Frames are built in memory and written in chunks of about this size, so file size is only bounded by the disk
+static constexpr int32 FlushSize = 4 * 1024 * 1024;
+
+/** Buffers writes to a file, see FlushSize */
+class FChunkedFile
+{
+public:
+	FChunkedFile(IFileHandle* InFile) : File(InFile), Writer(Buffer), BytesWritten(0), bFailed(false) {}
+
+	kh::FCaptureWriter& GetWriter() { return Writer; }
+	int64 GetBytesWritten() const { return BytesWritten + Buffer.Num(); }
+
+	bool Flush(bool bForce)
+	{
+		if (bFailed || (bForce == false && Buffer.Num() < FlushSize))
+			return bFailed == false;
+
+		bFailed = File->Write(Buffer.GetData(), Buffer.Num()) == false;
+		BytesWritten += Buffer.Num();
+		Buffer.Reset();
+		return bFailed == false;
+	}
+
+private:
+	IFileHandle* File;
+	TArray<uint8> Buffer;
+	kh::FCaptureWriter Writer;
+	int64 BytesWritten;
+	bool bFailed;
+};
+
+USCTGenerateCaptureCommandlet::USCTGenerateCaptureCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 USCTGenerateCaptureCommandlet::Main(const FString& Params)
+{
+	const TCHAR* Stream = *Params;
+
+	FString OutputPath;
+	FString Type = TEXT("Camera");
+	kh::FSyntheticCaptureSettings Settings;
+
+	FParse::Value(Stream, TEXT("Output="), OutputPath);
+	FParse::Value(Stream, TEXT("Type="), Type);
+	FParse::Value(Stream, TEXT("Frames="), Settings.Frames);
+	FParse::Value(Stream, TEXT("FrameRate="), Settings.FrameRate);
+	FParse::Value(Stream, TEXT("Seed="), Settings.Seed);
+	FParse::Value(Stream, TEXT("Anchors="), Settings.Anchors);
+	FParse::Value(Stream, TEXT("Joints="), Settings.Joints);
+	FParse::Value(Stream, TEXT("Skeletons="), Settings.Skeletons);
+	FParse::Value(Stream, TEXT("MeshParts="), Settings.MeshParts);
+	FParse::Value(Stream, TEXT("MeshVertices="), Settings.MeshVertices);
+	FParse::Value(Stream, TEXT("MeshInterval="), Settings.MeshInterval);
+
+	Settings.Clamp();
+
+	if (OutputPath.IsEmpty())
+	{
+		UE_LOG(LogSCTGenerateCapture, Error, TEXT("No output given, use -Output=C:/Data/capture.dat"));
+		return 1;
+	}
+
+	const bool bSkeleton = Type == TEXT("Skeleton");
+	const bool bGeometry = Type == TEXT("Geometry");
+	if (bSkeleton == false && bGeometry == false && Type != TEXT("Camera"))
+	{
+		UE_LOG(LogSCTGenerateCapture, Error, TEXT("Unknown type %s, use Camera, Skeleton or Geometry"), *Type);
+		return 1;
+	}
+
+	if (bSkeleton && Settings.Skeletons > 1)
+	{
+		UE_LOG(LogSCTGenerateCapture, Warning, TEXT("Writing %d skeletons per frame. The format allows it, but this plugin only reads captures with one skeleton"), Settings.Skeletons);
+	}
+
+	TUniquePtr<IFileHandle> FileHandle(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*OutputPath));
+	if (FileHandle.IsValid() == false)
+	{
+		UE_LOG(LogSCTGenerateCapture, Error, TEXT("Could not open %s"), *OutputPath);
+		return 1;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	FChunkedFile File(FileHandle.Get());
+	const TCHAR* Unit = bGeometry ? TEXT("updates") : TEXT("frames");
+	int32 LastReported = -1;
+
+	auto OnProgress = [&](int32 Frame)
+	{
+		if (File.Flush(false) == false)
+			return false;
+
+		if (Settings.Frames >= 10 && Frame != LastReported && (Frame + 1) % (Settings.Frames / 10) == 0)
+		{
+			UE_LOG(LogSCTGenerateCapture, Display, TEXT("%d / %d %s, %.1f MB"), Frame + 1, Settings.Frames, Unit, File.GetBytesWritten() / (1024.0 * 1024.0));
+			LastReported = Frame;
+		}
+		return true;
+	};
+
+	const bool bWritten = bGeometry ? kh::WriteSyntheticGeometry(File.GetWriter(), Settings, OnProgress) : kh::WriteSyntheticCapture(File.GetWriter(), Settings, bSkeleton, OnProgress);
+	if (bWritten == false || File.Flush(true) == false)
+	{
+		UE_LOG(LogSCTGenerateCapture, Error, TEXT("Could not write %s"), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(LogSCTGenerateCapture, Display, TEXT("Wrote %s: %s, %d %s, seed %d, %.1f MB in %.1f s"), *OutputPath, *Type, Settings.Frames, Unit,
+		Settings.Seed, File.GetBytesWritten() / (1024.0 * 1024.0), FPlatformTime::Seconds() - StartTime);
+	return 0;
+}
@@ -0,0 +1,160 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTLatencyHistogram.h"
+
+namespace kh
+{
+	FLatencyHistogram::FLatencyHistogram()
+	{
+		Reset();
+	}
+
+	void FLatencyHistogram::Add(double Seconds)
+	{
+		const uint64 Micros = Seconds > 0.0 ? (uint64)(Seconds * 1e6 + 0.5) : 0;
+
+		FPlatformAtomics::InterlockedIncrement(&Buckets[GetBucket(Micros)]);
+		FPlatformAtomics::InterlockedIncrement(&Count);
+		FPlatformAtomics::InterlockedAdd(&TotalMicros, (int64)Micros);
+
+		int64 CurrentMax = FPlatformAtomics::AtomicRead(&MaxMicros);
+		while ((int64)Micros > CurrentMax)
+		{
+			const int64 Previous = FPlatformAtomics::InterlockedCompareExchange(&MaxMicros, (int64)Micros, CurrentMax);
+			if (Previous == CurrentMax)
+				break;
+			CurrentMax = Previous;
+		}
+	}
+
+	void FLatencyHistogram::Reset()
+	{
+		for (int32 i = 0; i < BucketCount; ++i)
+		{
+			FPlatformAtomics::InterlockedExchange(&Buckets[i], 0);
+		}
+		FPlatformAtomics::InterlockedExchange(&Count, 0);
+		FPlatformAtomics::InterlockedExchange(&TotalMicros, 0);
+		FPlatformAtomics::InterlockedExchange(&MaxMicros, 0);
+	}
+
+	void FLatencyHistogram::Merge(const FLatencyHistogram& Other)
+	{
+		for (int32 i = 0; i < BucketCount; ++i)
+		{
+			Buckets[i] += FPlatformAtomics::AtomicRead(&Other.Buckets[i]);
+		}
+		Count += FPlatformAtomics::AtomicRead(&Other.Count);
+		TotalMicros += FPlatformAtomics::AtomicRead(&Other.TotalMicros);
+		MaxMicros = FMath::Max<int64>(MaxMicros, FPlatformAtomics::AtomicRead(&Other.MaxMicros));
+	}
+
+	FLatencySummary FLatencyHistogram::Summarize() const
+	{
+		int32 Snapshot[BucketCount];
+		int64 SnapshotCount = 0;
+		for (int32 i = 0; i < BucketCount; ++i)
+		{
+			Snapshot[i] = FPlatformAtomics::AtomicRead(&Buckets[i]);
+			SnapshotCount += Snapshot[i];
+		}
+
+		FLatencySummary Summary;
+		if (SnapshotCount == 0)
+			return Summary;
+
+		Summary.Count = SnapshotCount;
+		Summary.Mean = (double)FPlatformAtomics::AtomicRead(&TotalMicros) / FMath::Max<int64>(FPlatformAtomics::AtomicRead(&Count), 1) * 1e-6;
+		Summary.Max = FPlatformAtomics::AtomicRead(&MaxMicros) * 1e-6;
+
+		const double Fractions[3] = { 0.5, 0.95, 0.99 };
+		double* Results[3] = { &Summary.P50, &Summary.P95, &Summary.P99 };
+
+		int64 Cumulative = 0;
+		int32 Next = 0;
+		for (int32 i = 0; i < BucketCount && Next < 3; ++i)
+		{
+			Cumulative += Snapshot[i];
+			while (Next < 3 && Cumulative >= (int64)FMath::CeilToDouble(Fractions[Next] * SnapshotCount))
+			{
+				// Never report more than the largest sample, the top bucket can be wide
+				*Results[Next] = FMath::Min(GetBucketValue(i) * 1e-6, Summary.Max);
+				++Next;
+			}
+		}
+
+		return Summary;
+	}
+
+	int32 FLatencyHistogram::GetBucket(uint64 Micros)
+	{
+		// Exact below SubBucketCount, then SubBucketCount linear steps per power of two
+		if (Micros < SubBucketCount)
+			return (int32)Micros;
+
+		const int32 Octave = (int32)FMath::FloorLog2_64(Micros);
+		const int32 SubBucket = (int32)(Micros >> (Octave - SubBucketBits)) & (SubBucketCount - 1);
+		return FMath::Min(((Octave - SubBucketBits + 1) << SubBucketBits) + SubBucket, BucketCount - 1);
+	}
+
+	double FLatencyHistogram::GetBucketValue(int32 Bucket)
+	{
+		if (Bucket < SubBucketCount)
+			return Bucket;
+
+		const int32 Octave = (Bucket >> SubBucketBits) + SubBucketBits - 1;
+		const int32 SubBucket = Bucket & (SubBucketCount - 1);
+		const double Width = (double)(1ull << (Octave - SubBucketBits));
+		return (SubBucketCount + SubBucket) * Width + Width * 0.5;
+	}
+
+	void FLiveLatencyTelemetry::Reset()
+	{
+		for (FLatencyHistogram& Stage : Stages)
+		{
+			Stage.Reset();
+		}
+	}
+
+	void FLiveLatencyTelemetry::Merge(const FLiveLatencyTelemetry& Other)
+	{
+		for (int32 i = 0; i < (int32)ELatencyStage::Count; ++i)
+		{
+			Stages[i].Merge(Other.Stages[i]);
+		}
+	}
+
+	const TCHAR* FLiveLatencyTelemetry::GetStageName(ELatencyStage Stage)
+	{
+		switch (Stage)
+		{
+		case ELatencyStage::Network: return TEXT("Network");
+		case ELatencyStage::Parse: return TEXT("Parse");
+		case ELatencyStage::Buffer: return TEXT("Buffer");
+		case ELatencyStage::Engine: return TEXT("Engine");
+		case ELatencyStage::Total: return TEXT("Total");
+		default: return TEXT("Unknown");
+		}
+	}
+}
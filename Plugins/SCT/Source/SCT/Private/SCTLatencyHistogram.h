@@ -0,0 +1,103 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace kh
+{
+	struct FLatencySummary
+	{
+		int64 Count = 0;
+		double Mean = 0.0;
+		double P50 = 0.0;
+		double P95 = 0.0;
+		double P99 = 0.0;
+		double Max = 0.0;
+	};
+
+	/**
+	 * Histogram of durations that any number of threads can add to without locking.
+	 * Buckets are log scaled with 8 per power of two from 1 us up to about a minute, so percentiles are within
+	 * about 6% of the true value
+	 */
+	class FLatencyHistogram
+	{
+	public:
+		static constexpr int32 SubBucketBits = 3;
+		static constexpr int32 SubBucketCount = 1 << SubBucketBits;
+		static constexpr int32 OctaveCount = 23;
+		static constexpr int32 BucketCount = (OctaveCount + 1) * SubBucketCount;
+
+		FLatencyHistogram();
+
+		/** Adds a duration in seconds, negative durations count as zero */
+		void Add(double Seconds);
+		void Reset();
+		/** Adds the samples of another histogram to this one, not thread safe for this histogram */
+		void Merge(const FLatencyHistogram& Other);
+
+		/** Durations in seconds. Reads while other threads add, so it may miss the samples being added */
+		FLatencySummary Summarize() const;
+
+	private:
+		static int32 GetBucket(uint64 Micros);
+		/** Middle of the range of durations a bucket holds, in microseconds */
+		static double GetBucketValue(int32 Bucket);
+
+		volatile int32 Buckets[BucketCount];
+		volatile int64 Count;
+		volatile int64 TotalMicros;
+		volatile int64 MaxMicros;
+	};
+
+	/** Where a live frame spends its time between being captured and reaching the engine */
+	enum class ELatencyStage : uint8
+	{
+		// Transit above the fastest transit seen. Without a shared clock the absolute transit can't be known
+		Network,
+		// Arrival to parsed, the hand over to a worker and the parse itself
+		Parse,
+		// Parsed to pushed to LiveLink, mostly the jitter buffer delay
+		Buffer,
+		// Pushed to the start of the next engine frame, when LiveLink hands it to its consumers
+		Engine,
+		// Captured to the start of the engine frame that consumes it
+		Total,
+		Count
+	};
+
+	struct FLiveLatencyTelemetry
+	{
+		FLatencyHistogram Stages[(int32)ELatencyStage::Count];
+
+		FLatencyHistogram& operator[](ELatencyStage Stage) { return Stages[(int32)Stage]; }
+		const FLatencyHistogram& operator[](ELatencyStage Stage) const { return Stages[(int32)Stage]; }
+
+		void Reset();
+		void Merge(const FLiveLatencyTelemetry& Other);
+
+		static const TCHAR* GetStageName(ELatencyStage Stage);
+	};
+}
@@ -0,0 +1,500 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTLiveDevice.h"
+#include "SCTLiveRecorder.h"
+#include "SCTStats.h"
+#include "ILiveLinkClient.h"
+
+#include "Misc/ScopeLock.h"
+#include "IPAddress.h"
+#include "Sockets.h"
+#include "Roles/LiveLinkTransformRole.h"
+#include "Roles/LiveLinkTransformTypes.h"
+#include "Roles/LiveLinkAnimationTypes.h"
+#include "Roles/LiveLinkAnimationRole.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSCTLiveDevice, Log, All);
+
+namespace kh
+{
+	FLiveDevice::FLiveDevice(ILiveLinkClient* InClient, const FGuid& InSourceGuid, const FString& InAddress, const FLiveTimingSettings& TimingSettings, const FPosePredictionSettings& PredictionSettings)
+		: LiveLinkClient(InClient)
+		, LiveLinkSourceGuid(InSourceGuid)
+		, Socket(nullptr)
+		, Address(InAddress)
+		, bHasHeader(false)
+		, bIsSkeletonCapture(false)
+		, bHasFrameSequence(false)
+		, LastSequence(0)
+		, ReceivedSequences(0)
+		, Recorder(nullptr)
+		, RecordingTake(0)
+		, Name(Address)
+		, bIsReceiving(false)
+		, PushCount(0)
+		, LastPushTime(0.0)
+		, LastPushCaptureTime(0.0)
+		, LastSampledPushCount(0)
+	{
+		JitterBuffer.SetSettings(TimingSettings);
+		JitterBuffer.Reset();
+		Predictor.SetSettings(PredictionSettings);
+	}
+
+	void FLiveDevice::SetReplyAddress(FSocket* InSocket, const TSharedPtr<FInternetAddr>& InAddress)
+	{
+		Socket = InSocket;
+		ReplyAddress = InAddress;
+	}
+
+	void FLiveDevice::SetRecorder(FLiveRecorder* InRecorder)
+	{
+		Recorder = InRecorder;
+	}
+
+	FLiveDeviceStatus FLiveDevice::GetStatus() const
+	{
+		FLiveDeviceStatus Status;
+		{
+			FScopeLock Lock(&NameLock);
+			Status.Name = Name;
+		}
+		Status.bIsReceiving = bIsReceiving;
+		Status.FramesReceived = FramesReceived.GetValue();
+		Status.FramesLost = FramesLost.GetValue();
+		Status.PlayoutDelayMs = PlayoutDelayMs.GetValue();
+
+		const FLatencySummary Latency = Telemetry[ELatencyStage::Total].Summarize();
+		Status.LatencyP50Ms = (float)(Latency.P50 * 1000.0);
+		Status.LatencyP99Ms = (float)(Latency.P99 * 1000.0);
+		return Status;
+	}
+
+	FString FLiveDevice::GetName() const
+	{
+		FScopeLock Lock(&NameLock);
+		return Name;
+	}
+
+	void FLiveDevice::SampleEngineFrame(double Now)
+	{
+		double PushTime;
+		double CaptureTime;
+		{
+			FScopeLock Lock(&PushLock);
+			if (PushCount == LastSampledPushCount)
+				return;
+
+			LastSampledPushCount = PushCount;
+			PushTime = LastPushTime;
+			CaptureTime = LastPushCaptureTime;
+		}
+
+		Telemetry[ELatencyStage::Engine].Add(Now - PushTime);
+		Telemetry[ELatencyStage::Total].Add(Now - CaptureTime);
+	}
+
+	void FLiveDevice::HandlePacket(uint8* Data, int32 Size, double ArrivalTime)
+	{
+		SCT_SCOPE_CYCLE_COUNTER(STAT_SCT_ParsePacket);
+		INC_DWORD_STAT_BY(STAT_SCT_BytesRead, Size);
+
+		FMRSerializeFromBuffer FromBuffer(Data, Size);
+
+		uint8 PacketType = 0;
+		uint32 Sequence = 0;
+		FromBuffer >> PacketType;
+		FromBuffer >> Sequence;
+
+		if (FromBuffer.HasOverflow())
+			return;
+
+		if ((ELivePacketType)PacketType == ELivePacketType::Header)
+		{
+			HandleHeaderPacket(FromBuffer, Data);
+			return;
+		}
+
+		// Frames can't be published before their subjects exist
+		if (bHasHeader == false)
+			return;
+
+		// Ordering is restored by the jitter buffer, the sequence is only used to count lost packets.
+		// Gaps are counted when they open and un-counted when a reordered packet fills them later
+		const int32 SequenceDelta = (int32)(Sequence - LastSequence);
+		if (bHasFrameSequence == false || SequenceDelta <= -LiveSequenceRestartWindow)
+		{
+			// Everything before the first packet of a stream is treated as received
+			bHasFrameSequence = true;
+			LastSequence = Sequence;
+			ReceivedSequences = ~0ull;
+		}
+		else if (SequenceDelta > 0)
+		{
+			if (SequenceDelta < LiveSequenceRestartWindow)
+			{
+				FramesLost.Add(SequenceDelta - 1);
+			}
+			ReceivedSequences = SequenceDelta < 64 ? (ReceivedSequences << SequenceDelta) | 1 : 1;
+			LastSequence = Sequence;
+		}
+		else if (SequenceDelta > -64)
+		{
+			const uint64 SequenceBit = 1ull << -SequenceDelta;
+			if ((ReceivedSequences & SequenceBit) == 0)
+			{
+				ReceivedSequences |= SequenceBit;
+				FramesLost.Decrement();
+			}
+		}
+
+		switch ((ELivePacketType)PacketType)
+		{
+		case ELivePacketType::CameraFrame:
+		case ELivePacketType::SkeletonFrame:
+		case ELivePacketType::CompactFrame:
+			HandleFramePacket(FromBuffer, Data, (ELivePacketType)PacketType, ArrivalTime);
+			break;
+		default:
+			UE_LOG(LogSCTLiveDevice, Verbose, TEXT("[SCT LIVELINK] Unknown packet type %d from %s"), PacketType, *Address);
+			break;
+		}
+	}
+
+	void FLiveDevice::HandleHeaderPacket(FMRSerializeFromBuffer& FromBuffer, const uint8* Packet)
+	{
+		const int32 HeaderStart = FromBuffer.Tell();
+
+		// Devices resend the header periodically so late receivers can join, only (re)publish when it changes
+		FSpatialHeader NewHeader;
+		ReadHeaderFromBuffer(FromBuffer, NewHeader);
+
+		TArray<FVector> UserAnchors;
+		ReadUserAnchorsFromBuffer(FromBuffer, UserAnchors);
+
+		FSCTSkeletonDefinition NewSkeletonDefinition;
+		const bool bNewIsSkeletonCapture = NewHeader.CaptureType == (int32)ECaptureType::Skeleton;
+		if (bNewIsSkeletonCapture)
+		{
+			ReadSkeletonDefinitionFromBuffer(FromBuffer, NewSkeletonDefinition);
+		}
+		const int32 HeaderEnd = FromBuffer.Tell();
+
+		// Older apps don't send a device name
+		FString NewName;
+		if (FromBuffer.HasOverflow() == false && FromBuffer.AvailableToRead() > 0)
+		{
+			FromBuffer >> NewName;
+		}
+
+		if (FromBuffer.HasOverflow())
+		{
+			UE_LOG(LogSCTLiveDevice, Warning, TEXT("[SCT LIVELINK] Received truncated header from %s"), *Address);
+			return;
+		}
+
+		if (NewHeader.Version != SpatialProtocolVersion)
+		{
+			UE_LOG(LogSCTLiveDevice, Warning, TEXT("[SCT LIVELINK] Version Mismatch (%d) from %s. Make sure your plugin and App versions match"), NewHeader.Version, *Address);
+			return;
+		}
+
+		// Frames are sized and solved from the definition, so a malformed one can't be used
+		if (bNewIsSkeletonCapture && NewSkeletonDefinition.HasValidHierarchy() == false)
+		{
+			UE_LOG(LogSCTLiveDevice, Warning, TEXT("[SCT LIVELINK] Received header with an invalid skeleton hierarchy (%d joints, %d parents) from %s"), NewSkeletonDefinition.JointNames.Num(), NewSkeletonDefinition.ParentIndices.Num(), *Address);
+			return;
+		}
+
+		if (NewName.IsEmpty())
+		{
+			NewName = Address;
+		}
+
+		const FName NewCameraSubjectName(*FString::Printf(TEXT("%s Camera Transform"), *NewName));
+		const bool bIsSameStream = bHasHeader
+			&& CameraSubjectName == NewCameraSubjectName
+			&& bIsSkeletonCapture == bNewIsSkeletonCapture
+			&& SkeletonDefinition.JointNames == NewSkeletonDefinition.JointNames
+			&& SkeletonDefinition.ParentIndices == NewSkeletonDefinition.ParentIndices;
+
+		if (bIsSameStream)
+			return;
+
+		UE_LOG(LogSCTLiveDevice, Display, TEXT("[SCT LIVELINK] Initializing subjects for %s (%s)"), *NewName, *Address);
+
+		RemoveSubjects();
+		SetName(NewName);
+
+		Header = NewHeader;
+		bIsSkeletonCapture = bNewIsSkeletonCapture;
+		SkeletonDefinition = MoveTemp(NewSkeletonDefinition);
+		JitterBuffer.Reset();
+		JitterBuffer.SetJointCount(SkeletonDefinition.JointNames.Num());
+		Predictor.Reset(SkeletonDefinition.JointNames.Num());
+		CompactDecoder.Init(SkeletonDefinition.ParentIndices);
+
+		// A new stream is a new take, the header is recorded as sent minus the device name
+		if (Recorder != nullptr)
+		{
+			if (RecordingTake != 0)
+			{
+				Recorder->EndTake(RecordingTake);
+			}
+
+			const int32 RecordedFrameSize = (bIsSkeletonCapture ? GetSkeletonFrameSize(SkeletonDefinition.JointNames.Num()) : 0) + CameraFrameSize;
+			RecordingTake = Recorder->BeginTake(NewName, Packet + HeaderStart, HeaderEnd - HeaderStart, RecordedFrameSize);
+		}
+
+		if (bIsSkeletonCapture)
+		{
+			SkeletonPoseSolver.Init(SkeletonDefinition);
+
+			const FLiveLinkSubjectKey SubjectKey(LiveLinkSourceGuid, SkeletonSubjectName);
+			FLiveLinkStaticDataStruct StaticDataStruct(FLiveLinkSkeletonStaticData::StaticStruct()); // Create SKELETON static struct
+			FLiveLinkSkeletonStaticData& SkeletonData = *StaticDataStruct.Cast<FLiveLinkSkeletonStaticData>();
+			SkeletonData.SetBoneNames(SkeletonDefinition.JointNames);
+			SkeletonData.SetBoneParents(SkeletonDefinition.ParentIndices);
+			LiveLinkClient->PushSubjectStaticData_AnyThread(SubjectKey, ULiveLinkAnimationRole::StaticClass(), MoveTemp(StaticDataStruct)); // Publish SKELETON role
+		}
+
+		{
+			const FLiveLinkSubjectKey SubjectKey(LiveLinkSourceGuid, CameraSubjectName);
+			FLiveLinkStaticDataStruct StaticDataStruct(FLiveLinkTransformStaticData::StaticStruct()); // Create TRANSFORM static struct
+			LiveLinkClient->PushSubjectStaticData_AnyThread(SubjectKey, ULiveLinkTransformRole::StaticClass(), MoveTemp(StaticDataStruct)); // Publish BASIC role
+		}
+
+		bHasHeader = true;
+		bHasFrameSequence = false;
+		bIsReceiving = true;
+	}
+
+	void FLiveDevice::SetName(const FString& NewName)
+	{
+		CameraSubjectName = FName(*FString::Printf(TEXT("%s Camera Transform"), *NewName));
+		SkeletonSubjectName = FName(*FString::Printf(TEXT("%s Skeleton Transforms"), *NewName));
+
+		FScopeLock Lock(&NameLock);
+		Name = NewName;
+	}
+
+	void FLiveDevice::RemoveSubjects()
+	{
+		// A device that restarts with a new name or capture type shouldn't leave stale subjects behind
+		if (bHasHeader == false)
+			return;
+
+		LiveLinkClient->RemoveSubject_AnyThread(FLiveLinkSubjectKey(LiveLinkSourceGuid, CameraSubjectName));
+		if (bIsSkeletonCapture)
+		{
+			LiveLinkClient->RemoveSubject_AnyThread(FLiveLinkSubjectKey(LiveLinkSourceGuid, SkeletonSubjectName));
+		}
+	}
+
+	void FLiveDevice::HandleFramePacket(FMRSerializeFromBuffer& FromBuffer, const uint8* Packet, ELivePacketType PacketType, double ArrivalTime)
+	{
+		const int32 PayloadStart = FromBuffer.Tell();
+		FLiveFrame* Frame = JitterBuffer.Acquire();
+
+		// Skeleton frames are followed by the camera frame they were captured with
+		bool bHasSkeleton = PacketType == ELivePacketType::SkeletonFrame;
+		if (PacketType == ELivePacketType::CompactFrame)
+		{
+			FCompactFrameInfo Info;
+			ECompactDecodeResult Result;
+			{
+				SCT_SCOPE_CYCLE_COUNTER(STAT_SCT_DecodeCompactFrame);
+				Result = CompactDecoder.Decode(FromBuffer, Frame->Joints, Info);
+			}
+			if (Result != ECompactDecodeResult::Decoded)
+			{
+				// Delta frames are useless until the next keyframe arrives, count them with the lost ones
+				if (Result == ECompactDecodeResult::MissingKeyframe)
+				{
+					FramesLost.Increment();
+				}
+
+				JitterBuffer.Release(Frame);
+				return;
+			}
+
+			if (Info.bIsKeyframe)
+			{
+				SendAck(Info.KeyframeId);
+			}
+			bHasSkeleton = Info.bHasSkeleton;
+		}
+		else if (bHasSkeleton)
+		{
+			FSpatialDataDeserializer::ReadSkeletonFrame(FromBuffer, Frame->Joints);
+		}
+		FSpatialDataDeserializer::ReadCameraFrame(FromBuffer, Frame->CameraTransform, Frame->CameraMetaData);
+
+		if (FromBuffer.HasOverflow())
+		{
+			JitterBuffer.Release(Frame);
+			return;
+		}
+
+		INC_DWORD_STAT(STAT_SCT_FramesDecoded);
+		FSCTCounters::FramesDecoded.Increment();
+
+		Frame->bHasSkeleton = bHasSkeleton && bIsSkeletonCapture;
+		Frame->DeviceTime = Frame->CameraMetaData.Timestamp;
+		Frame->ArrivalTime = ArrivalTime;
+		Frame->ParsedTime = FPlatformTime::Seconds();
+
+		Frame->Recorded.Reset();
+		if (RecordingTake != 0)
+		{
+			FillRecordedFrame(*Frame, PacketType, Packet + PayloadStart, FromBuffer.Tell() - PayloadStart);
+		}
+
+		JitterBuffer.Insert(Frame, ArrivalTime);
+
+		FramesReceived.Increment();
+	}
+
+	void FLiveDevice::FillRecordedFrame(FLiveFrame& Frame, ELivePacketType PacketType, const uint8* Payload, int32 PayloadSize) const
+	{
+		// Full frames are recorded byte for byte, every packet ends with the camera frame
+		if (bIsSkeletonCapture == false || PacketType == ELivePacketType::SkeletonFrame)
+		{
+			const int32 Offset = bIsSkeletonCapture ? 0 : PayloadSize - CameraFrameSize;
+			Frame.Recorded.Append(Payload + Offset, PayloadSize - Offset);
+			return;
+		}
+
+		// Compact frames are written back as matrices in device space, frames without a skeleton hold the neutral pose
+		const TArray<FTransform>& Joints = Frame.bHasSkeleton ? Frame.Joints : SkeletonDefinition.NeutralTransforms;
+		const uint32 SkeletonCount = Frame.bHasSkeleton ? 1 : 0;
+		Frame.Recorded.Append((const uint8*)&SkeletonCount, sizeof(SkeletonCount));
+
+		for (const FTransform& Joint : Joints)
+		{
+			const FQuat Rotation = Joint.GetRotation();
+			const FVector Location = Joint.GetLocation() / 100.0f;
+			const FMatrix RawYUpMatrix = FQuatRotationTranslationMatrix(FQuat(Rotation.Y, Rotation.Z, -Rotation.X, -Rotation.W), FVector(Location.Y, Location.Z, -Location.X));
+			Frame.Recorded.Append((const uint8*)&RawYUpMatrix.M[0][0], sizeof(RawYUpMatrix.M));
+		}
+
+		Frame.Recorded.Append(Payload + PayloadSize - CameraFrameSize, CameraFrameSize);
+	}
+
+	void FLiveDevice::SendAck(uint16 KeyframeId)
+	{
+		if (Socket == nullptr || ReplyAddress.IsValid() == false)
+			return;
+
+		// [Packet Type][Sequence, unused][Keyframe Id]
+		uint8 Packet[7] = { (uint8)ELivePacketType::Ack, 0, 0, 0, 0 };
+		FMemory::Memcpy(&Packet[5], &KeyframeId, sizeof(KeyframeId));
+
+		int32 BytesSent = 0;
+		Socket->SendTo(Packet, sizeof(Packet), BytesSent, *ReplyAddress);
+	}
+
+	void FLiveDevice::PublishDueFrames(double Now)
+	{
+		while (FLiveFrame* Frame = JitterBuffer.PopDue(Now))
+		{
+			PublishFrame(*Frame, Now);
+			JitterBuffer.Release(Frame);
+		}
+
+		PlayoutDelayMs.Set(FMath::RoundToInt(JitterBuffer.GetPlayoutDelay() * 1000.0));
+	}
+
+	void FLiveDevice::PublishFrame(FLiveFrame& Frame, double Now)
+	{
+		const double CaptureTime = JitterBuffer.GetClock().ToEngineTime(Frame.DeviceTime);
+		Telemetry[ELatencyStage::Network].Add(Frame.ArrivalTime - CaptureTime);
+		Telemetry[ELatencyStage::Parse].Add(Frame.ParsedTime - Frame.ArrivalTime);
+		Telemetry[ELatencyStage::Buffer].Add(Now - Frame.ParsedTime);
+
+		// Recorded in playout order, before prediction changes the pose
+		if (RecordingTake != 0 && Frame.Recorded.Num() > 0)
+		{
+			Recorder->AddFrame(RecordingTake, Frame.DeviceTime, Frame.Recorded);
+		}
+
+		// Hide the delay between capture and publishing, plus whatever the user says happens after us
+		if (Predictor.GetSettings().bEnabled)
+		{
+			SCT_SCOPE_CYCLE_COUNTER(STAT_SCT_PredictPose);
+			const double MeasuredLatency = Now - CaptureTime;
+			const double Horizon = FMath::Max(0.0, MeasuredLatency) + Predictor.GetSettings().AdditionalLatency;
+			Predictor.Apply(Frame.DeviceTime, Horizon, Frame.CameraTransform, Frame.bHasSkeleton ? &Frame.Joints : nullptr);
+		}
+
+		{
+			SCT_SCOPE_CYCLE_COUNTER(STAT_SCT_PushLiveLink);
+
+			// Push SKELETON data to the link
+			if (Frame.bHasSkeleton)
+			{
+				const FLiveLinkSubjectKey SubjectKey(LiveLinkSourceGuid, SkeletonSubjectName);
+				FLiveLinkFrameDataStruct FrameDataStruct(FLiveLinkAnimationFrameData::StaticStruct());
+				if (UpdateSkeletonFrameData(*FrameDataStruct.Cast<FLiveLinkAnimationFrameData>(), Frame))
+				{
+					LiveLinkClient->PushSubjectFrameData_AnyThread(SubjectKey, MoveTemp(FrameDataStruct));
+				}
+			}
+
+			//Push TRANSFORM data to the link
+			{
+				const FLiveLinkSubjectKey SubjectKey(LiveLinkSourceGuid, CameraSubjectName);
+				FLiveLinkFrameDataStruct FrameDataStruct(FLiveLinkTransformFrameData::StaticStruct());
+				UpdateTransformFrameData(*FrameDataStruct.Cast<FLiveLinkTransformFrameData>(), Frame);
+				LiveLinkClient->PushSubjectFrameData_AnyThread(SubjectKey, MoveTemp(FrameDataStruct));
+			}
+		}
+		INC_DWORD_STAT(STAT_SCT_FramesPushed);
+
+		// The game thread completes the latency at the start of the next engine frame
+		const double PushTime = FPlatformTime::Seconds();
+		FScopeLock Lock(&PushLock);
+		++PushCount;
+		LastPushTime = PushTime;
+		LastPushCaptureTime = CaptureTime;
+	}
+
+	void FLiveDevice::UpdateBaseFrameData(FLiveLinkBaseFrameData& InOutData, const FLiveFrame& Frame)
+	{
+		// Stamped with the device capture time mapped into engine time, not the arrival time, so network jitter doesn't become motion jitter
+		InOutData.WorldTime = Frame.PlayoutTime;
+	}
+
+	void FLiveDevice::UpdateTransformFrameData(FLiveLinkTransformFrameData& InOutData, const FLiveFrame& Frame)
+	{
+		UpdateBaseFrameData(InOutData, Frame);
+		InOutData.Transform = Frame.CameraTransform;
+	}
+
+	bool FLiveDevice::UpdateSkeletonFrameData(FLiveLinkAnimationFrameData& InOutData, const FLiveFrame& Frame)
+	{
+		UpdateBaseFrameData(InOutData, Frame);
+		return SkeletonPoseSolver.ComputeLocalPose(Frame.Joints, InOutData.Transforms);
+	}
+}
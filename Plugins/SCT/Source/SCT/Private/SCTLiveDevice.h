@@ -0,0 +1,151 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+
+#include "SCTProtocol.h"
+#include "SCTSpatialSkeletonAsset.h"
+#include "SCTSkeletonLayout.h"
+#include "SCTLiveTiming.h"
+#include "SCTPosePredictor.h"
+#include "SCTCompactFrame.h"
+#include "SCTLatencyHistogram.h"
+
+class FSocket;
+class FInternetAddr;
+class ILiveLinkClient;
+class FMRSerializeFromBuffer;
+struct FLiveLinkBaseFrameData;
+struct FLiveLinkTransformFrameData;
+struct FLiveLinkAnimationFrameData;
+
+namespace kh
+{
+	class FLiveRecorder;
+
+	struct FLiveDeviceStatus
+	{
+		FString Name;
+		bool bIsReceiving = false;
+		int32 FramesReceived = 0;
+		int32 FramesLost = 0;
+		int32 PlayoutDelayMs = 0;
+		float LatencyP50Ms = 0.0f;
+		float LatencyP99Ms = 0.0f;
+	};
+
+	/**
+	 * Stream state and LiveLink subjects of one device sending to the live source.
+	 * A device is only ever touched by the worker thread it is assigned to, so it needs no locking apart from the
+	 * status which is read from the game thread
+	 */
+	class FLiveDevice
+	{
+	public:
+		FLiveDevice(ILiveLinkClient* InClient, const FGuid& InSourceGuid, const FString& InAddress, const FLiveTimingSettings& TimingSettings, const FPosePredictionSettings& PredictionSettings);
+
+		/** Where keyframe acks go, devices without a way back must not rely on acks */
+		void SetReplyAddress(FSocket* InSocket, const TSharedPtr<FInternetAddr>& InAddress);
+		/** Records every stream the device sends from its next header on */
+		void SetRecorder(FLiveRecorder* InRecorder);
+
+		// Worker thread only
+		void HandlePacket(uint8* Data, int32 Size, double ArrivalTime);
+		void PublishDueFrames(double Now);
+		double GetNextDueTime() const { return JitterBuffer.GetNextDueTime(); }
+
+		// Any thread
+		FLiveDeviceStatus GetStatus() const;
+		FString GetName() const;
+		const FLiveLatencyTelemetry& GetTelemetry() const { return Telemetry; }
+		void ResetTelemetry() { Telemetry.Reset(); }
+
+		// Game thread only
+		/** Completes the latency of the last pushed frame, call at the start of every engine frame */
+		void SampleEngineFrame(double Now);
+
+	private:
+		void HandleHeaderPacket(FMRSerializeFromBuffer& FromBuffer, const uint8* Packet);
+		void HandleFramePacket(FMRSerializeFromBuffer& FromBuffer, const uint8* Packet, ELivePacketType PacketType, double ArrivalTime);
+		void FillRecordedFrame(FLiveFrame& Frame, ELivePacketType PacketType, const uint8* Payload, int32 PayloadSize) const;
+		void SendAck(uint16 KeyframeId);
+		void PublishFrame(FLiveFrame& Frame, double Now);
+		void SetName(const FString& NewName);
+		void RemoveSubjects();
+
+		void UpdateBaseFrameData(FLiveLinkBaseFrameData& InOutData, const FLiveFrame& Frame);
+		void UpdateTransformFrameData(FLiveLinkTransformFrameData& InOutData, const FLiveFrame& Frame);
+		bool UpdateSkeletonFrameData(FLiveLinkAnimationFrameData& InOutData, const FLiveFrame& Frame);
+
+		ILiveLinkClient* LiveLinkClient;
+		FGuid LiveLinkSourceGuid;
+		// Shared with the receive thread, only used to send acks
+		FSocket* Socket;
+		TSharedPtr<FInternetAddr> ReplyAddress;
+		FString Address;
+
+		// Stream state
+		bool bHasHeader;
+		bool bIsSkeletonCapture;
+		bool bHasFrameSequence;
+		uint32 LastSequence;
+		// Bit N is set once LastSequence - N has arrived
+		uint64 ReceivedSequences;
+		FSpatialHeader Header;
+		FSCTSkeletonDefinition SkeletonDefinition;
+		FName CameraSubjectName;
+		FName SkeletonSubjectName;
+
+		FLiveJitterBuffer JitterBuffer;
+		FSubjectPredictor Predictor;
+		FSkeletonPoseSolver SkeletonPoseSolver;
+		FCompactFrameDecoder CompactDecoder;
+
+		FLiveRecorder* Recorder;
+		// Zero while no take is being recorded
+		uint32 RecordingTake;
+
+		// Status
+		mutable FCriticalSection NameLock;
+		FString Name;
+		FThreadSafeBool bIsReceiving;
+		FThreadSafeCounter FramesReceived;
+		FThreadSafeCounter FramesLost;
+		FThreadSafeCounter PlayoutDelayMs;
+
+		// Latency telemetry, written by the worker and completed on the game thread
+		FLiveLatencyTelemetry Telemetry;
+		// The last pushed frame
+		mutable FCriticalSection PushLock;
+		int64 PushCount;
+		double LastPushTime;
+		double LastPushCaptureTime;
+		// Only used on the game thread
+		int64 LastSampledPushCount;
+	};
+}
@@ -0,0 +1,167 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTLiveDeviceWorker.h"
+#include "SCTLiveDevice.h"
+#include "SCTMemory.h"
+
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSCTLiveDeviceWorker, Log, All);
+
+namespace kh
+{
+	// Each record is [Device pointer][Arrival time][Packet]
+	static constexpr uint32 RecordPrefixSize = sizeof(uint64) + sizeof(double);
+
+	FLiveDeviceWorker::FLiveDeviceWorker(int32 InIndex, uint32 RingCapacity)
+		: Index(InIndex)
+		, RingMemory(nullptr)
+		, WakeEvent(FPlatformProcess::GetSynchEventFromPool(false))
+		, Thread(nullptr)
+		, bStopping(false)
+	{
+		const SIZE_T MemorySize = FSpscByteRing::GetMemorySize(RingCapacity);
+		RingMemory = FMemory::Malloc(MemorySize, 64);
+		Ring.Init(RingMemory, MemorySize, true);
+	}
+
+	FLiveDeviceWorker::~FLiveDeviceWorker()
+	{
+		StopThread();
+
+		FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+		WakeEvent = nullptr;
+
+		FMemory::Free(RingMemory);
+		RingMemory = nullptr;
+	}
+
+	bool FLiveDeviceWorker::StartThread()
+	{
+		const FString ThreadName = FString::Printf(TEXT("SCTLiveLinkWorker%d"), Index);
+		Thread = FRunnableThread::Create(this, *ThreadName, 128 * 1024, TPri_AboveNormal);
+		if (Thread == nullptr)
+		{
+			UE_LOG(LogSCTLiveDeviceWorker, Error, TEXT("[SCT LIVELINK] Could not create worker thread %d"), Index);
+			return false;
+		}
+
+		return true;
+	}
+
+	void FLiveDeviceWorker::StopThread()
+	{
+		Stop();
+
+		if (Thread != nullptr)
+		{
+			Thread->WaitForCompletion();
+			delete Thread;
+			Thread = nullptr;
+		}
+	}
+
+	bool FLiveDeviceWorker::Enqueue(FLiveDevice* Device, const uint8* Data, int32 Size, double ArrivalTime)
+	{
+		uint8* Record = Ring.BeginWrite(RecordPrefixSize + Size);
+		if (Record == nullptr)
+		{
+			DroppedPackets.Increment();
+			WakeEvent->Trigger();
+			return false;
+		}
+
+		const uint64 DevicePtr = (uint64)(UPTRINT)Device;
+		FMemory::Memcpy(Record, &DevicePtr, sizeof(DevicePtr));
+		FMemory::Memcpy(Record + sizeof(DevicePtr), &ArrivalTime, sizeof(ArrivalTime));
+		FMemory::Memcpy(Record + RecordPrefixSize, Data, Size);
+		Ring.EndWrite();
+
+		WakeEvent->Trigger();
+		return true;
+	}
+
+	uint32 FLiveDeviceWorker::Run()
+	{
+		SCT_LLM_SCOPE(LiveLink);
+
+		const double MaxWaitSeconds = 0.1;
+
+		while (bStopping == false)
+		{
+			ProcessQueuedPackets();
+
+			const double Now = FPlatformTime::Seconds();
+			double NextDueTime = Now + MaxWaitSeconds;
+			for (FLiveDevice* Device : Devices)
+			{
+				Device->PublishDueFrames(Now);
+				NextDueTime = FMath::Min(NextDueTime, Device->GetNextDueTime());
+			}
+
+			// Sleep until a packet is queued or the next buffered frame is due
+			const double WaitSeconds = NextDueTime - FPlatformTime::Seconds();
+			if (WaitSeconds > 0.0)
+			{
+				WakeEvent->Wait(FMath::CeilToInt(WaitSeconds * 1000.0));
+			}
+		}
+
+		return 0;
+	}
+
+	void FLiveDeviceWorker::Stop()
+	{
+		bStopping = true;
+
+		if (WakeEvent != nullptr)
+		{
+			WakeEvent->Trigger();
+		}
+	}
+
+	void FLiveDeviceWorker::ProcessQueuedPackets()
+	{
+		uint8* Record = nullptr;
+		uint32 RecordSize = 0;
+		while (bStopping == false && Ring.BeginRead(Record, RecordSize))
+		{
+			if (RecordSize >= RecordPrefixSize)
+			{
+				uint64 DevicePtr = 0;
+				double ArrivalTime = 0.0;
+				FMemory::Memcpy(&DevicePtr, Record, sizeof(DevicePtr));
+				FMemory::Memcpy(&ArrivalTime, Record + sizeof(DevicePtr), sizeof(ArrivalTime));
+
+				FLiveDevice* Device = (FLiveDevice*)(UPTRINT)DevicePtr;
+				Devices.AddUnique(Device);
+				Device->HandlePacket(Record + RecordPrefixSize, RecordSize - RecordPrefixSize, ArrivalTime);
+			}
+
+			Ring.EndRead();
+		}
+	}
+}
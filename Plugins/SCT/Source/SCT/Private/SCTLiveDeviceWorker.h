@@ -0,0 +1,79 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+
+#include "SCTSpscRing.h"
+
+class FEvent;
+class FRunnableThread;
+
+namespace kh
+{
+	class FLiveDevice;
+
+	/**
+	 * Parses and publishes the packets of a fixed set of devices on its own thread.
+	 * The receive thread hands packets over through a single producer ring, so no lock is shared between the
+	 * receive thread and the workers, or between workers. Each device is assigned to exactly one worker
+	 */
+	class FLiveDeviceWorker : public FRunnable
+	{
+	public:
+		FLiveDeviceWorker(int32 InIndex, uint32 RingCapacity);
+		virtual ~FLiveDeviceWorker();
+
+		bool StartThread();
+		/** Stops the thread and waits for it, queued packets are dropped */
+		void StopThread();
+
+		/** Receive thread only. Copies a packet into the ring, returns false if the worker fell behind and it was dropped */
+		bool Enqueue(FLiveDevice* Device, const uint8* Data, int32 Size, double ArrivalTime);
+
+		int32 GetDroppedPackets() const { return DroppedPackets.GetValue(); }
+
+		// Begin FRunnable Interface
+		virtual uint32 Run() override;
+		virtual void Stop() override;
+		// End FRunnable Interface
+
+	private:
+		void ProcessQueuedPackets();
+
+		int32 Index;
+		void* RingMemory;
+		FSpscByteRing Ring;
+		FEvent* WakeEvent;
+		FRunnableThread* Thread;
+		FThreadSafeBool bStopping;
+		FThreadSafeCounter DroppedPackets;
+
+		// Devices seen by this worker, worker thread only
+		TArray<FLiveDevice*> Devices;
+	};
+}
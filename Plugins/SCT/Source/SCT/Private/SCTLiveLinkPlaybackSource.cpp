@@ -0,0 +1,408 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTLiveLinkPlaybackSource.h"
+#include "SCTProtocol.h"
+#include "SCTSkeletonLayout.h"
+#include "SCTSpatialSkeletonAsset.h"
+#include "SpatialDataDeserializer.h"
+#include "SCTMemory.h"
+#include "SCTStats.h"
+#include "ILiveLinkClient.h"
+
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+#include "Roles/LiveLinkTransformRole.h"
+#include "Roles/LiveLinkTransformTypes.h"
+#include "Roles/LiveLinkAnimationTypes.h"
+#include "Roles/LiveLinkAnimationRole.h"
+
+#define LOCTEXT_NAMESPACE "FSCTLiveLinkModule"
+DEFINE_LOG_CATEGORY_STATIC(LogSCTLiveLinkPlaybackSource, Log, All);
+
+// After a longer stall playback skips ahead instead of bursting through the missed frames
+static constexpr double MaxCatchUpSeconds = 0.5;
+// Frame interval assumed when the timestamps can't give one
+static constexpr double NominalFrameInterval = 1.0 / 60.0;
+
+struct FSCTLiveLinkPlaybackSource::FPlaybackTrack
+{
+	FString Name;
+	bool bIsSkeleton = false;
+	const kh::FProtocolDecoder* Decoder = nullptr;
+	int32 FrameCount = 0;
+	int32 FrameSize = 0;
+	TArray<uint8> FrameData;
+	FSCTSkeletonDefinition SkeletonDefinition;
+	FName CameraSubjectName;
+	FName SkeletonSubjectName;
+
+	// Playback state, worker thread only
+	FMRSerializeFromBuffer FromBuffer;
+	int32 CurrFrame = 0;
+	bool bFinished = false;
+	double StartTime = 0.0;
+	double FirstTimestamp = 0.0;
+	double LoopDuration = 0.0;
+	double LoopOffset = 0.0;
+	double NextDueTime = 0.0;
+	FTransform CameraTransform;
+	kh::FCameraFrameMetaData CameraMetaData;
+	TArray<FTransform> Joints;
+	kh::FSkeletonPoseSolver SkeletonPoseSolver;
+};
+
+static double ReadFrameTimestamp(TArray<uint8>& FrameData, int32 Offset, const kh::FProtocolDecoder& Decoder)
+{
+	FMRSerializeFromBuffer FromBuffer(FrameData.GetData() + Offset, Decoder.CameraFrameSize);
+	FTransform Transform;
+	kh::FCameraFrameMetaData MetaData = {};
+	Decoder.ReadCameraFrame(FromBuffer, Transform, MetaData);
+	return MetaData.Timestamp;
+}
+
+FSCTLiveLinkPlaybackSource::FSCTLiveLinkPlaybackSource(const TArray<USCTSpatialCameraAsset*>& Assets, const FSCTLiveLinkPlaybackSettings& InSettings)
+	: LiveLinkClient(nullptr)
+	, Settings(InSettings)
+	, Thread(nullptr)
+	, WakeEvent(FPlatformProcess::GetSynchEventFromPool(false))
+	, bStopping(false)
+{
+	check(IsInGameThread());
+	SCT_LLM_SCOPE(DecodedTracks);
+
+	SourceType = LOCTEXT("SCTLiveLinkPlaybackSourceType", "SCT Playback");
+	SourceMachineName = LOCTEXT("SCTLiveLinkPlaybackSourceMachineName", "Recorded captures");
+
+	Settings.PlaybackRate = FMath::Max(Settings.PlaybackRate, 0.01f);
+
+	TSet<FString> UsedNames;
+	for (USCTSpatialCameraAsset* Asset : Assets)
+	{
+		if (Asset == nullptr)
+			continue;
+
+		TUniquePtr<FPlaybackTrack> Track = MakeUnique<FPlaybackTrack>();
+
+		// Assets built in code leave the version unset, those are read as the current version. Any other version
+		// without a decoder would be read with the wrong layout
+		Track->Decoder = Asset->Version == 0 ? &kh::GetCurrentProtocolDecoder() : kh::FindProtocolDecoder(Asset->Version);
+		if (Track->Decoder == nullptr)
+		{
+			UE_LOG(LogSCTLiveLinkPlaybackSource, Error, TEXT("[SCT LIVELINK] %s has unsupported version %d, skipping"), *Asset->GetName(), Asset->Version);
+			continue;
+		}
+
+		USCTSpatialSkeletonAsset* SkeletonAsset = Cast<USCTSpatialSkeletonAsset>(Asset);
+		Track->bIsSkeleton = SkeletonAsset != nullptr;
+		if (SkeletonAsset != nullptr)
+		{
+			if (SkeletonAsset->SkeletonDefinition.HasValidHierarchy() == false)
+			{
+				UE_LOG(LogSCTLiveLinkPlaybackSource, Warning, TEXT("[SCT LIVELINK] %s has an invalid skeleton hierarchy, skipping"), *Asset->GetName());
+				continue;
+			}
+			Track->SkeletonDefinition = SkeletonAsset->SkeletonDefinition;
+		}
+		Track->FrameSize = Track->Decoder->GetFrameSize(Track->bIsSkeleton, Track->SkeletonDefinition.JointNames.Num());
+
+		// Trust the data over the header if the capture was cut short
+		Track->FrameCount = FMath::Min(Asset->FrameCount, Asset->FrameData.Num() / Track->FrameSize);
+		if (Track->FrameCount <= 0)
+		{
+			UE_LOG(LogSCTLiveLinkPlaybackSource, Warning, TEXT("[SCT LIVELINK] %s has no frames, skipping"), *Asset->GetName());
+			continue;
+		}
+
+		Track->FrameData = Asset->FrameData;
+
+		// Subject names have to be unique within the source
+		Track->Name = Asset->GetName();
+		for (int32 Suffix = 2; UsedNames.Contains(Track->Name); ++Suffix)
+		{
+			Track->Name = FString::Printf(TEXT("%s_%d"), *Asset->GetName(), Suffix);
+		}
+		UsedNames.Add(Track->Name);
+
+		Track->CameraSubjectName = FName(*FString::Printf(TEXT("%s Camera Transform"), *Track->Name));
+		Track->SkeletonSubjectName = FName(*FString::Printf(TEXT("%s Skeleton Transforms"), *Track->Name));
+
+		// Looping continues one average frame interval after the last frame. Equal or backwards timestamps would give
+		// a loop that takes no time, so every loop lasts at least one frame
+		const int32 CameraOffset = Track->FrameSize - Track->Decoder->CameraFrameSize;
+		Track->FirstTimestamp = ReadFrameTimestamp(Track->FrameData, CameraOffset, *Track->Decoder);
+		const double LastTimestamp = ReadFrameTimestamp(Track->FrameData, (Track->FrameCount - 1) * Track->FrameSize + CameraOffset, *Track->Decoder);
+		const double MeasuredLoopDuration = Track->FrameCount > 1 ? (LastTimestamp - Track->FirstTimestamp) * Track->FrameCount / (Track->FrameCount - 1) : 0.0;
+		Track->LoopDuration = FMath::Max(MeasuredLoopDuration, NominalFrameInterval);
+
+		Tracks.Add(MoveTemp(Track));
+	}
+}
+
+FSCTLiveLinkPlaybackSource::~FSCTLiveLinkPlaybackSource()
+{
+	StopThread();
+
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+}
+
+void FSCTLiveLinkPlaybackSource::ReceiveClient(ILiveLinkClient* InClient, FGuid InSourceGuid)
+{
+	LiveLinkClient = InClient;
+	LiveLinkSourceGuid = InSourceGuid;
+
+	for (const TUniquePtr<FPlaybackTrack>& Track : Tracks)
+	{
+		if (Track->bIsSkeleton)
+		{
+			const FLiveLinkSubjectKey SubjectKey(LiveLinkSourceGuid, Track->SkeletonSubjectName);
+			FLiveLinkStaticDataStruct StaticDataStruct(FLiveLinkSkeletonStaticData::StaticStruct());
+			FLiveLinkSkeletonStaticData& SkeletonData = *StaticDataStruct.Cast<FLiveLinkSkeletonStaticData>();
+			SkeletonData.SetBoneNames(Track->SkeletonDefinition.JointNames);
+			SkeletonData.SetBoneParents(Track->SkeletonDefinition.ParentIndices);
+			LiveLinkClient->PushSubjectStaticData_AnyThread(SubjectKey, ULiveLinkAnimationRole::StaticClass(), MoveTemp(StaticDataStruct));
+		}
+
+		const FLiveLinkSubjectKey SubjectKey(LiveLinkSourceGuid, Track->CameraSubjectName);
+		FLiveLinkStaticDataStruct StaticDataStruct(FLiveLinkTransformStaticData::StaticStruct());
+		LiveLinkClient->PushSubjectStaticData_AnyThread(SubjectKey, ULiveLinkTransformRole::StaticClass(), MoveTemp(StaticDataStruct));
+	}
+
+	UE_LOG(LogSCTLiveLinkPlaybackSource, Display, TEXT("[SCT LIVELINK] Playing back %d captures"), Tracks.Num());
+
+	if (Tracks.Num() > 0)
+	{
+		Thread = FRunnableThread::Create(this, TEXT("SCTLiveLinkPlayback"), 128 * 1024, TPri_AboveNormal);
+	}
+}
+
+bool FSCTLiveLinkPlaybackSource::IsSourceStillValid() const
+{
+	return LiveLinkClient != nullptr;
+}
+
+bool FSCTLiveLinkPlaybackSource::RequestSourceShutdown()
+{
+	StopThread();
+
+	LiveLinkClient = nullptr;
+	LiveLinkSourceGuid.Invalidate();
+	return true;
+}
+
+void FSCTLiveLinkPlaybackSource::StopThread()
+{
+	Stop();
+
+	if (Thread != nullptr)
+	{
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+FText FSCTLiveLinkPlaybackSource::GetSourceType() const
+{
+	return SourceType;
+}
+
+FText FSCTLiveLinkPlaybackSource::GetSourceMachineName() const
+{
+	return SourceMachineName;
+}
+
+FText FSCTLiveLinkPlaybackSource::GetSourceStatus() const
+{
+	if (Tracks.Num() == 0)
+	{
+		return LOCTEXT("PlaybackStatus_NoCaptures", "No captures");
+	}
+
+	if (ActiveTracks.GetValue() == 0 && FramesPublished.GetValue() > 0)
+	{
+		return FText::Format(LOCTEXT("PlaybackStatus_Finished", "Finished ({0} frames)"), FText::AsNumber(FramesPublished.GetValue()));
+	}
+
+	return FText::Format(LOCTEXT("PlaybackStatus_Playing", "Playing {0} captures ({1} frames)"), FText::AsNumber(Tracks.Num()), FText::AsNumber(FramesPublished.GetValue()));
+}
+
+uint32 FSCTLiveLinkPlaybackSource::Run()
+{
+	SCT_LLM_SCOPE(LiveLink);
+
+	const double MaxWaitSeconds = 0.1;
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (TUniquePtr<FPlaybackTrack>& Track : Tracks)
+	{
+		StartTrack(*Track, StartTime);
+	}
+
+	while (bStopping == false)
+	{
+		const double Now = FPlatformTime::Seconds();
+		double NextDueTime = Now + MaxWaitSeconds;
+		int32 NumActive = 0;
+
+		for (TUniquePtr<FPlaybackTrack>& Track : Tracks)
+		{
+			if (Track->bFinished)
+				continue;
+
+			if (Now - Track->NextDueTime > MaxCatchUpSeconds)
+			{
+				Track->StartTime += Now - Track->NextDueTime;
+				Track->NextDueTime = Now;
+			}
+
+			// At most one pass over the capture per wake up, so frames that are all due at once can't keep the thread
+			// from seeing bStopping
+			for (int32 Published = 0; Published < Track->FrameCount && bStopping == false && Track->bFinished == false && Track->NextDueTime <= Now; ++Published)
+			{
+				PublishFrame(*Track);
+				ReadNextFrame(*Track);
+			}
+
+			if (Track->bFinished == false)
+			{
+				++NumActive;
+				NextDueTime = FMath::Min(NextDueTime, Track->NextDueTime);
+			}
+		}
+
+		ActiveTracks.Set(NumActive);
+		if (NumActive == 0)
+			break;
+
+		const double WaitSeconds = NextDueTime - FPlatformTime::Seconds();
+		if (WaitSeconds > 0.0)
+		{
+			WakeEvent->Wait(FMath::CeilToInt(WaitSeconds * 1000.0));
+		}
+	}
+
+	return 0;
+}
+
+void FSCTLiveLinkPlaybackSource::Stop()
+{
+	bStopping = true;
+
+	if (WakeEvent != nullptr)
+	{
+		WakeEvent->Trigger();
+	}
+}
+
+void FSCTLiveLinkPlaybackSource::StartTrack(FPlaybackTrack& Track, double StartTime)
+{
+	Track.FromBuffer.Init(Track.FrameData.GetData(), Track.FrameData.Num());
+	Track.FromBuffer.Reset();
+	Track.CurrFrame = 0;
+	Track.bFinished = false;
+	Track.StartTime = StartTime;
+	Track.LoopOffset = 0.0;
+	Track.Joints.SetNum(Track.SkeletonDefinition.JointNames.Num());
+
+	if (Track.bIsSkeleton)
+	{
+		Track.SkeletonPoseSolver.Init(Track.SkeletonDefinition);
+	}
+
+	ReadNextFrame(Track);
+}
+
+bool FSCTLiveLinkPlaybackSource::ReadNextFrame(FPlaybackTrack& Track)
+{
+	if (Track.CurrFrame >= Track.FrameCount)
+	{
+		if (Settings.bLoop == false)
+		{
+			Track.bFinished = true;
+			return false;
+		}
+
+		Track.FromBuffer.Reset();
+		Track.CurrFrame = 0;
+		Track.LoopOffset += Track.LoopDuration;
+	}
+
+	SCT_SCOPE_CYCLE_COUNTER(STAT_SCT_ReadPlaybackFrame);
+	const int32 Start = Track.FromBuffer.Tell();
+
+	// Skeleton frames are followed by the camera frame they were captured with
+	if (Track.bIsSkeleton)
+	{
+		Track.Decoder->ReadSkeletonFrame(Track.FromBuffer, Track.Joints);
+	}
+	Track.Decoder->ReadCameraFrame(Track.FromBuffer, Track.CameraTransform, Track.CameraMetaData);
+	INC_DWORD_STAT_BY(STAT_SCT_BytesRead, Track.FromBuffer.Tell() - Start);
+
+	if (Track.FromBuffer.HasOverflow())
+	{
+		UE_LOG(LogSCTLiveLinkPlaybackSource, Warning, TEXT("[SCT LIVELINK] %s is truncated at frame %d"), *Track.Name, Track.CurrFrame);
+		Track.bFinished = true;
+		return false;
+	}
+
+	INC_DWORD_STAT(STAT_SCT_FramesDecoded);
+	kh::FSCTCounters::FramesDecoded.Increment();
+
+	++Track.CurrFrame;
+	Track.NextDueTime = Track.StartTime + (Track.CameraMetaData.Timestamp - Track.FirstTimestamp + Track.LoopOffset) / Settings.PlaybackRate;
+	return true;
+}
+
+void FSCTLiveLinkPlaybackSource::PublishFrame(FPlaybackTrack& Track)
+{
+	SCT_SCOPE_CYCLE_COUNTER(STAT_SCT_PushLiveLink);
+
+	if (Track.bIsSkeleton)
+	{
+		const FLiveLinkSubjectKey SubjectKey(LiveLinkSourceGuid, Track.SkeletonSubjectName);
+		FLiveLinkFrameDataStruct FrameDataStruct(FLiveLinkAnimationFrameData::StaticStruct());
+		FLiveLinkAnimationFrameData& FrameData = *FrameDataStruct.Cast<FLiveLinkAnimationFrameData>();
+		FrameData.WorldTime = Track.NextDueTime;
+		if (Track.SkeletonPoseSolver.ComputeLocalPose(Track.Joints, FrameData.Transforms))
+		{
+			LiveLinkClient->PushSubjectFrameData_AnyThread(SubjectKey, MoveTemp(FrameDataStruct));
+		}
+	}
+
+	{
+		const FLiveLinkSubjectKey SubjectKey(LiveLinkSourceGuid, Track.CameraSubjectName);
+		FLiveLinkFrameDataStruct FrameDataStruct(FLiveLinkTransformFrameData::StaticStruct());
+		FLiveLinkTransformFrameData& FrameData = *FrameDataStruct.Cast<FLiveLinkTransformFrameData>();
+		FrameData.WorldTime = Track.NextDueTime;
+		FrameData.Transform = Track.CameraTransform;
+		LiveLinkClient->PushSubjectFrameData_AnyThread(SubjectKey, MoveTemp(FrameDataStruct));
+	}
+
+	FramesPublished.Increment();
+	INC_DWORD_STAT(STAT_SCT_FramesPushed);
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -22,61 +22,311 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #include "SCTLiveLinkSource.h"
+#include "SCTLiveDevice.h"
+#include "SCTLiveDeviceWorker.h"
+#include "SCTLiveRecorder.h"
+#include "SCTSpscRing.h"
+#include "SCTMemory.h"
+#include "SCTStats.h"
 #include "ILiveLinkClient.h"
 
-#include "GenericPlatform/GenericPlatformFile.h"
-#include "HAL/PlatformFilemanager.h"
-#include "Misc/FrameRate.h"
-#include "Roles/LiveLinkTransformRole.h"
-#include "Roles/LiveLinkTransformTypes.h"
-#include "Roles/LiveLinkAnimationTypes.h"
-#include "Roles/LiveLinkAnimationRole.h"
+#include "Common/UdpSocketBuilder.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMisc.h"
+#include "HAL/RunnableThread.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Stats/Stats.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
 
 #define LOCTEXT_NAMESPACE "FSCTLiveLinkModule"
 DEFINE_LOG_CATEGORY_STATIC(LogSCTLiveLinkSource, Log, All);
 
-// TEMP
-static bool bIsBodyTracking = false;
+DECLARE_STATS_GROUP(TEXT("SCT LiveLink"), STATGROUP_SCTLiveLink, STATCAT_Advanced);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Total p50 (ms)"), STAT_SCTLiveLink_TotalP50, STATGROUP_SCTLiveLink);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Total p95 (ms)"), STAT_SCTLiveLink_TotalP95, STATGROUP_SCTLiveLink);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Total p99 (ms)"), STAT_SCTLiveLink_TotalP99, STATGROUP_SCTLiveLink);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Network p99 (ms)"), STAT_SCTLiveLink_NetworkP99, STATGROUP_SCTLiveLink);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Parse p99 (ms)"), STAT_SCTLiveLink_ParseP99, STATGROUP_SCTLiveLink);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Buffer p99 (ms)"), STAT_SCTLiveLink_BufferP99, STATGROUP_SCTLiveLink);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Engine p99 (ms)"), STAT_SCTLiveLink_EngineP99, STATGROUP_SCTLiveLink);
+
+// Guards against a flood of spoofed senders, far more than any stage needs
+static constexpr int32 MaxDevices = 64;
+static constexpr uint32 WorkerRingCapacity = 1024 * 1024;
+// There is no cross process wake up, an idle shared memory ring is polled at this interval
+static constexpr float SharedMemoryPollSeconds = 0.001f;
+
+// Sources alive in this process, for the console commands
+static FCriticalSection ActiveSourcesLock;
+static TArray<FSCTLiveLinkSource*> ActiveSources;
+
+static void WriteLatencyCsv(const TArray<FString>& Args)
+{
+	FString Csv = TEXT("Source,Device,Stage,Samples,Mean (ms),P50 (ms),P95 (ms),P99 (ms),Max (ms)\n");
+	{
+		FScopeLock Lock(&ActiveSourcesLock);
+		for (const FSCTLiveLinkSource* Source : ActiveSources)
+		{
+			Csv += Source->GetLatencyCsvRows();
+		}
+	}
+
+	const FString FileName = Args.Num() > 0 ? Args[0] : FPaths::Combine(FPaths::ProfilingDir(), TEXT("SCT"), FString::Printf(TEXT("LiveLinkLatency-%s.csv"), *FDateTime::Now().ToString()));
+	if (FFileHelper::SaveStringToFile(Csv, *FileName))
+	{
+		UE_LOG(LogSCTLiveLinkSource, Display, TEXT("[SCT LIVELINK] Wrote latency to %s"), *FileName);
+	}
+	else
+	{
+		UE_LOG(LogSCTLiveLinkSource, Error, TEXT("[SCT LIVELINK] Could not write %s"), *FileName);
+	}
+}
 
-FSCTLiveLinkSource::FSCTLiveLinkSource()
+static void ResetLatency()
+{
+	FScopeLock Lock(&ActiveSourcesLock);
+	for (FSCTLiveLinkSource* Source : ActiveSources)
+	{
+		Source->ResetLatency();
+	}
+}
+
+static FAutoConsoleCommand LatencyCsvCommand(
+	TEXT("SCT.LiveLink.LatencyCsv"),
+	TEXT("Writes the latency of every SCT LiveLink device to a CSV file. Takes an optional file name, defaults to Saved/Profiling/SCT"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&WriteLatencyCsv));
+
+static FAutoConsoleCommand ResetLatencyCommand(
+	TEXT("SCT.LiveLink.ResetLatency"),
+	TEXT("Clears the latency histograms of every SCT LiveLink device"),
+	FConsoleCommandDelegate::CreateStatic(&ResetLatency));
+
+static void AppendLatencyCsvRows(FString& Csv, const FString& SourceName, const FString& DeviceName, const kh::FLiveLatencyTelemetry& Telemetry)
+{
+	for (int32 i = 0; i < (int32)kh::ELatencyStage::Count; ++i)
+	{
+		const kh::ELatencyStage Stage = (kh::ELatencyStage)i;
+		const kh::FLatencySummary Summary = Telemetry[Stage].Summarize();
+		Csv += FString::Printf(TEXT("\"%s\",\"%s\",%s,%lld,%.3f,%.3f,%.3f,%.3f,%.3f\n"), *SourceName, *DeviceName, kh::FLiveLatencyTelemetry::GetStageName(Stage),
+			Summary.Count, Summary.Mean * 1000.0, Summary.P50 * 1000.0, Summary.P95 * 1000.0, Summary.P99 * 1000.0, Summary.Max * 1000.0);
+	}
+}
+
+static void ParseSeconds(const TCHAR* Stream, const TCHAR* Match, double& OutSeconds)
+{
+	float Value = 0.0f;
+	if (FParse::Value(Stream, Match, Value))
+	{
+		OutSeconds = Value;
+	}
+}
+
+FSCTLiveLinkSourceSettings FSCTLiveLinkSourceSettings::FromConnectionString(const FString& ConnectionString)
+{
+	FSCTLiveLinkSourceSettings Settings;
+	const TCHAR* Stream = *ConnectionString;
+
+	FParse::Value(Stream, TEXT("Port="), Settings.Port);
+	FParse::Value(Stream, TEXT("Workers="), Settings.WorkerThreads);
+	FParse::Value(Stream, TEXT("SharedMemory="), Settings.SharedMemoryName);
+	FParse::Value(Stream, TEXT("SharedMemorySize="), Settings.SharedMemorySize);
+	FParse::Value(Stream, TEXT("Record="), Settings.RecordDirectory);
+
+	FParse::Bool(Stream, TEXT("JitterBuffer="), Settings.Timing.bUseJitterBuffer);
+	ParseSeconds(Stream, TEXT("MinDelay="), Settings.Timing.MinDelay);
+	ParseSeconds(Stream, TEXT("MaxDelay="), Settings.Timing.MaxDelay);
+
+	FParse::Bool(Stream, TEXT("Predict="), Settings.Prediction.bEnabled);
+	FParse::Bool(Stream, TEXT("PredictJoints="), Settings.Prediction.bPredictJoints);
+	ParseSeconds(Stream, TEXT("Latency="), Settings.Prediction.AdditionalLatency);
+	ParseSeconds(Stream, TEXT("MaxHorizon="), Settings.Prediction.MaxHorizon);
+
+	FString Model;
+	if (FParse::Value(Stream, TEXT("PredictionModel="), Model))
+	{
+		Settings.Prediction.Model = Model == TEXT("ConstantVelocity") ? kh::EPosePredictionModel::ConstantVelocity : kh::EPosePredictionModel::AlphaBeta;
+	}
+
+	return Settings;
+}
+
+FSCTLiveLinkSource::FSCTLiveLinkSource(const FSCTLiveLinkSourceSettings& InSettings)
+	: LiveLinkClient(nullptr)
+	, Settings(InSettings)
+	, MaxWorkers(1)
+	, Socket(nullptr)
+	, SocketSubsystem(nullptr)
+	, Thread(nullptr)
+	, bStopping(false)
+	, SharedMemoryRegion(nullptr)
+	, LastRoute(INDEX_NONE)
 {
 	// Live link params
-	SourceStatus = LOCTEXT("SourceStatus_Active", "Inactive");
 	SourceType = LOCTEXT("SCTLiveLinkSourceType", "SCT LiveLink");
-	SourceMachineName = LOCTEXT("SCTLiveLinkSourceMachineName", "localhost");
-
-	// Disabled for now. Should read from network. Keeping the code compiling for testing purposes
-	USCTSpatialCameraAsset* CameraAsset = nullptr;
-	if (CameraAsset)
+	if (Settings.SharedMemoryName.IsEmpty())
 	{
-		SpatialData.InitWithCameraAsset(CameraAsset);
+		SourceMachineName = FText::Format(LOCTEXT("SCTLiveLinkSourceMachineName", "UDP port {0}"), FText::AsNumber(Settings.Port, &FNumberFormattingOptions::DefaultNoGrouping()));
 	}
+	else
+	{
+		SourceMachineName = FText::Format(LOCTEXT("SCTLiveLinkSourceSharedMemoryName", "Shared memory {0}"), FText::FromString(Settings.SharedMemoryName));
+	}
+
+	// Leave a core for the game thread and one for the receive thread
+	MaxWorkers = Settings.WorkerThreads > 0 ? Settings.WorkerThreads : FMath::Clamp(FPlatformMisc::NumberOfCores() - 2, 1, 16);
 
-	// Tick delegate
-	TickDelegate = FTickerDelegate::CreateRaw(this, &FSCTLiveLinkSource::Tick);
-	TickDelegateHandle = FTicker::GetCoreTicker().AddTicker(TickDelegate, 1.0f / 60.0f);
+	ReceiveBuffer.SetNumUninitialized(kh::LiveMaxPacketSize);
+
+	BeginFrameHandle = FCoreDelegates::OnBeginFrame.AddRaw(this, &FSCTLiveLinkSource::OnBeginFrame);
+
+	FScopeLock Lock(&ActiveSourcesLock);
+	ActiveSources.Add(this);
 }
 
 FSCTLiveLinkSource::~FSCTLiveLinkSource()
 {
-	FTicker::GetCoreTicker().RemoveTicker(TickDelegateHandle);
+	{
+		FScopeLock Lock(&ActiveSourcesLock);
+		ActiveSources.Remove(this);
+	}
+
+	FCoreDelegates::OnBeginFrame.Remove(BeginFrameHandle);
+
+	StopThreads();
+
+	if (Socket != nullptr)
+	{
+		Socket->Close();
+		SocketSubsystem->DestroySocket(Socket);
+		Socket = nullptr;
+	}
+
+	if (SharedMemoryRegion != nullptr)
+	{
+		FPlatformMemory::UnmapNamedSharedMemoryRegion(SharedMemoryRegion);
+		SharedMemoryRegion = nullptr;
+	}
 }
 
 void FSCTLiveLinkSource::ReceiveClient(ILiveLinkClient* InClient, FGuid InSourceGuid)
 {
-	UE_LOG(LogSCTLiveLinkSource, Display, TEXT("[MR LIVELINK] Received Client"));
+	UE_LOG(LogSCTLiveLinkSource, Display, TEXT("[SCT LIVELINK] Received Client"));
 
 	LiveLinkClient = InClient;
 	LiveLinkSourceGuid = InSourceGuid;
+
+	Start();
+}
+
+void FSCTLiveLinkSource::Start()
+{
+	SCT_LLM_SCOPE(LiveLink);
+
+	if (Settings.RecordDirectory.IsEmpty() == false)
+	{
+		Recorder = MakeUnique<kh::FLiveRecorder>(Settings.RecordDirectory);
+		if (Recorder->StartThread() == false)
+		{
+			Recorder.Reset();
+		}
+	}
+
+	if (Settings.SharedMemoryName.IsEmpty() == false)
+	{
+		if (StartSharedMemory())
+		{
+			Thread = FRunnableThread::Create(this, TEXT("SCTLiveLinkReceiver"), 128 * 1024, TPri_AboveNormal);
+		}
+		return;
+	}
+
+	SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+
+	const FIPv4Endpoint Endpoint(FIPv4Address::Any, Settings.Port);
+	Socket = FUdpSocketBuilder(TEXT("SCTLiveLinkSocket"))
+		.AsNonBlocking()
+		.AsReusable()
+		.BoundToEndpoint(Endpoint)
+		.WithReceiveBufferSize(kh::LiveMaxPacketSize * 16);
+
+	if (Socket == nullptr)
+	{
+		UE_LOG(LogSCTLiveLinkSource, Error, TEXT("[SCT LIVELINK] Could not open UDP socket on port %d"), Settings.Port);
+		return;
+	}
+
+	Sender = SocketSubsystem->CreateInternetAddr();
+
+	UE_LOG(LogSCTLiveLinkSource, Display, TEXT("[SCT LIVELINK] Listening on port %d with up to %d workers"), Settings.Port, MaxWorkers);
+	Thread = FRunnableThread::Create(this, TEXT("SCTLiveLinkReceiver"), 128 * 1024, TPri_AboveNormal);
+}
+
+bool FSCTLiveLinkSource::StartSharedMemory()
+{
+	// The source owns the ring and always initializes it, producers only attach and check the capacity
+	const SIZE_T MemorySize = kh::FSpscByteRing::GetMemorySize(FMath::Max(Settings.SharedMemorySize, 64 * 1024));
+	SharedMemoryRegion = FPlatformMemory::MapNamedSharedMemoryRegion(Settings.SharedMemoryName, true, FPlatformMemory::ESharedMemoryAccess::Read | FPlatformMemory::ESharedMemoryAccess::Write, MemorySize);
+	if (SharedMemoryRegion == nullptr)
+	{
+		UE_LOG(LogSCTLiveLinkSource, Error, TEXT("[SCT LIVELINK] Could not map shared memory %s"), *Settings.SharedMemoryName);
+		return false;
+	}
+
+	void* Memory = SharedMemoryRegion->GetAddress();
+	SharedMemoryRing = MakeUnique<kh::FSpscByteRing>();
+	if (SharedMemoryRing->Init(Memory, SharedMemoryRegion->GetSize(), true) == false)
+	{
+		UE_LOG(LogSCTLiveLinkSource, Error, TEXT("[SCT LIVELINK] Shared memory %s can't hold a ring"), *Settings.SharedMemoryName);
+		FPlatformMemory::UnmapNamedSharedMemoryRegion(SharedMemoryRegion);
+		SharedMemoryRegion = nullptr;
+		return false;
+	}
+
+	UE_LOG(LogSCTLiveLinkSource, Display, TEXT("[SCT LIVELINK] Reading from shared memory %s"), *Settings.SharedMemoryName);
+	return true;
+}
+
+void FSCTLiveLinkSource::StopThreads()
+{
+	// The receive thread feeds the workers, so it goes first
+	Stop();
+
+	if (Thread != nullptr)
+	{
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	FScopeLock Lock(&DevicesLock);
+	for (TUniquePtr<kh::FLiveDeviceWorker>& Worker : Workers)
+	{
+		Worker->StopThread();
+	}
+
+	// Nothing adds frames any more, write out what is queued and close the takes
+	if (Recorder.IsValid())
+	{
+		Recorder->StopThread();
+	}
 }
 
 bool FSCTLiveLinkSource::IsSourceStillValid() const
 {
-	return LiveLinkClient != nullptr;
+	return LiveLinkClient != nullptr && (Socket != nullptr || SharedMemoryRegion != nullptr);
 }
 
 bool FSCTLiveLinkSource::RequestSourceShutdown()
 {
+	StopThreads();
+
 	LiveLinkClient = nullptr;
 	LiveLinkSourceGuid.Invalidate();
 	return true;
@@ -94,130 +344,281 @@ FText FSCTLiveLinkSource::GetSourceMachineName() const
 
 FText FSCTLiveLinkSource::GetSourceStatus() const
 { 
-	return SourceStatus;
-}
+	if (Socket == nullptr && SharedMemoryRegion == nullptr)
+	{
+		return LOCTEXT("SourceStatus_NoSocket", "No Socket");
+	}
 
-void FSCTLiveLinkSource::PopulateBasePropertyNames(TArray<FName>& Names)
-{
-	Names.Empty();
-	//Names.Add(FName("SomeProperty"));
+	FScopeLock Lock(&DevicesLock);
+
+	FNumberFormattingOptions LatencyFormat;
+	LatencyFormat.MaximumFractionalDigits = 1;
+
+	TArray<FText> DeviceStatuses;
+	for (const TUniquePtr<kh::FLiveDevice>& Device : Devices)
+	{
+		const kh::FLiveDeviceStatus Status = Device->GetStatus();
+		if (Status.bIsReceiving)
+		{
+			FFormatOrderedArguments Args;
+			Args.Add(FText::FromString(Status.Name));
+			Args.Add(FText::AsNumber(Status.FramesReceived));
+			Args.Add(FText::AsNumber(Status.FramesLost));
+			Args.Add(FText::AsNumber(Status.PlayoutDelayMs));
+			Args.Add(FText::AsNumber(Status.LatencyP50Ms, &LatencyFormat));
+			Args.Add(FText::AsNumber(Status.LatencyP99Ms, &LatencyFormat));
+			DeviceStatuses.Add(FText::Format(LOCTEXT("SourceStatus_Device", "{0}: {1} frames, {2} lost, {3} ms buffer, {4}/{5} ms p50/p99 latency"), Args));
+		}
+	}
+
+	if (DeviceStatuses.Num() == 0)
+	{
+		return LOCTEXT("SourceStatus_Waiting", "Waiting for device");
+	}
+
+	int32 DroppedPackets = 0;
+	for (const TUniquePtr<kh::FLiveDeviceWorker>& Worker : Workers)
+	{
+		DroppedPackets += Worker->GetDroppedPackets();
+	}
+
+	if (DroppedPackets > 0)
+	{
+		DeviceStatuses.Add(FText::Format(LOCTEXT("SourceStatus_Dropped", "{0} packets dropped by busy workers"), FText::AsNumber(DroppedPackets)));
+	}
+
+	if (Recorder.IsValid())
+	{
+		const kh::FLiveRecorderStatus RecorderStatus = Recorder->GetStatus();
+		DeviceStatuses.Add(FText::Format(LOCTEXT("SourceStatus_Recording", "recording {0} takes, {1} frames written"), FText::AsNumber(RecorderStatus.OpenTakes), FText::AsNumber(RecorderStatus.FramesWritten)));
+	}
+
+	return FText::Join(LOCTEXT("SourceStatus_Separator", "; "), DeviceStatuses);
 }
 
-void FSCTLiveLinkSource::UpdateBaseStaticData(FLiveLinkBaseStaticData& InOutData)
+void FSCTLiveLinkSource::OnBeginFrame()
 {
-	PopulateBasePropertyNames(BasePropertyNames); //Populate BASE property names array
-	InOutData.PropertyNames = BasePropertyNames;
+	const double Now = FPlatformTime::Seconds();
+
+	FScopeLock Lock(&DevicesLock);
+	for (const TUniquePtr<kh::FLiveDevice>& Device : Devices)
+	{
+		Device->SampleEngineFrame(Now);
+	}
+
+#if STATS
+	if (FThreadStats::IsCollectingData() && Devices.Num() > 0)
+	{
+		kh::FLiveLatencyTelemetry AllDevices;
+		for (const TUniquePtr<kh::FLiveDevice>& Device : Devices)
+		{
+			AllDevices.Merge(Device->GetTelemetry());
+		}
+
+		const kh::FLatencySummary Total = AllDevices[kh::ELatencyStage::Total].Summarize();
+		SET_FLOAT_STAT(STAT_SCTLiveLink_TotalP50, Total.P50 * 1000.0);
+		SET_FLOAT_STAT(STAT_SCTLiveLink_TotalP95, Total.P95 * 1000.0);
+		SET_FLOAT_STAT(STAT_SCTLiveLink_TotalP99, Total.P99 * 1000.0);
+		SET_FLOAT_STAT(STAT_SCTLiveLink_NetworkP99, AllDevices[kh::ELatencyStage::Network].Summarize().P99 * 1000.0);
+		SET_FLOAT_STAT(STAT_SCTLiveLink_ParseP99, AllDevices[kh::ELatencyStage::Parse].Summarize().P99 * 1000.0);
+		SET_FLOAT_STAT(STAT_SCTLiveLink_BufferP99, AllDevices[kh::ELatencyStage::Buffer].Summarize().P99 * 1000.0);
+		SET_FLOAT_STAT(STAT_SCTLiveLink_EngineP99, AllDevices[kh::ELatencyStage::Engine].Summarize().P99 * 1000.0);
+	}
+#endif
 }
 
-void FSCTLiveLinkSource::UpdateSkeletonStaticData(FLiveLinkSkeletonStaticData& InOutData)
+FString FSCTLiveLinkSource::GetLatencyCsvRows() const
 {
-	const FSCTSkeletonDefinition& Def = SpatialData.GetSkeletonDefinition();
-	InOutData.SetBoneNames(Def.JointNames);
-	InOutData.SetBoneParents(Def.ParentIndices);
+	const FString SourceName = SourceMachineName.ToString();
+	FString Csv;
+
+	FScopeLock Lock(&DevicesLock);
+	kh::FLiveLatencyTelemetry AllDevices;
+	for (const TUniquePtr<kh::FLiveDevice>& Device : Devices)
+	{
+		AppendLatencyCsvRows(Csv, SourceName, Device->GetName(), Device->GetTelemetry());
+		AllDevices.Merge(Device->GetTelemetry());
+	}
+
+	if (Devices.Num() > 1)
+	{
+		AppendLatencyCsvRows(Csv, SourceName, TEXT("All"), AllDevices);
+	}
+
+	return Csv;
 }
 
-void FSCTLiveLinkSource::UpdateBaseFrameData(FLiveLinkBaseFrameData& InOutData, float DeltaTime)
+void FSCTLiveLinkSource::ResetLatency()
 {
-	InOutData.WorldTime = FPlatformTime::Seconds();
-	//InOutData.MetaData.SceneTime = FQualifiedFrameTime(1212, FFrameRate(60, 1));
-	InOutData.PropertyValues.Reserve(BasePropertyNames.Num());
-	//InOutData.PropertyValues.Add(334433.0f);
+	FScopeLock Lock(&DevicesLock);
+	for (const TUniquePtr<kh::FLiveDevice>& Device : Devices)
+	{
+		Device->ResetTelemetry();
+	}
 }
 
-void FSCTLiveLinkSource::UpdateTransformFrameData(FLiveLinkTransformFrameData& InOutData, float DeltaTime)
+bool FSCTLiveLinkSource::Init()
 {
-	UpdateBaseFrameData(InOutData, DeltaTime);
-	SpatialData.DeserialiseCamera();
-	InOutData.Transform = SpatialData.GetCameraTransform();
+	return true;
 }
 
-void FSCTLiveLinkSource::UpdateSkeletonFrameData(FLiveLinkAnimationFrameData& InOutData, float DeltaTime)
+uint32 FSCTLiveLinkSource::Run()
 {
-	UpdateBaseFrameData(InOutData, DeltaTime);
+	SCT_LLM_SCOPE(LiveLink);
 
-	SpatialData.DeserialiseSkeleton();
-	TArray<FTransform> BoneTransforms;
-	const FSCTSkeletonDefinition& SkeletonDefinition = SpatialData.GetSkeletonDefinition();
-	const kh::FSkeletonTransforms& SkeletonTransforms = SpatialData.GetSkeletonTransforms();
-
-	for (int i = 0, e = SkeletonTransforms.Transforms.Num(); i < e; ++i)
+	if (SharedMemoryRegion != nullptr)
 	{
-		int ParentIdx = SkeletonDefinition.ParentIndices[i];
-		check(ParentIdx >= -1 && ParentIdx < 21);
+		RunSharedMemory();
+		return 0;
+	}
 
-		FTransform Parent = ParentIdx == -1 ? FTransform::Identity : SkeletonTransforms.Transforms[ParentIdx];
-		FTransform Child = SkeletonTransforms.Transforms[i];
+	const FTimespan MaxWait = FTimespan::FromSeconds(0.1);
 
-		check(Child.IsValid());
-		check(Parent.IsValid());
+	while (bStopping == false)
+	{
+		Socket->Wait(ESocketWaitConditions::WaitForRead, MaxWait);
 
-		FName JointName = SkeletonDefinition.JointNames[i];
-		FTransform RelativeTransform = Child * Parent.Inverse();
+		uint32 PendingDataSize = 0;
+		while (bStopping == false && Socket->HasPendingData(PendingDataSize))
+		{
+			int32 BytesRead = 0;
+			if (Socket->RecvFrom(ReceiveBuffer.GetData(), ReceiveBuffer.Num(), BytesRead, *Sender) && BytesRead > 0)
+			{
+				RoutePacket(ReceiveBuffer.GetData(), BytesRead, FPlatformTime::Seconds());
+			}
+		}
+	}
 
-		BoneTransforms.Add(RelativeTransform);
+	return 0;
+}
 
-		//BoneTransforms.Add(*SkeletonTransforms.Transforms[i]);
-	}
-	InOutData.Transforms = BoneTransforms;
+void FSCTLiveLinkSource::Stop()
+{
+	bStopping = true;
 }
 
-bool FSCTLiveLinkSource::Tick(float DeltaTime)
+void FSCTLiveLinkSource::RunSharedMemory()
 {
-	// Publish any roles and their properties
-	if (bIsInitialized == false && LiveLinkClient)
-	{
-		UE_LOG(LogSCTLiveLinkSource, Display, TEXT("[SCT LIVELINK] Initializing subject"));
-		// This code touches UObjects so needs to be run only in the game thread
-		check(IsInGameThread());
+	const double MaxWaitSeconds = 0.1;
+	TArray<kh::FLiveDevice*> StreamDevices;
 
-		if (bIsBodyTracking)
+	while (bStopping == false)
+	{
+		// Each record is [Stream Id uint32][Packet], parsed straight out of the ring and released once handled
+		const double ArrivalTime = FPlatformTime::Seconds();
+		uint8* Record = nullptr;
+		uint32 RecordSize = 0;
+		while (bStopping == false && LiveLinkClient != nullptr && SharedMemoryRing->BeginRead(Record, RecordSize))
 		{
-			const FLiveLinkSubjectKey SubjectKey(LiveLinkSourceGuid, FName("Skeleton Transforms"));
-			FLiveLinkStaticDataStruct StaticDataStruct(FLiveLinkSkeletonStaticData::StaticStruct()); // Create SKELETON static struct
-			UpdateSkeletonStaticData(*StaticDataStruct.Cast<FLiveLinkSkeletonStaticData>()); // Populate the SKELETON bonen names and parents
-			LiveLinkClient->PushSubjectStaticData_AnyThread(SubjectKey, ULiveLinkAnimationRole::StaticClass(), MoveTemp(StaticDataStruct)); // Publish SKELETON role
+			if (RecordSize > sizeof(uint32))
+			{
+				uint32 StreamId = 0;
+				FMemory::Memcpy(&StreamId, Record, sizeof(StreamId));
+				uint8* Packet = Record + sizeof(uint32);
+
+				kh::FLiveDevice** Device = SharedMemoryStreams.Find(StreamId);
+				if (Device == nullptr && (kh::ELivePacketType)Packet[0] == kh::ELivePacketType::Header && SharedMemoryStreams.Num() < MaxDevices)
+				{
+					Device = &SharedMemoryStreams.Add(StreamId, CreateDevice(FString::Printf(TEXT("%s/%u"), *Settings.SharedMemoryName, StreamId)));
+					StreamDevices.Add(*Device);
+				}
+
+				if (Device != nullptr)
+				{
+					(*Device)->HandlePacket(Packet, RecordSize - sizeof(uint32), ArrivalTime);
+				}
+			}
+
+			SharedMemoryRing->EndRead();
 		}
 
+		const double Now = FPlatformTime::Seconds();
+		double NextDueTime = Now + MaxWaitSeconds;
+		for (kh::FLiveDevice* Device : StreamDevices)
 		{
-			const FLiveLinkSubjectKey SubjectKey(LiveLinkSourceGuid, FName("Camera Transform"));
-			FLiveLinkStaticDataStruct StaticDataStruct(FLiveLinkTransformStaticData::StaticStruct()); // Create TRANSFORM static struct
-			UpdateBaseStaticData(*StaticDataStruct.Cast<FLiveLinkTransformStaticData>()); // Populate the BASE Property names and save to struct
-			LiveLinkClient->PushSubjectStaticData_AnyThread(SubjectKey, ULiveLinkTransformRole::StaticClass(), MoveTemp(StaticDataStruct)); // Publish BASIC role
+			Device->PublishDueFrames(Now);
+			NextDueTime = FMath::Min(NextDueTime, Device->GetNextDueTime());
 		}
 
-		UE_LOG(LogSCTLiveLinkSource, Display, TEXT("[SCT LIVELINK] Pushed Subject"));
+		FPlatformProcess::SleepNoStats(FMath::Clamp((float)(NextDueTime - FPlatformTime::Seconds()), 0.0f, SharedMemoryPollSeconds));
+	}
+}
 
-		bIsInitialized = true;
+void FSCTLiveLinkSource::RoutePacket(const uint8* Data, int32 Size, double ArrivalTime)
+{
+	if (LiveLinkClient == nullptr)
+		return;
 
-		SourceStatus = LOCTEXT("SourceStatus_Active", "Active");
+	SCT_SCOPE_CYCLE_COUNTER(STAT_SCT_RoutePacket);
 
-		return true;
+	// Consecutive packets usually come from the same device
+	const FDeviceRoute* Route = nullptr;
+	if (Routes.IsValidIndex(LastRoute) && *Routes[LastRoute].Address == *Sender)
+	{
+		Route = &Routes[LastRoute];
+	}
+	else
+	{
+		LastRoute = Routes.IndexOfByPredicate([this](const FDeviceRoute& Candidate) { return *Candidate.Address == *Sender; });
+		if (LastRoute != INDEX_NONE)
+		{
+			Route = &Routes[LastRoute];
+		}
+		else if ((kh::ELivePacketType)Data[0] == kh::ELivePacketType::Header)
+		{
+			// Devices only get state once they announce themselves, stray frames are dropped here
+			Route = AddDevice();
+		}
 	}
 
-	UpdateLiveLink(DeltaTime);
-	return true;
+	if (Route != nullptr)
+	{
+		Route->Worker->Enqueue(Route->Device, Data, Size, ArrivalTime);
+	}
 }
 
-void FSCTLiveLinkSource::UpdateLiveLink(float DeltaTime)
+const FSCTLiveLinkSource::FDeviceRoute* FSCTLiveLinkSource::AddDevice()
 {
-	// Push SKELETON data to the link
-	if (bIsBodyTracking)
+	if (Routes.Num() >= MaxDevices)
 	{
-		const FLiveLinkSubjectKey SubjectKey(LiveLinkSourceGuid, FName("Skeleton Transforms"));
-		FLiveLinkFrameDataStruct FrameDataStruct(FLiveLinkAnimationFrameData::StaticStruct());
-		UpdateSkeletonFrameData(*FrameDataStruct.Cast<FLiveLinkAnimationFrameData>(), DeltaTime);
-		LiveLinkClient->PushSubjectFrameData_AnyThread(SubjectKey, MoveTemp(FrameDataStruct));
+		UE_LOG(LogSCTLiveLinkSource, Warning, TEXT("[SCT LIVELINK] Ignoring %s, already receiving from %d devices"), *Sender->ToString(true), MaxDevices);
+		return nullptr;
 	}
 
-	//Push TRANSFORM data to the link
+	const TSharedRef<FInternetAddr> Address = Sender->Clone();
+	UE_LOG(LogSCTLiveLinkSource, Display, TEXT("[SCT LIVELINK] New device %s"), *Address->ToString(true));
+
+	kh::FLiveDevice* Device = CreateDevice(Address->ToString(true));
+	Device->SetReplyAddress(Socket, Address);
+
+	// Devices are spread round robin, a worker thread is only started once there is a device for it
+	const int32 WorkerIndex = Routes.Num() % MaxWorkers;
+	kh::FLiveDeviceWorker* Worker = nullptr;
 	{
-		const FLiveLinkSubjectKey SubjectKey(LiveLinkSourceGuid, FName("Camera Transform"));
-		FLiveLinkFrameDataStruct FrameDataStruct(FLiveLinkTransformFrameData::StaticStruct());
-		UpdateTransformFrameData(*FrameDataStruct.Cast<FLiveLinkTransformFrameData>(), DeltaTime);
-		LiveLinkClient->PushSubjectFrameData_AnyThread(SubjectKey, MoveTemp(FrameDataStruct));
+		FScopeLock Lock(&DevicesLock);
+		if (WorkerIndex == Workers.Num())
+		{
+			Workers.Add(MakeUnique<kh::FLiveDeviceWorker>(WorkerIndex, WorkerRingCapacity));
+			Workers.Last()->StartThread();
+		}
+
+		Worker = Workers[WorkerIndex].Get();
 	}
 
-	SpatialData.StepFrame();
+	FDeviceRoute& Route = Routes.Add_GetRef(FDeviceRoute{ Address, Device, Worker });
+	LastRoute = Routes.Num() - 1;
+	return &Route;
+}
+
+kh::FLiveDevice* FSCTLiveLinkSource::CreateDevice(const FString& Address)
+{
+	TUniquePtr<kh::FLiveDevice> Device = MakeUnique<kh::FLiveDevice>(LiveLinkClient, LiveLinkSourceGuid, Address, Settings.Timing, Settings.Prediction);
+	kh::FLiveDevice* DevicePtr = Device.Get();
+	DevicePtr->SetRecorder(Recorder.Get());
+
+	FScopeLock Lock(&DevicesLock);
+	Devices.Add(MoveTemp(Device));
+	return DevicePtr;
 }
 
 #undef LOCTEXT_NAMESPACE
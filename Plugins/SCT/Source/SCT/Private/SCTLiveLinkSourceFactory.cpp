@@ -29,7 +29,7 @@ SOFTWARE.
 USCTLiveLinkSourceFactory::USCTLiveLinkSourceFactory()
 {
 	SourceDisplayName = LOCTEXT("SourceDisplayName", "SCT Live Link");
-	SourceToolTip = LOCTEXT("SourceToolTip", "SCT Live Link Tooltip");
+	SourceToolTip = LOCTEXT("SourceToolTip", "Receives SCT frames streamed from one or more devices over UDP");
 }
 
 FText USCTLiveLinkSourceFactory::GetSourceDisplayName() const
@@ -49,7 +49,8 @@ USCTLiveLinkSourceFactory::EMenuType USCTLiveLinkSourceFactory::GetMenuType() co
 
 TSharedPtr<ILiveLinkSource> USCTLiveLinkSourceFactory::CreateSource(const FString& ConnectionString) const
 {
-	TSharedPtr<FSCTLiveLinkSource> NewSource = MakeShared<FSCTLiveLinkSource>();
+	const FSCTLiveLinkSourceSettings Settings = FSCTLiveLinkSourceSettings::FromConnectionString(ConnectionString);
+	TSharedPtr<FSCTLiveLinkSource> NewSource = MakeShared<FSCTLiveLinkSource>(Settings);
 	return NewSource;
 }
 
@@ -0,0 +1,304 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTLiveRecorder.h"
+#include "SCTMemory.h"
+#include "SCTStats.h"
+
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSCTLiveRecorder, Log, All);
+
+namespace kh
+{
+	// How long the writer sleeps when idle, and how often takes are flushed and their frame count updated
+	static constexpr float WriterIdleSeconds = 0.005f;
+	static constexpr double FlushIntervalSeconds = 0.5;
+	// Offset of Frame Count in the capture header
+	static constexpr int32 HeaderFrameCountOffset = 4;
+
+	FLiveRecorder::FLiveRecorder(const FString& InDirectory)
+		: Directory(InDirectory)
+		, Thread(nullptr)
+		, bStopping(false)
+		, LastFlushTime(0.0)
+	{
+	}
+
+	FLiveRecorder::~FLiveRecorder()
+	{
+		StopThread();
+
+		while (FCommand* Command = FreeCommands.Pop())
+		{
+			delete Command;
+		}
+	}
+
+	bool FLiveRecorder::StartThread()
+	{
+		if (FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*Directory) == false)
+		{
+			UE_LOG(LogSCTLiveRecorder, Error, TEXT("[SCT LIVELINK] Could not create recording directory %s"), *Directory);
+			return false;
+		}
+
+		Thread = FRunnableThread::Create(this, TEXT("SCTLiveLinkRecorder"), 128 * 1024, TPri_BelowNormal);
+		if (Thread == nullptr)
+		{
+			UE_LOG(LogSCTLiveRecorder, Error, TEXT("[SCT LIVELINK] Could not create recorder thread"));
+			return false;
+		}
+
+		UE_LOG(LogSCTLiveRecorder, Display, TEXT("[SCT LIVELINK] Recording live streams to %s"), *Directory);
+		return true;
+	}
+
+	void FLiveRecorder::StopThread()
+	{
+		Stop();
+
+		if (Thread != nullptr)
+		{
+			Thread->WaitForCompletion();
+			delete Thread;
+			Thread = nullptr;
+		}
+
+		// Whatever was queued after the thread stopped, or everything if it never started
+		ProcessCommands();
+		for (TPair<uint32, FTake>& Pair : Takes)
+		{
+			CloseTake(Pair.Value);
+		}
+		Takes.Empty();
+	}
+
+	uint32 FLiveRecorder::BeginTake(const FString& DeviceName, const uint8* Header, int32 HeaderSize, int32 FrameSize)
+	{
+		FCommand* Command = AllocateCommand();
+		Command->Type = ECommandType::BeginTake;
+		Command->TakeId = (uint32)NextTakeId.Increment();
+		Command->FrameSize = FrameSize;
+		Command->DeviceName = DeviceName;
+		Command->Data.Append(Header, HeaderSize);
+		Enqueue(Command);
+		return Command->TakeId;
+	}
+
+	void FLiveRecorder::AddFrame(uint32 TakeId, double Timestamp, const TArray<uint8>& Frame)
+	{
+		FCommand* Command = AllocateCommand();
+		Command->Type = ECommandType::Frame;
+		Command->TakeId = TakeId;
+		Command->Timestamp = Timestamp;
+		Command->Data.Append(Frame);
+		QueuedFrames.Increment();
+		Enqueue(Command);
+	}
+
+	void FLiveRecorder::EndTake(uint32 TakeId)
+	{
+		FCommand* Command = AllocateCommand();
+		Command->Type = ECommandType::EndTake;
+		Command->TakeId = TakeId;
+		Enqueue(Command);
+	}
+
+	FLiveRecorderStatus FLiveRecorder::GetStatus() const
+	{
+		FLiveRecorderStatus Status;
+		Status.OpenTakes = OpenTakeCount.GetValue();
+		Status.QueuedFrames = QueuedFrames.GetValue();
+		Status.FramesWritten = FramesWritten.GetValue();
+		return Status;
+	}
+
+	FLiveRecorder::FCommand* FLiveRecorder::AllocateCommand()
+	{
+		FCommand* Command = FreeCommands.Pop();
+		if (Command == nullptr)
+		{
+			Command = new FCommand();
+		}
+		return Command;
+	}
+
+	void FLiveRecorder::Enqueue(FCommand* Command)
+	{
+		Commands.Push(Command);
+	}
+
+	uint32 FLiveRecorder::Run()
+	{
+		SCT_LLM_SCOPE(LiveLink);
+
+		while (bStopping == false)
+		{
+			ProcessCommands();
+
+			const double Now = FPlatformTime::Seconds();
+			if (Now - LastFlushTime >= FlushIntervalSeconds)
+			{
+				for (TPair<uint32, FTake>& Pair : Takes)
+				{
+					FlushTake(Pair.Value);
+				}
+				LastFlushTime = Now;
+			}
+
+			// Disk latency doesn't matter here, poll rather than have every frame wake the writer
+			FPlatformProcess::SleepNoStats(WriterIdleSeconds);
+		}
+
+		return 0;
+	}
+
+	void FLiveRecorder::Stop()
+	{
+		bStopping = true;
+	}
+
+	void FLiveRecorder::ProcessCommands()
+	{
+		while (FCommand* Command = Commands.Pop())
+		{
+			switch (Command->Type)
+			{
+			case ECommandType::BeginTake:
+				OpenTake(*Command);
+				break;
+			case ECommandType::Frame:
+				WriteFrame(*Command);
+				QueuedFrames.Decrement();
+				break;
+			case ECommandType::EndTake:
+				if (FTake* Take = Takes.Find(Command->TakeId))
+				{
+					CloseTake(*Take);
+					Takes.Remove(Command->TakeId);
+				}
+				break;
+			}
+
+			// Keep the allocations for the next frame
+			Command->DeviceName.Reset();
+			Command->Data.Reset();
+			FreeCommands.Push(Command);
+		}
+	}
+
+	void FLiveRecorder::OpenTake(const FCommand& Command)
+	{
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+		const FString BaseName = FPaths::MakeValidFileName(FString::Printf(TEXT("%s_%s"), *Command.DeviceName, *FDateTime::Now().ToString()));
+		FString BasePath = FPaths::Combine(Directory, BaseName);
+		for (int32 Suffix = 2; PlatformFile.FileExists(*(BasePath + TEXT(".dat"))); ++Suffix)
+		{
+			BasePath = FPaths::Combine(Directory, FString::Printf(TEXT("%s_%d"), *BaseName, Suffix));
+		}
+
+		FTake Take;
+		Take.Path = BasePath + TEXT(".dat");
+		Take.FrameSize = Command.FrameSize;
+		Take.DataFile = PlatformFile.OpenWrite(*Take.Path);
+		Take.IndexFile = PlatformFile.OpenWrite(*(BasePath + TEXT(".idx")));
+
+		if (Take.DataFile == nullptr || Take.IndexFile == nullptr || Command.Data.Num() < HeaderFrameCountOffset + (int32)sizeof(int32))
+		{
+			UE_LOG(LogSCTLiveRecorder, Error, TEXT("[SCT LIVELINK] Could not start recording %s"), *Take.Path);
+			delete Take.DataFile;
+			delete Take.IndexFile;
+			return;
+		}
+
+		// The frame count is patched as frames are written
+		TArray<uint8> Header = Command.Data;
+		FMemory::Memzero(Header.GetData() + HeaderFrameCountOffset, sizeof(int32));
+		Take.DataFile->Write(Header.GetData(), Header.Num());
+		Take.NextFrameOffset = Header.Num();
+
+		const int32 IndexHeader[4] = { (int32)RecordingIndexMagic, RecordingIndexVersion, Take.FrameSize, Header.Num() };
+		Take.IndexFile->Write((const uint8*)IndexHeader, sizeof(IndexHeader));
+
+		UE_LOG(LogSCTLiveRecorder, Display, TEXT("[SCT LIVELINK] Recording %s"), *Take.Path);
+		Takes.Add(Command.TakeId, Take);
+		OpenTakeCount.Increment();
+	}
+
+	void FLiveRecorder::WriteFrame(const FCommand& Command)
+	{
+		FTake* Take = Takes.Find(Command.TakeId);
+		if (Take == nullptr || Command.Data.Num() != Take->FrameSize)
+			return;
+
+		SCT_SCOPE_CYCLE_COUNTER(STAT_SCT_WriteRecordedFrame);
+
+		Take->DataFile->Write(Command.Data.GetData(), Command.Data.Num());
+
+		uint8 Entry[RecordingIndexEntrySize];
+		FMemory::Memcpy(Entry, &Take->NextFrameOffset, sizeof(int64));
+		FMemory::Memcpy(Entry + sizeof(int64), &Command.Timestamp, sizeof(double));
+		Take->IndexFile->Write(Entry, sizeof(Entry));
+
+		Take->NextFrameOffset += Take->FrameSize;
+		++Take->FrameCount;
+		Take->bIsDirty = true;
+		FramesWritten.Increment();
+	}
+
+	void FLiveRecorder::FlushTake(FTake& Take)
+	{
+		if (Take.bIsDirty == false)
+			return;
+
+		// Frames reach the disk before the index and the header count that refer to them
+		Take.DataFile->Flush();
+		Take.IndexFile->Flush();
+
+		Take.DataFile->Seek(HeaderFrameCountOffset);
+		Take.DataFile->Write((const uint8*)&Take.FrameCount, sizeof(Take.FrameCount));
+		Take.DataFile->Seek(Take.NextFrameOffset);
+		Take.DataFile->Flush();
+
+		Take.bIsDirty = false;
+	}
+
+	void FLiveRecorder::CloseTake(FTake& Take)
+	{
+		FlushTake(Take);
+
+		UE_LOG(LogSCTLiveRecorder, Display, TEXT("[SCT LIVELINK] Recorded %d frames to %s"), Take.FrameCount, *Take.Path);
+
+		delete Take.DataFile;
+		delete Take.IndexFile;
+		Take.DataFile = nullptr;
+		Take.IndexFile = nullptr;
+		OpenTakeCount.Decrement();
+	}
+}
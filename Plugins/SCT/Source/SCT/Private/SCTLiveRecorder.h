@@ -0,0 +1,146 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/LockFreeList.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/ThreadSafeCounter64.h"
+
+class FRunnableThread;
+class IFileHandle;
+
+namespace kh
+{
+	/** Index sidecar written next to each recording, see "Recordings" in Protocol.md */
+	static constexpr uint32 RecordingIndexMagic = 0x58544353; // SCTX
+	static constexpr int32 RecordingIndexVersion = 1;
+	static constexpr int32 RecordingIndexHeaderSize = 16;
+	static constexpr int32 RecordingIndexEntrySize = 16;
+
+	struct FLiveRecorderStatus
+	{
+		int32 OpenTakes = 0;
+		int32 QueuedFrames = 0;
+		int64 FramesWritten = 0;
+	};
+
+	/**
+	 * Writes live streams to disk as SCT capture files, one take per device stream, on a thread of its own.
+	 * Devices hand frames over through a lock free queue of pooled commands, so recording never blocks the
+	 * threads that receive and publish frames. Every take gets a .idx sidecar with the offset and timestamp of
+	 * each frame, and the frame count in the capture header is kept up to date as the take grows, so a
+	 * recording that is cut off can still be imported and seeked
+	 */
+	class FLiveRecorder : public FRunnable
+	{
+	public:
+		FLiveRecorder(const FString& InDirectory);
+		virtual ~FLiveRecorder();
+
+		bool StartThread();
+		/** Writes everything queued so far, closes all takes and stops the thread */
+		void StopThread();
+
+		// Any thread
+		/**
+		 * Starts a new take
+		 *
+		 * @param DeviceName used to name the file
+		 * @param Header the header, user anchors and skeleton definition in the recorded format
+		 * @param FrameSize the size of every frame in the take
+		 * @return id to add frames with
+		 */
+		uint32 BeginTake(const FString& DeviceName, const uint8* Header, int32 HeaderSize, int32 FrameSize);
+		/** Queues a frame in the recorded format, takes are written in the order frames are added */
+		void AddFrame(uint32 TakeId, double Timestamp, const TArray<uint8>& Frame);
+		void EndTake(uint32 TakeId);
+
+		FLiveRecorderStatus GetStatus() const;
+
+		// Begin FRunnable Interface
+		virtual uint32 Run() override;
+		virtual void Stop() override;
+		// End FRunnable Interface
+
+	private:
+		enum class ECommandType : uint8
+		{
+			BeginTake,
+			Frame,
+			EndTake
+		};
+
+		struct FCommand
+		{
+			ECommandType Type;
+			uint32 TakeId;
+			double Timestamp;
+			int32 FrameSize;
+			FString DeviceName;
+			// Header for BeginTake, the frame otherwise
+			TArray<uint8> Data;
+		};
+
+		struct FTake
+		{
+			FString Path;
+			IFileHandle* DataFile = nullptr;
+			IFileHandle* IndexFile = nullptr;
+			int32 FrameSize = 0;
+			int32 FrameCount = 0;
+			int64 NextFrameOffset = 0;
+			bool bIsDirty = false;
+		};
+
+		FCommand* AllocateCommand();
+		void Enqueue(FCommand* Command);
+
+		// Writer thread only
+		void ProcessCommands();
+		void OpenTake(const FCommand& Command);
+		void WriteFrame(const FCommand& Command);
+		void FlushTake(FTake& Take);
+		void CloseTake(FTake& Take);
+
+		FString Directory;
+		FRunnableThread* Thread;
+		FThreadSafeBool bStopping;
+
+		TLockFreePointerListFIFO<FCommand, PLATFORM_CACHE_LINE_SIZE> Commands;
+		// Commands are recycled once written, so recording doesn't allocate once the pool is warm
+		TLockFreePointerListUnordered<FCommand, PLATFORM_CACHE_LINE_SIZE> FreeCommands;
+
+		FThreadSafeCounter NextTakeId;
+		FThreadSafeCounter QueuedFrames;
+		FThreadSafeCounter OpenTakeCount;
+		FThreadSafeCounter64 FramesWritten;
+
+		// Writer thread only
+		TMap<uint32, FTake> Takes;
+		double LastFlushTime;
+	};
+}
@@ -0,0 +1,232 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTLiveTiming.h"
+
+namespace kh
+{
+	// Fastest transit is tracked over this many seconds of device time
+	static constexpr double ClockWindowSeconds = 2.0;
+	// Fraction of an offset increase applied per sample
+	static constexpr double ClockOffsetSlew = 0.02;
+	// A jump of the device clock larger than this restarts the estimate
+	static constexpr double ClockResetThreshold = 1.0;
+	// Samples arriving this much later than the fastest transit don't contribute to the jitter estimate
+	static constexpr double ClockOutlierThreshold = 0.5;
+	static constexpr double JitterPeakHalfLife = 2.0;
+
+	FDeviceClockEstimator::FDeviceClockEstimator()
+	{
+		Reset();
+	}
+
+	void FDeviceClockEstimator::Reset()
+	{
+		MinWindow.Reset();
+		MinWindowHead = 0;
+		bIsValid = false;
+		Offset = 0.0;
+		LastDeviceTime = 0.0;
+		Jitter = 0.0;
+		JitterPeak = 0.0;
+	}
+
+	bool FDeviceClockEstimator::AddSample(double DeviceTime, double ArrivalTime)
+	{
+		const double Delay = ArrivalTime - DeviceTime;
+
+		if (bIsValid && (DeviceTime < LastDeviceTime - ClockResetThreshold || Delay < Offset - ClockResetThreshold))
+		{
+			Reset();
+		}
+
+		if (bIsValid == false)
+		{
+			bIsValid = true;
+			Offset = Delay;
+			LastDeviceTime = DeviceTime;
+			MinWindow.Add({ DeviceTime, Delay });
+			return true;
+		}
+
+		// Sliding window minimum, kept as a queue of ascending delays
+		while (MinWindow.Num() > MinWindowHead && MinWindow.Last().Delay >= Delay)
+		{
+			MinWindow.Pop(false);
+		}
+		MinWindow.Add({ DeviceTime, Delay });
+
+		while (MinWindow[MinWindowHead].DeviceTime < DeviceTime - ClockWindowSeconds)
+		{
+			++MinWindowHead;
+		}
+
+		if (MinWindowHead > 64)
+		{
+			MinWindow.RemoveAt(0, MinWindowHead, false);
+			MinWindowHead = 0;
+		}
+
+		const double WindowMin = MinWindow[MinWindowHead].Delay;
+		if (WindowMin < Offset)
+		{
+			Offset = WindowMin;
+		}
+		else
+		{
+			Offset += (WindowMin - Offset) * ClockOffsetSlew;
+		}
+
+		const double Elapsed = FMath::Max(0.0, DeviceTime - LastDeviceTime);
+		LastDeviceTime = FMath::Max(LastDeviceTime, DeviceTime);
+		JitterPeak *= FMath::Pow(0.5, Elapsed / JitterPeakHalfLife);
+
+		const double Deviation = FMath::Max(0.0, Delay - Offset);
+		if (Deviation > ClockOutlierThreshold)
+			return false;
+
+		Jitter += (Deviation - Jitter) / 16.0;
+		JitterPeak = FMath::Max(JitterPeak, Deviation);
+		return true;
+	}
+
+	FLiveJitterBuffer::FLiveJitterBuffer(int32 InCapacity)
+	{
+		Slots.SetNum(InCapacity);
+		Free.Reserve(InCapacity);
+		Pending.Reserve(InCapacity);
+		Reset();
+	}
+
+	void FLiveJitterBuffer::SetJointCount(int32 JointCount)
+	{
+		for (FLiveFrame& Slot : Slots)
+		{
+			Slot.Joints.SetNum(JointCount);
+		}
+	}
+
+	void FLiveJitterBuffer::Reset()
+	{
+		Clock.Reset();
+		Pending.Reset();
+		Free.Reset();
+		for (FLiveFrame& Slot : Slots)
+		{
+			Free.Add(&Slot);
+		}
+
+		PlayoutDelay = Settings.MinDelay;
+		LastPlayedDeviceTime = -MAX_dbl;
+	}
+
+	FLiveFrame* FLiveJitterBuffer::Acquire()
+	{
+		if (Free.Num() == 0)
+		{
+			// Full, drop the oldest pending frame. Nothing older than it may be played anymore
+			FLiveFrame* Oldest = Pending[0];
+			Pending.RemoveAt(0, 1, false);
+			LastPlayedDeviceTime = FMath::Max(LastPlayedDeviceTime, Oldest->DeviceTime);
+			return Oldest;
+		}
+
+		return Free.Pop(false);
+	}
+
+	void FLiveJitterBuffer::Release(FLiveFrame* Frame)
+	{
+		Free.Add(Frame);
+	}
+
+	bool FLiveJitterBuffer::Insert(FLiveFrame* Frame, double ArrivalTime)
+	{
+		// The device restarted its clock
+		if (Frame->DeviceTime < LastPlayedDeviceTime - ClockResetThreshold)
+		{
+			for (FLiveFrame* PendingFrame : Pending)
+			{
+				Free.Add(PendingFrame);
+			}
+			Pending.Reset();
+			Clock.Reset();
+			LastPlayedDeviceTime = -MAX_dbl;
+		}
+
+		Clock.AddSample(Frame->DeviceTime, ArrivalTime);
+
+		if (Frame->DeviceTime <= LastPlayedDeviceTime)
+		{
+			Release(Frame);
+			return false;
+		}
+
+		if (Settings.bUseJitterBuffer)
+		{
+			const double TargetDelay = FMath::Clamp(FMath::Max(Clock.GetJitter() * Settings.JitterMultiplier, Clock.GetJitterPeak()), Settings.MinDelay, Settings.MaxDelay);
+			PlayoutDelay += (TargetDelay - PlayoutDelay) * (TargetDelay > PlayoutDelay ? 0.5 : 0.01);
+			Frame->PlayoutTime = Clock.ToEngineTime(Frame->DeviceTime) + PlayoutDelay;
+		}
+		else
+		{
+			Frame->PlayoutTime = Clock.ToEngineTime(Frame->DeviceTime);
+		}
+
+		// Late or reordered frames land in the middle, keep pending sorted by device time
+		int32 InsertIdx = Pending.Num();
+		while (InsertIdx > 0 && Pending[InsertIdx - 1]->DeviceTime >= Frame->DeviceTime)
+		{
+			if (Pending[InsertIdx - 1]->DeviceTime == Frame->DeviceTime)
+			{
+				Release(Frame);
+				return false;
+			}
+			--InsertIdx;
+		}
+		Pending.Insert(Frame, InsertIdx);
+
+		return true;
+	}
+
+	FLiveFrame* FLiveJitterBuffer::PopDue(double Now)
+	{
+		if (Pending.Num() == 0)
+			return nullptr;
+
+		FLiveFrame* Frame = Pending[0];
+		if (Settings.bUseJitterBuffer && Frame->PlayoutTime > Now)
+			return nullptr;
+
+		Pending.RemoveAt(0, 1, false);
+		LastPlayedDeviceTime = Frame->DeviceTime;
+		return Frame;
+	}
+
+	double FLiveJitterBuffer::GetNextDueTime() const
+	{
+		if (Pending.Num() == 0)
+			return MAX_dbl;
+
+		return Settings.bUseJitterBuffer ? Pending[0]->PlayoutTime : 0.0;
+	}
+}
@@ -0,0 +1,141 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SCTLiveSettings.h"
+#include "SpatialDataDeserializer.h"
+
+namespace kh
+{
+	/**
+	 * Maps device timestamps into engine time (FPlatformTime::Seconds).
+	 * The offset follows the fastest transit seen over a sliding window, which is robust against late packets and
+	 * follows slow drift between the clocks. Increases are slewed so mapped times stay smooth, decreases are taken at once.
+	 * The spread of transit times above that baseline is the jitter
+	 */
+	class FDeviceClockEstimator
+	{
+	public:
+		FDeviceClockEstimator();
+
+		void Reset();
+
+		/**
+		 * Adds an observation of a frame captured at DeviceTime arriving at ArrivalTime
+		 *
+		 * @return false if the sample was rejected as an outlier
+		 */
+		bool AddSample(double DeviceTime, double ArrivalTime);
+
+		bool IsValid() const { return bIsValid; }
+		double ToEngineTime(double DeviceTime) const { return DeviceTime + Offset; }
+
+		/** Smoothed transit time above the fastest transit, in seconds */
+		double GetJitter() const { return Jitter; }
+		/** Decaying peak of the transit time above the fastest transit, in seconds */
+		double GetJitterPeak() const { return JitterPeak; }
+
+	private:
+		struct FSample
+		{
+			double DeviceTime;
+			double Delay;
+		};
+
+		// Ascending delays over the window, front is the window minimum
+		TArray<FSample> MinWindow;
+		int32 MinWindowHead;
+
+		bool bIsValid;
+		double Offset;
+		double LastDeviceTime;
+		double Jitter;
+		double JitterPeak;
+	};
+
+	struct FLiveFrame
+	{
+		double DeviceTime;
+		double PlayoutTime;
+		// Engine times the frame was received and parsed, for latency telemetry
+		double ArrivalTime;
+		double ParsedTime;
+		bool bHasSkeleton;
+		FTransform CameraTransform;
+		FCameraFrameMetaData CameraMetaData;
+		// Model space joints, sized when the skeleton definition arrives
+		TArray<FTransform> Joints;
+		// The frame in the recorded file format, only filled while the stream is recorded
+		TArray<uint8> Recorded;
+	};
+
+	/**
+	 * Holds live frames until their playout time. The playout delay follows the observed jitter, growing quickly
+	 * when the network gets worse and shrinking slowly once it calms down. Frame slots are pooled so buffering
+	 * does not allocate once the joint arrays are sized
+	 */
+	class FLiveJitterBuffer
+	{
+	public:
+		FLiveJitterBuffer(int32 InCapacity = 64);
+
+		void SetSettings(const FLiveTimingSettings& InSettings) { Settings = InSettings; }
+		void SetJointCount(int32 JointCount);
+		void Reset();
+
+		/** Returns a free slot to decode into. Drops the oldest pending frame if the buffer is full */
+		FLiveFrame* Acquire();
+		/** Returns a popped slot, or one that was never inserted, to the pool */
+		void Release(FLiveFrame* Frame);
+
+		/**
+		 * Schedules a decoded frame and updates the clock estimate
+		 *
+		 * @return false if the frame was too old to be played and has been released
+		 */
+		bool Insert(FLiveFrame* Frame, double ArrivalTime);
+
+		/** Pops the next frame whose playout time has passed, nullptr if none are due */
+		FLiveFrame* PopDue(double Now);
+		/** Engine time the next pending frame is due, MAX_dbl if the buffer is empty */
+		double GetNextDueTime() const;
+
+		double GetPlayoutDelay() const { return PlayoutDelay; }
+		const FDeviceClockEstimator& GetClock() const { return Clock; }
+		int32 GetNumPending() const { return Pending.Num(); }
+
+	private:
+		FLiveTimingSettings Settings;
+		FDeviceClockEstimator Clock;
+
+		TArray<FLiveFrame> Slots;
+		TArray<FLiveFrame*> Free;
+		// Sorted by device time
+		TArray<FLiveFrame*> Pending;
+
+		double PlayoutDelay;
+		double LastPlayedDeviceTime;
+	};
+}
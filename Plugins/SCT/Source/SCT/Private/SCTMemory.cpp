@@ -0,0 +1,116 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTMemory.h"
+#include "SCTReplayCameraPawn.h"
+#include "SCTReplayGeometryActor.h"
+#include "SCTReplaySkeletonPawn.h"
+#include "SCTSpatialSkeletonAsset.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Misc/OutputDevice.h"
+#include "UObject/UObjectIterator.h"
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+DECLARE_LLM_MEMORY_STAT(TEXT("SCT"), STAT_SCTSummaryLLM, STATGROUP_LLM);
+DECLARE_LLM_MEMORY_STAT(TEXT("SCT Captures"), STAT_SCTCapturesLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("SCT Decoded Tracks"), STAT_SCTDecodedTracksLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("SCT Geometry Buffers"), STAT_SCTGeometryBuffersLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("SCT Procedural Mesh"), STAT_SCTProceduralMeshLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("SCT LiveLink"), STAT_SCTLiveLinkLLM, STATGROUP_LLMFULL);
+#endif
+
+namespace kh
+{
+	void RegisterLLMTags()
+	{
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+		FLowLevelMemTracker& Tracker = FLowLevelMemTracker::Get();
+		const FName SummaryStat = GET_STATFNAME(STAT_SCTSummaryLLM);
+		Tracker.RegisterProjectTag((int32)ESCTLLMTag::Captures, TEXT("SCTCaptures"), GET_STATFNAME(STAT_SCTCapturesLLM), SummaryStat);
+		Tracker.RegisterProjectTag((int32)ESCTLLMTag::DecodedTracks, TEXT("SCTDecodedTracks"), GET_STATFNAME(STAT_SCTDecodedTracksLLM), SummaryStat);
+		Tracker.RegisterProjectTag((int32)ESCTLLMTag::GeometryBuffers, TEXT("SCTGeometryBuffers"), GET_STATFNAME(STAT_SCTGeometryBuffersLLM), SummaryStat);
+		Tracker.RegisterProjectTag((int32)ESCTLLMTag::ProceduralMesh, TEXT("SCTProceduralMesh"), GET_STATFNAME(STAT_SCTProceduralMeshLLM), SummaryStat);
+		Tracker.RegisterProjectTag((int32)ESCTLLMTag::LiveLink, TEXT("SCTLiveLink"), GET_STATFNAME(STAT_SCTLiveLinkLLM), SummaryStat);
+#endif
+	}
+
+	static FString FormatBytes(SIZE_T Bytes)
+	{
+		return FString::Printf(TEXT("%.2f MB"), Bytes / (1024.0 * 1024.0));
+	}
+
+	template<typename ActorType>
+	static SIZE_T ReportActors(FOutputDevice& Ar, const TCHAR* TypeName)
+	{
+		SIZE_T Total = 0;
+		for (TObjectIterator<ActorType> It; It; ++It)
+		{
+			if (It->IsTemplate())
+				continue;
+
+			const SIZE_T Bytes = It->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+			Ar.Logf(TEXT("  %-24s %-48s %12s"), TypeName, *It->GetPathName(), *FormatBytes(Bytes));
+			Total += Bytes;
+		}
+		return Total;
+	}
+
+	static void WriteMemoryReport(FOutputDevice& Ar)
+	{
+		Ar.Logf(TEXT("[SCT] Loaded captures"));
+		Ar.Logf(TEXT("  %-64s %8s %12s %12s"), TEXT("Capture"), TEXT("Frames"), TEXT("Raw"), TEXT("Decoded"));
+
+		SIZE_T TotalRaw = 0;
+		SIZE_T TotalDecoded = 0;
+		for (TObjectIterator<USCTSpatialCameraAsset> It; It; ++It)
+		{
+			if (It->IsTemplate())
+				continue;
+
+			// Decoded is what the track takes as transforms, one per joint plus the camera for every frame
+			const USCTSpatialSkeletonAsset* SkeletonAsset = Cast<USCTSpatialSkeletonAsset>(*It);
+			const int32 TransformsPerFrame = 1 + (SkeletonAsset ? SkeletonAsset->SkeletonDefinition.JointNames.Num() : 0);
+			// Just the recorded frames, the resource size also counts the pre-decoded capture
+			const SIZE_T Raw = It->FrameData.GetAllocatedSize();
+			const SIZE_T Decoded = (SIZE_T)FMath::Max(It->FrameCount, 0) * TransformsPerFrame * sizeof(FTransform);
+
+			Ar.Logf(TEXT("  %-64s %8d %12s %12s"), *It->GetPathName(), It->FrameCount, *FormatBytes(Raw), *FormatBytes(Decoded));
+			TotalRaw += Raw;
+			TotalDecoded += Decoded;
+		}
+		Ar.Logf(TEXT("  %-64s %8s %12s %12s"), TEXT("Total"), TEXT(""), *FormatBytes(TotalRaw), *FormatBytes(TotalDecoded));
+
+		Ar.Logf(TEXT("[SCT] Replay actor working sets"));
+		SIZE_T TotalActors = 0;
+		TotalActors += ReportActors<ASCTReplayCameraPawn>(Ar, TEXT("Camera pawn"));
+		TotalActors += ReportActors<ASCTReplaySkeletonPawn>(Ar, TEXT("Skeleton pawn"));
+		TotalActors += ReportActors<ASCTReplayGeometryActor>(Ar, TEXT("Geometry actor"));
+		Ar.Logf(TEXT("  %-24s %-48s %12s"), TEXT("Total"), TEXT(""), *FormatBytes(TotalActors));
+	}
+
+	static FAutoConsoleCommandWithOutputDevice MemReportCommand(
+		TEXT("SCT.MemReport"),
+		TEXT("Lists every loaded SCT capture with its raw and decoded size, and the working set of every replay actor"),
+		FConsoleCommandWithOutputDeviceDelegate::CreateStatic(&WriteMemoryReport));
+}
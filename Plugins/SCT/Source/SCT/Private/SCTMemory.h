@@ -0,0 +1,55 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+namespace kh
+{
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+	/**
+	 * Low level memory tracker tags for SCT allocations, see "stat LLMFULL" or run with -LLM.
+	 * Taken from the end of the project tag range, where the game's own tags are least likely to be
+	 */
+	enum class ESCTLLMTag : LLM_TAG_TYPE
+	{
+		Captures = (LLM_TAG_TYPE)ELLMTag::ProjectTagEnd - 4,
+		DecodedTracks,
+		GeometryBuffers,
+		ProceduralMesh,
+		LiveLink,
+	};
+	static_assert((int32)ESCTLLMTag::LiveLink <= (int32)ELLMTag::ProjectTagEnd, "SCT LLM tags must be project tags");
+#endif
+
+	/** Registers the tag names and stats, called once at module startup */
+	void RegisterLLMTags();
+}
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+#define SCT_LLM_SCOPE(Tag) LLM_SCOPE((ELLMTag)kh::ESCTLLMTag::Tag)
+#else
+#define SCT_LLM_SCOPE(Tag)
+#endif
@@ -0,0 +1,519 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTPlaybackBenchmarkCommandlet.h"
+#include "SCTCaptureWriter.h"
+#include "SCTProtocol.h"
+#include "SCTReplayCameraPawn.h"
+#include "SCTReplayGeometryActor.h"
+#include "SCTReplaySkeletonPawn.h"
+#include "SCTSerializeFromBuffer.h"
+#include "SCTSpatialSkeletonAsset.h"
+#include "SCTStats.h"
+#include "SCTSyntheticCapture.h"
+
+#include "Components/LineBatchComponent.h"
+#include "Dom/JsonObject.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "HAL/FileManager.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/App.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "UObject/Package.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSCTPlaybackBenchmark, Log, All);
+
+static constexpr int32 BenchmarkFileVersion = 1;
+
+struct FPlaybackBenchmarkSettings
+{
+	int32 Cameras = 8;
+	int32 Skeletons = 8;
+	int32 Geometry = 1;
+	float Duration = 60.0f;
+	float FrameRate = 60.0f;
+	int32 Warmup = 60;
+	int32 CaptureFrames = 3600;
+	kh::FSyntheticCaptureSettings Capture;
+
+	/** Results are only comparable between runs with the same arguments */
+	FString ToString() const
+	{
+		return FString::Printf(TEXT("Cameras=%d Skeletons=%d Geometry=%d Duration=%.1f FrameRate=%.1f Warmup=%d CaptureFrames=%d Joints=%d MeshParts=%d MeshVertices=%d MeshInterval=%d Seed=%d"),
+			Cameras, Skeletons, Geometry, Duration, FrameRate, Warmup, CaptureFrames, Capture.Joints, Capture.MeshParts, Capture.MeshVertices, Capture.MeshInterval, Capture.Seed);
+	}
+};
+
+struct FPlaybackBenchmarkResult
+{
+	int32 Frames = 0;
+	double SimulatedSeconds = 0.0;
+	double GameThreadSeconds = 0.0;
+	double MeanFrameMs = 0.0;
+	double P50FrameMs = 0.0;
+	double P95FrameMs = 0.0;
+	double P99FrameMs = 0.0;
+	double MaxFrameMs = 0.0;
+	int64 FramesDecoded = 0;
+	int64 MeshUpdates = 0;
+	double MeanAllocationsPerFrame = 0.0;
+	int64 MaxAllocationsPerFrame = 0;
+	double SetupMemoryMB = 0.0;
+	double PeakRunMemoryMB = 0.0;
+	double PeakProcessMemoryMB = 0.0;
+
+	double GetFramesDecodedPerSecond() const { return GameThreadSeconds > 0.0 ? FramesDecoded / GameThreadSeconds : 0.0; }
+};
+
+/**
+ * Counts allocations made through GMalloc while installed in front of it. Every call is forwarded, so blocks can be
+ * freed after it is removed again
+ */
+class FCountingMalloc final : public FMalloc
+{
+public:
+	explicit FCountingMalloc(FMalloc* InInner) : Inner(InInner), Allocations(0) {}
+
+	virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+	{
+		FPlatformAtomics::InterlockedIncrement(&Allocations);
+		return Inner->Malloc(Count, Alignment);
+	}
+
+	virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+	{
+		if (Original == nullptr)
+		{
+			FPlatformAtomics::InterlockedIncrement(&Allocations);
+		}
+		return Inner->Realloc(Original, Count, Alignment);
+	}
+
+	virtual void Free(void* Original) override { Inner->Free(Original); }
+	virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+	virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+	virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+	virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+	virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+
+	FMalloc* GetInner() const { return Inner; }
+	int64 GetAllocations() const { return FPlatformAtomics::AtomicRead(&Allocations); }
+
+private:
+	FMalloc* Inner;
+	volatile int64 Allocations;
+};
+
+static double GetUsedMB()
+{
+	return FPlatformMemory::GetStats().UsedPhysical / (1024.0 * 1024.0);
+}
+
+static double GetPercentile(TArray<double>& Values, double Percentile)
+{
+	if (Values.Num() == 0)
+		return 0.0;
+
+	Values.Sort();
+	return Values[FMath::Min(FMath::FloorToInt(Values.Num() * Percentile), Values.Num() - 1)];
+}
+
+/** Fills a transient asset from a capture, the same way the editor importer does */
+static USCTSpatialCameraAsset* CreateTransientAsset(TArray<uint8>& Capture)
+{
+	FMRSerializeFromBuffer FromBuffer;
+	FromBuffer.Init(Capture.GetData(), Capture.Num());
+
+	kh::FSpatialHeader Header;
+	kh::ReadHeaderFromBuffer(FromBuffer, Header);
+
+	const bool bSkeleton = Header.CaptureType == (int32)kh::ECaptureType::Skeleton;
+	USCTSpatialCameraAsset* Asset = bSkeleton ? NewObject<USCTSpatialSkeletonAsset>(GetTransientPackage()) : NewObject<USCTSpatialCameraAsset>(GetTransientPackage());
+	Asset->Version = Header.Version;
+	Asset->FrameCount = Header.FrameCount;
+	Asset->DeviceOrientation = Header.DeviceOrientation;
+	Asset->HorizontalFOV = Header.HorizontalFOV;
+	Asset->VerticalFOV = Header.VerticalFOV;
+	Asset->FocalLengthX = Header.FocalLengthX;
+	Asset->FocalLengthY = Header.FocalLengthY;
+	Asset->CaptureType = Header.CaptureType;
+
+	kh::ReadUserAnchorsFromBuffer(FromBuffer, Asset->UserAnchors);
+	if (bSkeleton)
+	{
+		kh::ReadSkeletonDefinitionFromBuffer(FromBuffer, CastChecked<USCTSpatialSkeletonAsset>(Asset)->SkeletonDefinition);
+	}
+	FromBuffer >> Asset->FrameData;
+
+	return Asset;
+}
+
+static USCTSpatialCameraAsset* CreateSyntheticAsset(const kh::FSyntheticCaptureSettings& Settings, bool bSkeleton)
+{
+	TArray<uint8> Capture;
+	kh::FCaptureWriter Writer(Capture);
+	kh::WriteSyntheticCapture(Writer, Settings, bSkeleton, [](int32) { return true; });
+	return CreateTransientAsset(Capture);
+}
+
+static bool WriteSyntheticGeometryFile(const kh::FSyntheticCaptureSettings& Settings, const FString& Path)
+{
+	TArray<uint8> Stream;
+	kh::FCaptureWriter Writer(Stream);
+	kh::WriteSyntheticGeometry(Writer, Settings, [](int32) { return true; });
+	return FFileHelper::SaveArrayToFile(Stream, *Path);
+}
+
+template<typename ActorType, typename SetupType>
+static ActorType* SpawnStarted(UWorld* World, const FVector& Location, SetupType&& Setup)
+{
+	const FTransform Transform(Location);
+	ActorType* Actor = World->SpawnActorDeferred<ActorType>(ActorType::StaticClass(), Transform);
+	Setup(Actor);
+	Actor->FinishSpawning(Transform);
+	Actor->Start();
+	return Actor;
+}
+
+static bool RunPlayback(const FPlaybackBenchmarkSettings& Settings, FPlaybackBenchmarkResult& OutResult)
+{
+	const double MemoryBefore = GetUsedMB();
+
+	// Every actor plays its own capture, so nothing is shared in the caches that wouldn't be on a render node
+	TArray<USCTSpatialCameraAsset*> CameraAssets;
+	TArray<USCTSpatialCameraAsset*> SkeletonAssets;
+	for (int32 i = 0; i < Settings.Cameras + Settings.Skeletons; ++i)
+	{
+		kh::FSyntheticCaptureSettings Capture = Settings.Capture;
+		Capture.Frames = Settings.CaptureFrames;
+		Capture.Seed = Settings.Capture.Seed + i;
+		const bool bSkeleton = i >= Settings.Cameras;
+		(bSkeleton ? SkeletonAssets : CameraAssets).Add(CreateSyntheticAsset(Capture, bSkeleton));
+	}
+
+	TArray<FString> GeometryFiles;
+	for (int32 i = 0; i < Settings.Geometry; ++i)
+	{
+		// Enough updates to last the run, the actor advances once per tick and stops at the end of the stream
+		kh::FSyntheticCaptureSettings Capture = Settings.Capture;
+		Capture.Frames = FMath::CeilToInt((Settings.Duration * Settings.FrameRate + Settings.Warmup) / Capture.MeshInterval) + 1;
+		Capture.Seed = Settings.Capture.Seed + i;
+
+		const FString Path = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectIntermediateDir(), TEXT("SCT"), FString::Printf(TEXT("PlaybackBenchmark-Geometry%d.dat"), i)));
+		if (WriteSyntheticGeometryFile(Capture, Path) == false)
+		{
+			UE_LOG(LogSCTPlaybackBenchmark, Error, TEXT("Could not write %s"), *Path);
+			return false;
+		}
+		GeometryFiles.Add(Path);
+	}
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("SCTPlaybackBenchmark"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+	// No game mode, so begin play directly. Everything spawned from here on begins play as it is spawned
+	World->GetWorldSettings()->NotifyBeginPlay();
+
+	for (int32 i = 0; i < CameraAssets.Num(); ++i)
+	{
+		SpawnStarted<ASCTReplayCameraPawn>(World, FVector(i * 200.0f, 0.0f, 0.0f), [&](ASCTReplayCameraPawn* Pawn)
+		{
+			Pawn->CameraDataAsset = CameraAssets[i];
+			Pawn->bLoop = true;
+		});
+	}
+	for (int32 i = 0; i < SkeletonAssets.Num(); ++i)
+	{
+		SpawnStarted<ASCTReplaySkeletonPawn>(World, FVector(i * 200.0f, 500.0f, 0.0f), [&](ASCTReplaySkeletonPawn* Pawn)
+		{
+			Pawn->SkeletonDataAsset = CastChecked<USCTSpatialSkeletonAsset>(SkeletonAssets[i]);
+			Pawn->bLoop = true;
+		});
+	}
+	for (int32 i = 0; i < GeometryFiles.Num(); ++i)
+	{
+		SpawnStarted<ASCTReplayGeometryActor>(World, FVector(i * 1000.0f, -1000.0f, 0.0f), [&](ASCTReplayGeometryActor* Actor)
+		{
+			Actor->FileNamePath.FilePath = GeometryFiles[i];
+		});
+	}
+
+	OutResult.SetupMemoryMB = GetUsedMB() - MemoryBefore;
+	UE_LOG(LogSCTPlaybackBenchmark, Display, TEXT("Spawned %d cameras, %d skeletons and %d geometry actors, %.1f MB"), Settings.Cameras, Settings.Skeletons, Settings.Geometry, OutResult.SetupMemoryMB);
+
+	const float DeltaSeconds = 1.0f / Settings.FrameRate;
+	const int32 Frames = FMath::Max(1, FMath::RoundToInt(Settings.Duration * Settings.FrameRate));
+
+	// Counts allocations from every thread, but nothing else should be running in a commandlet
+	FCountingMalloc* CountingMalloc = new FCountingMalloc(GMalloc);
+
+	TArray<double> FrameTimes;
+	FrameTimes.Reserve(Frames);
+	double MemoryPeak = 0.0;
+	int64 AllocationsTotal = 0;
+
+	for (int32 Frame = -Settings.Warmup; Frame < Frames; ++Frame)
+	{
+		const bool bMeasured = Frame >= 0;
+		if (Frame == 0)
+		{
+			GMalloc = CountingMalloc;
+			OutResult.FramesDecoded = -kh::FSCTCounters::FramesDecoded.GetValue();
+			OutResult.MeshUpdates = -kh::FSCTCounters::MeshUpdates.GetValue();
+		}
+
+		const int64 AllocationsBefore = CountingMalloc->GetAllocations();
+		const double StartTime = FPlatformTime::Seconds();
+
+		World->Tick(LEVELTICK_All, DeltaSeconds);
+
+		const double Seconds = FPlatformTime::Seconds() - StartTime;
+		const int64 Allocations = CountingMalloc->GetAllocations() - AllocationsBefore;
+
+		// Done by the viewport in a game, the skeleton pawns draw their joints every frame
+		if (World->LineBatcher)
+		{
+			World->LineBatcher->Flush();
+		}
+		++GFrameCounter;
+
+		if (bMeasured)
+		{
+			FrameTimes.Add(Seconds * 1000.0);
+			OutResult.GameThreadSeconds += Seconds;
+			AllocationsTotal += Allocations;
+			OutResult.MaxAllocationsPerFrame = FMath::Max(OutResult.MaxAllocationsPerFrame, Allocations);
+			MemoryPeak = FMath::Max(MemoryPeak, GetUsedMB());
+		}
+	}
+
+	GMalloc = CountingMalloc->GetInner();
+	// Not deleted, another thread could still be inside it
+
+	OutResult.Frames = Frames;
+	OutResult.SimulatedSeconds = Frames * (double)DeltaSeconds;
+	OutResult.FramesDecoded += kh::FSCTCounters::FramesDecoded.GetValue();
+	OutResult.MeshUpdates += kh::FSCTCounters::MeshUpdates.GetValue();
+	OutResult.MeanAllocationsPerFrame = AllocationsTotal / (double)Frames;
+	OutResult.MeanFrameMs = OutResult.GameThreadSeconds * 1000.0 / Frames;
+	OutResult.P50FrameMs = GetPercentile(FrameTimes, 0.5);
+	OutResult.P95FrameMs = GetPercentile(FrameTimes, 0.95);
+	OutResult.P99FrameMs = GetPercentile(FrameTimes, 0.99);
+	OutResult.MaxFrameMs = FrameTimes.Num() ? FrameTimes.Last() : 0.0;
+	OutResult.PeakRunMemoryMB = MemoryPeak - MemoryBefore;
+	OutResult.PeakProcessMemoryMB = FPlatformMemory::GetStats().PeakUsedPhysical / (1024.0 * 1024.0);
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	for (const FString& Path : GeometryFiles)
+	{
+		IFileManager::Get().Delete(*Path);
+	}
+	return true;
+}
+
+static TSharedRef<FJsonObject> ToJson(const FPlaybackBenchmarkSettings& Settings, const FPlaybackBenchmarkResult& Result)
+{
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetNumberField(TEXT("Version"), BenchmarkFileVersion);
+	Root->SetStringField(TEXT("Platform"), FString(FPlatformProperties::IniPlatformName()));
+	Root->SetStringField(TEXT("CPU"), FPlatformMisc::GetCPUBrand().TrimStartAndEnd());
+	Root->SetStringField(TEXT("Date"), FDateTime::UtcNow().ToIso8601());
+	Root->SetStringField(TEXT("Configuration"), Settings.ToString());
+
+	Root->SetNumberField(TEXT("Frames"), Result.Frames);
+	Root->SetNumberField(TEXT("SimulatedSeconds"), Result.SimulatedSeconds);
+	Root->SetNumberField(TEXT("GameThreadSeconds"), Result.GameThreadSeconds);
+	Root->SetNumberField(TEXT("MeanFrameMs"), Result.MeanFrameMs);
+	Root->SetNumberField(TEXT("P50FrameMs"), Result.P50FrameMs);
+	Root->SetNumberField(TEXT("P95FrameMs"), Result.P95FrameMs);
+	Root->SetNumberField(TEXT("P99FrameMs"), Result.P99FrameMs);
+	Root->SetNumberField(TEXT("MaxFrameMs"), Result.MaxFrameMs);
+	Root->SetNumberField(TEXT("FramesDecoded"), Result.FramesDecoded);
+	Root->SetNumberField(TEXT("FramesDecodedPerSecond"), Result.GetFramesDecodedPerSecond());
+	Root->SetNumberField(TEXT("MeshUpdates"), Result.MeshUpdates);
+	Root->SetNumberField(TEXT("MeanAllocationsPerFrame"), Result.MeanAllocationsPerFrame);
+	Root->SetNumberField(TEXT("MaxAllocationsPerFrame"), Result.MaxAllocationsPerFrame);
+	Root->SetNumberField(TEXT("SetupMemoryMB"), Result.SetupMemoryMB);
+	Root->SetNumberField(TEXT("PeakRunMemoryMB"), Result.PeakRunMemoryMB);
+	Root->SetNumberField(TEXT("PeakProcessMemoryMB"), Result.PeakProcessMemoryMB);
+	return Root;
+}
+
+static bool SaveJson(const TSharedRef<FJsonObject>& Root, const FString& Path)
+{
+	FString Text;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Text);
+	if (FJsonSerializer::Serialize(Root, Writer) == false || FFileHelper::SaveStringToFile(Text, *Path) == false)
+	{
+		UE_LOG(LogSCTPlaybackBenchmark, Error, TEXT("Could not write %s"), *Path);
+		return false;
+	}
+
+	UE_LOG(LogSCTPlaybackBenchmark, Display, TEXT("Wrote %s"), *Path);
+	return true;
+}
+
+/** Returns the number of regressions against the baseline */
+static int32 CompareWithBaseline(const FString& BaselinePath, const FPlaybackBenchmarkSettings& Settings, const TSharedRef<FJsonObject>& Results, double Tolerance)
+{
+	FString Text;
+	TSharedPtr<FJsonObject> Baseline;
+	if (FFileHelper::LoadFileToString(Text, *BaselinePath) == false || FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Text), Baseline) == false || Baseline.IsValid() == false)
+	{
+		UE_LOG(LogSCTPlaybackBenchmark, Error, TEXT("Could not read baseline %s"), *BaselinePath);
+		return 1;
+	}
+
+	FString BaselineConfiguration;
+	if (Baseline->TryGetStringField(TEXT("Configuration"), BaselineConfiguration) == false || BaselineConfiguration != Settings.ToString())
+	{
+		UE_LOG(LogSCTPlaybackBenchmark, Warning, TEXT("Baseline %s was recorded with other arguments (%s), not comparing"), *BaselinePath, *BaselineConfiguration);
+		return 0;
+	}
+
+	UE_LOG(LogSCTPlaybackBenchmark, Display, TEXT("Comparing with %s, %.0f%% tolerance"), *BaselinePath, Tolerance * 100.0);
+
+	// Lower is better for all of these. The minimums keep noise on tiny values from failing the run
+	struct FMetric
+	{
+		const TCHAR* Name;
+		double Minimum;
+	};
+	const FMetric Metrics[] =
+	{
+		{ TEXT("MeanFrameMs"), 0.05 },
+		{ TEXT("P95FrameMs"), 0.1 },
+		{ TEXT("MeanAllocationsPerFrame"), 1.0 },
+		{ TEXT("PeakRunMemoryMB"), 4.0 },
+	};
+
+	int32 Regressions = 0;
+	for (const FMetric& Metric : Metrics)
+	{
+		double BaselineValue = 0.0;
+		if (Baseline->TryGetNumberField(Metric.Name, BaselineValue) == false)
+			continue;
+
+		const double Value = Results->GetNumberField(Metric.Name);
+		const bool bRegressed = Value > BaselineValue * (1.0 + Tolerance) + Metric.Minimum;
+		Regressions += bRegressed ? 1 : 0;
+		UE_LOG(LogSCTPlaybackBenchmark, Display, TEXT("%-24s %10.3f (was %.3f) %s"), Metric.Name, Value, BaselineValue, bRegressed ? TEXT("REGRESSION") : TEXT(""));
+	}
+
+	if (Regressions > 0)
+	{
+		UE_LOG(LogSCTPlaybackBenchmark, Error, TEXT("%d regressions against %s"), Regressions, *BaselinePath);
+	}
+	return Regressions;
+}
+
+USCTPlaybackBenchmarkCommandlet::USCTPlaybackBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 USCTPlaybackBenchmarkCommandlet::Main(const FString& Params)
+{
+	const TCHAR* Stream = *Params;
+
+	FPlaybackBenchmarkSettings Settings;
+	FString OutputPath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("SCT"), FString::Printf(TEXT("PlaybackBenchmark-%s.json"), *FDateTime::Now().ToString()));
+	FString BaselinePath;
+	float Tolerance = 0.1f;
+
+	FParse::Value(Stream, TEXT("Cameras="), Settings.Cameras);
+	FParse::Value(Stream, TEXT("Skeletons="), Settings.Skeletons);
+	FParse::Value(Stream, TEXT("Geometry="), Settings.Geometry);
+	FParse::Value(Stream, TEXT("Duration="), Settings.Duration);
+	FParse::Value(Stream, TEXT("FrameRate="), Settings.FrameRate);
+	FParse::Value(Stream, TEXT("Warmup="), Settings.Warmup);
+	FParse::Value(Stream, TEXT("CaptureFrames="), Settings.CaptureFrames);
+	FParse::Value(Stream, TEXT("Joints="), Settings.Capture.Joints);
+	FParse::Value(Stream, TEXT("MeshParts="), Settings.Capture.MeshParts);
+	FParse::Value(Stream, TEXT("MeshVertices="), Settings.Capture.MeshVertices);
+	FParse::Value(Stream, TEXT("MeshInterval="), Settings.Capture.MeshInterval);
+	FParse::Value(Stream, TEXT("Seed="), Settings.Capture.Seed);
+	FParse::Value(Stream, TEXT("Output="), OutputPath);
+	FParse::Value(Stream, TEXT("Baseline="), BaselinePath);
+	FParse::Value(Stream, TEXT("Tolerance="), Tolerance);
+	const bool bUpdateBaseline = FParse::Param(Stream, TEXT("UpdateBaseline"));
+
+	Settings.Cameras = FMath::Clamp(Settings.Cameras, 0, 4096);
+	Settings.Skeletons = FMath::Clamp(Settings.Skeletons, 0, 4096);
+	Settings.Geometry = FMath::Clamp(Settings.Geometry, 0, 64);
+	Settings.Duration = FMath::Max(Settings.Duration, 1.0f);
+	Settings.FrameRate = FMath::Clamp(Settings.FrameRate, 1.0f, 1000.0f);
+	Settings.Warmup = FMath::Max(Settings.Warmup, 0);
+	Settings.CaptureFrames = FMath::Max(Settings.CaptureFrames, 1);
+	Settings.Capture.Clamp();
+
+	if (FApp::CanEverRender())
+	{
+		UE_LOG(LogSCTPlaybackBenchmark, Warning, TEXT("Rendering is enabled, run with -nullrhi to measure the game thread on its own"));
+	}
+
+	const FString DefaultBaselinePath = FPaths::Combine(FPaths::ProjectPluginsDir(), TEXT("SCT"), TEXT("Benchmarks"), TEXT("Playback-") + FString(FPlatformProperties::IniPlatformName()) + TEXT(".json"));
+	if (BaselinePath.IsEmpty())
+	{
+		BaselinePath = DefaultBaselinePath;
+	}
+
+	UE_LOG(LogSCTPlaybackBenchmark, Display, TEXT("%s"), *Settings.ToString());
+
+	FPlaybackBenchmarkResult Result;
+	if (RunPlayback(Settings, Result) == false)
+		return 1;
+
+	UE_LOG(LogSCTPlaybackBenchmark, Display, TEXT("%d frames, game thread %.3f ms mean %.3f ms p95 %.3f ms p99 %.3f ms max"), Result.Frames, Result.MeanFrameMs, Result.P95FrameMs, Result.P99FrameMs, Result.MaxFrameMs);
+	UE_LOG(LogSCTPlaybackBenchmark, Display, TEXT("%lld frames decoded, %.0f per second of game thread time, %lld mesh updates"), Result.FramesDecoded, Result.GetFramesDecodedPerSecond(), Result.MeshUpdates);
+	UE_LOG(LogSCTPlaybackBenchmark, Display, TEXT("%.1f allocations per frame, %lld max"), Result.MeanAllocationsPerFrame, Result.MaxAllocationsPerFrame);
+	UE_LOG(LogSCTPlaybackBenchmark, Display, TEXT("Memory: %.1f MB setup, %.1f MB peak while running, %.1f MB process peak"), Result.SetupMemoryMB, Result.PeakRunMemoryMB, Result.PeakProcessMemoryMB);
+
+	const TSharedRef<FJsonObject> Results = ToJson(Settings, Result);
+	if (SaveJson(Results, OutputPath) == false)
+		return 1;
+
+	if (bUpdateBaseline)
+		return SaveJson(Results, BaselinePath) ? 0 : 1;
+
+	if (FPaths::FileExists(BaselinePath))
+		return CompareWithBaseline(BaselinePath, Settings, Results, Tolerance) > 0 ? 1 : 0;
+
+	UE_LOG(LogSCTPlaybackBenchmark, Display, TEXT("No baseline at %s, run with -UpdateBaseline to record one"), *BaselinePath);
+	return 0;
+}
@@ -0,0 +1,167 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTPosePredictor.h"
+
+namespace kh
+{
+	// 20 m/s and two turns a second in cm and radians, well beyond anything hand held
+	static constexpr float MaxLinearSpeed = 2000.0f;
+	static constexpr float MaxAngularSpeed = 4.0f * PI;
+	// Time steps shorter than this are treated as duplicates, they would blow up the velocity estimate
+	static constexpr double MinTimeStep = 0.001;
+
+	static FQuat IntegrateRotation(const FQuat& Rotation, const FVector& AxisAngle)
+	{
+		const float Angle = AxisAngle.Size();
+		if (Angle < KINDA_SMALL_NUMBER)
+			return Rotation;
+
+		FQuat Result = FQuat(AxisAngle / Angle, Angle) * Rotation;
+		Result.Normalize();
+		return Result;
+	}
+
+	static FVector RotationDelta(const FQuat& From, const FQuat& To)
+	{
+		// Shortest arc from From to To as axis * angle
+		FQuat Delta = To * From.Inverse();
+		if (Delta.W < 0.0f)
+		{
+			Delta = Delta * -1.0f;
+		}
+
+		FVector Axis;
+		float Angle;
+		Delta.ToAxisAndAngle(Axis, Angle);
+		return Axis * Angle;
+	}
+
+	FPosePredictor::FPosePredictor()
+	{
+		Reset();
+	}
+
+	void FPosePredictor::Reset()
+	{
+		bIsValid = false;
+		bHasVelocity = false;
+		LastTime = 0.0;
+		Filtered = FTransform::Identity;
+		LinearVelocity = FVector::ZeroVector;
+		AngularVelocity = FVector::ZeroVector;
+	}
+
+	void FPosePredictor::AddSample(double Time, const FTransform& Transform, const FPosePredictionSettings& Settings)
+	{
+		const double DeltaTime = Time - LastTime;
+
+		if (bIsValid == false || DeltaTime > Settings.MaxGap || DeltaTime < -Settings.MaxGap)
+		{
+			Reset();
+			bIsValid = true;
+			LastTime = Time;
+			Filtered = Transform;
+			return;
+		}
+
+		if (DeltaTime < MinTimeStep)
+			return;
+
+		const float Dt = (float)DeltaTime;
+		const FVector MeasuredLocation = Transform.GetLocation();
+		const FQuat MeasuredRotation = Transform.GetRotation();
+
+		if (Settings.Model == EPosePredictionModel::ConstantVelocity || bHasVelocity == false)
+		{
+			LinearVelocity = (MeasuredLocation - Filtered.GetLocation()) / Dt;
+			AngularVelocity = RotationDelta(Filtered.GetRotation(), MeasuredRotation) / Dt;
+			Filtered.SetLocation(MeasuredLocation);
+			Filtered.SetRotation(MeasuredRotation);
+		}
+		else
+		{
+			const FVector PredictedLocation = Filtered.GetLocation() + LinearVelocity * Dt;
+			const FQuat PredictedRotation = IntegrateRotation(Filtered.GetRotation(), AngularVelocity * Dt);
+
+			const FVector LocationResidual = MeasuredLocation - PredictedLocation;
+			const FVector RotationResidual = RotationDelta(PredictedRotation, MeasuredRotation);
+
+			Filtered.SetLocation(PredictedLocation + LocationResidual * Settings.Alpha);
+			Filtered.SetRotation(IntegrateRotation(PredictedRotation, RotationResidual * Settings.Alpha));
+			LinearVelocity += LocationResidual * (Settings.Beta / Dt);
+			AngularVelocity += RotationResidual * (Settings.Beta / Dt);
+		}
+
+		Filtered.SetScale3D(Transform.GetScale3D());
+		LinearVelocity = LinearVelocity.GetClampedToMaxSize(MaxLinearSpeed);
+		AngularVelocity = AngularVelocity.GetClampedToMaxSize(MaxAngularSpeed);
+
+		bHasVelocity = true;
+		LastTime = Time;
+	}
+
+	FTransform FPosePredictor::Predict(double Horizon, const FPosePredictionSettings& Settings) const
+	{
+		if (bHasVelocity == false)
+			return Filtered;
+
+		const float H = (float)FMath::Clamp(Horizon, 0.0, Settings.MaxHorizon);
+
+		FTransform Result = Filtered;
+		Result.SetLocation(Filtered.GetLocation() + LinearVelocity * H);
+		Result.SetRotation(IntegrateRotation(Filtered.GetRotation(), AngularVelocity * H));
+		return Result;
+	}
+
+	void FSubjectPredictor::SetSettings(const FPosePredictionSettings& InSettings)
+	{
+		Settings = InSettings;
+	}
+
+	void FSubjectPredictor::Reset(int32 JointCount)
+	{
+		CameraPredictor.Reset();
+		JointPredictors.Reset();
+		JointPredictors.SetNum(JointCount);
+	}
+
+	void FSubjectPredictor::Apply(double Time, double Horizon, FTransform& InOutCamera, TArray<FTransform>* InOutJoints)
+	{
+		if (Settings.bEnabled == false)
+			return;
+
+		CameraPredictor.AddSample(Time, InOutCamera, Settings);
+		InOutCamera = CameraPredictor.Predict(Horizon, Settings);
+
+		if (Settings.bPredictJoints && InOutJoints && InOutJoints->Num() == JointPredictors.Num())
+		{
+			TArray<FTransform>& Joints = *InOutJoints;
+			for (int32 i = 0, e = Joints.Num(); i < e; ++i)
+			{
+				JointPredictors[i].AddSample(Time, Joints[i], Settings);
+				Joints[i] = JointPredictors[i].Predict(Horizon, Settings);
+			}
+		}
+	}
+}
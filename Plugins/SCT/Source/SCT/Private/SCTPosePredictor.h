@@ -0,0 +1,75 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SCTLiveSettings.h"
+
+namespace kh
+{
+	/**
+	 * Tracks one transform over time and extrapolates it forward.
+	 * Velocities are clamped, time steps are bounded and a dropout restarts the track, so a stalled or bursty
+	 * stream can't make the prediction diverge
+	 */
+	class FPosePredictor
+	{
+	public:
+		FPosePredictor();
+
+		void Reset();
+		void AddSample(double Time, const FTransform& Transform, const FPosePredictionSettings& Settings);
+
+		/** Predicts the transform at Time + Horizon. Time is the time of the last sample */
+		FTransform Predict(double Horizon, const FPosePredictionSettings& Settings) const;
+
+		bool IsValid() const { return bIsValid; }
+
+	private:
+		bool bIsValid;
+		bool bHasVelocity;
+		double LastTime;
+		FTransform Filtered;
+		FVector LinearVelocity;
+		// Axis * angle per second
+		FVector AngularVelocity;
+	};
+
+	/** Predictors for a camera and, optionally, every joint of a skeleton */
+	class FSubjectPredictor
+	{
+	public:
+		void SetSettings(const FPosePredictionSettings& InSettings);
+		const FPosePredictionSettings& GetSettings() const { return Settings; }
+		void Reset(int32 JointCount);
+
+		/** Filters and extrapolates the camera and the model space joints in place */
+		void Apply(double Time, double Horizon, FTransform& InOutCamera, TArray<FTransform>* InOutJoints);
+
+	private:
+		FPosePredictionSettings Settings;
+		FPosePredictor CameraPredictor;
+		TArray<FPosePredictor> JointPredictors;
+	};
+}
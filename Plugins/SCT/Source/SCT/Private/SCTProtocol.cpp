@@ -0,0 +1,115 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTProtocol.h"
+#include "SCTSpatialSkeletonAsset.h"
+#include "SpatialDataDeserializer.h"
+
+namespace kh
+{
+	// Captures before 202005 have no anchors section
+	static void ReadNoUserAnchorsFromBuffer(FMRSerializeFromBuffer& FromBuffer, TArray<FVector>& UserAnchors)
+	{
+	}
+
+	#define SCT_PROTOCOL_DECODER(Version, ReadAnchors, ReadCamera) \
+		{ Version, CameraFrameSize, SkeletonJointSize, ReadAnchors, &ReadSkeletonDefinitionFromBuffer, ReadCamera, &FSpatialDataDeserializer::ReadSkeletonFrame, &FSpatialDataDeserializer::ReadMeshPart }
+
+	// One entry per layout in sct::FindLayout, oldest first
+	static const FProtocolDecoder ProtocolDecoders[] =
+	{
+		SCT_PROTOCOL_DECODER(202003, &ReadNoUserAnchorsFromBuffer, &FSpatialDataDeserializer::ReadCameraFrameWith<&sct::ReadLegacyCameraFrame>),
+		SCT_PROTOCOL_DECODER(202004, &ReadNoUserAnchorsFromBuffer, &FSpatialDataDeserializer::ReadCameraFrameWith<&sct::ReadLegacyCameraFrame>),
+		SCT_PROTOCOL_DECODER(202005, &ReadUserAnchorsFromBuffer, &FSpatialDataDeserializer::ReadCameraFrame),
+	};
+
+	#undef SCT_PROTOCOL_DECODER
+
+	const FProtocolDecoder* FindProtocolDecoder(int32 Version)
+	{
+		// SCTCore decides which versions can be read, the entries here add readers into engine types
+		if (sct::FindLayout(Version) == nullptr)
+			return nullptr;
+
+		for (const FProtocolDecoder& Decoder : ProtocolDecoders)
+		{
+			if (Decoder.Version == Version)
+				return &Decoder;
+		}
+		return nullptr;
+	}
+
+	const FProtocolDecoder& GetCurrentProtocolDecoder()
+	{
+		const FProtocolDecoder& Current = ProtocolDecoders[UE_ARRAY_COUNT(ProtocolDecoders) - 1];
+		checkSlow(Current.Version == SpatialProtocolVersion && ProtocolDecoders[0].Version == OldestSpatialProtocolVersion);
+		return Current;
+	}
+
+	void ReadHeaderFromBuffer(FMRSerializeFromBuffer& FromBuffer, FSpatialHeader& Header)
+	{
+		sct::CaptureHeader Read;
+		sct::ReadHeader(FromBuffer.GetReader(), Read);
+
+		Header.Version = Read.Version;
+		Header.FrameCount = Read.FrameCount;
+		Header.DeviceOrientation = Read.DeviceOrientation;
+		Header.HorizontalFOV = Read.HorizontalFOV;
+		Header.VerticalFOV = Read.VerticalFOV;
+		Header.FocalLengthX = Read.FocalLengthX;
+		Header.FocalLengthY = Read.FocalLengthY;
+		Header.CaptureType = Read.CaptureType;
+	}
+
+	void ReadUserAnchorsFromBuffer(FMRSerializeFromBuffer& FromBuffer, TArray<FVector>& UserAnchors)
+	{
+		std::vector<sct::Vec3> Anchors;
+		sct::ReadUserAnchors(FromBuffer.GetReader(), Anchors);
+
+		for (const sct::Vec3& Anchor : Anchors)
+		{
+			UserAnchors.Add(FVector(Anchor.X, Anchor.Y, Anchor.Z) * 100.0f);
+		}
+	}
+
+	void ReadSkeletonDefinitionFromBuffer(FMRSerializeFromBuffer& FromBuffer, FSCTSkeletonDefinition& SkeletonDefinition)
+	{
+		sct::SkeletonDefinition Read;
+		sct::ReadSkeletonDefinition(FromBuffer.GetReader(), Read);
+
+		SkeletonDefinition.JointNames.Empty((int32)Read.JointNames.size());
+		for (const std::string& Name : Read.JointNames)
+		{
+			FUTF8ToTCHAR Converted(Name.data(), (int32)Name.size());
+			SkeletonDefinition.JointNames.Add(FName(*FString(Converted.Length(), Converted.Get())));
+		}
+
+		SkeletonDefinition.ParentIndices = TArray<int32>(Read.ParentIndices.data(), (int32)Read.ParentIndices.size());
+
+		SkeletonDefinition.NeutralTransforms.SetNum((int32)Read.NeutralTransforms.size());
+		for (int32 i = 0; i < SkeletonDefinition.NeutralTransforms.Num(); ++i)
+		{
+			ConvertDeviceMatrix(Read.NeutralTransforms[i].M, SkeletonDefinition.NeutralTransforms[i]);
+		}
+	}
+}
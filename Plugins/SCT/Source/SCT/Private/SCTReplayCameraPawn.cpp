@@ -48,6 +48,10 @@ void ASCTReplayCameraPawn::BeginPlay()
 	{
 		SpatialData.InitWithCameraAsset(CameraDataAsset);
 	}
+	else if (TailFilePath.FilePath.IsEmpty() == false)
+	{
+		Tail = MakeUnique<kh::FCaptureFileTail>(TailFilePath.FilePath);
+	}
 }
 
 void ASCTReplayCameraPawn::Tick(float DeltaTime)
@@ -57,12 +61,26 @@ void ASCTReplayCameraPawn::Tick(float DeltaTime)
 	if (bRunning == false)
 		return;
 
+	if (Tail.IsValid())
+	{
+		// Hold the last frame until more is written
+		SpatialData.UpdateFromTail(*Tail);
+		if (SpatialData.HasFrameToRead() == false)
+			return;
+
+		// The camera frame follows the skeleton frame in skeleton captures
+		if (Tail->IsSkeletonCapture())
+		{
+			SpatialData.DeserialiseSkeleton();
+		}
+	}
+
 	SpatialData.DeserialiseCamera();
 
 	FTransform CameraTransform = SpatialData.GetCameraTransform();
 	SetActorRelativeTransform(CameraTransform);
 
-	SpatialData.StepFrame(bLoop);
+	SpatialData.StepFrame(bLoop && Tail.IsValid() == false);
 }
 
 void ASCTReplayCameraPawn::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
@@ -70,4 +88,10 @@ void ASCTReplayCameraPawn::SetupPlayerInputComponent(UInputComponent* PlayerInpu
 	Super::SetupPlayerInputComponent(PlayerInputComponent);
 }
 
+void ASCTReplayCameraPawn::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(SpatialData.GetAllocatedSize() + (Tail.IsValid() ? Tail->GetAllocatedSize() : 0));
+}
+
 #undef LOCTEXT_NAMESPACE
@@ -22,6 +22,9 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #include "SCTReplayGeometryActor.h"
+#include "SCTMemory.h"
+#include "SCTStats.h"
+#include "SpatialDataDeserializer.h"
 
 #define LOCTEXT_NAMESPACE "FSCTLiveLinkModule"
 DEFINE_LOG_CATEGORY_STATIC(SCTReplayGeometryActor, Log, All);
@@ -45,6 +48,7 @@ void ASCTReplayGeometryActor::BeginPlay()
 	IFileHandle* File = PlatformFile.OpenRead(*FileNamePath.FilePath);
 	if (File)
 	{
+		SCT_LLM_SCOPE(GeometryBuffers);
 		UE_LOG(SCTReplayGeometryActor, Display, TEXT("[SCT ReplayGeometry] Opened Replay File with size: %d"), File->Size());
 
 		FileBuffer.AddZeroed(File->Size());
@@ -85,43 +89,52 @@ void ASCTReplayGeometryActor::Tick(float DeltaTime)
 		{
 			ReadMeshPartFromStream(p);
 		}
+		kh::FSCTCounters::MeshUpdates.Increment();
 	}
 
 	++CurrentTick;
 }
 
-void ASCTReplayGeometryActor::ReadMeshPartFromStream(int Section)
+void ASCTReplayGeometryActor::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
 {
-	int64 VertCount;
-	FromBuffer >> VertCount;
-	TArray<FVector> Vertices; 
-	Vertices.InsertDefaulted(0, VertCount);
-	for (int v = 0; v < VertCount; ++v)
-	{
-		FVector Vert;
-		FromBuffer >> Vert;
+	Super::GetResourceSizeEx(CumulativeResourceSize);
 
-		Vert = FVector(-Vert.Z, Vert.X, Vert.Y) * 100.0f;
-		Vertices[v]=Vert;
+	SIZE_T Bytes = FileBuffer.GetAllocatedSize();
+	for (int32 Section = 0, NumSections = Mesh->GetNumSections(); Section < NumSections; ++Section)
+	{
+		if (const FProcMeshSection* MeshSection = Mesh->GetProcMeshSection(Section))
+		{
+			Bytes += MeshSection->ProcVertexBuffer.GetAllocatedSize() + MeshSection->ProcIndexBuffer.GetAllocatedSize();
+		}
 	}
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Bytes);
+}
+
+void ASCTReplayGeometryActor::ReadMeshPartFromStream(int Section)
+{
+	SCT_SCOPE_CYCLE_COUNTER(STAT_SCT_ReadMeshPart);
+	SCT_LLM_SCOPE(ProceduralMesh);
+	const int32 Start = FromBuffer.Tell();
 
-	int64 IndicesCount;
-	FromBuffer >> IndicesCount;
+	TArray<FVector> Vertices;
 	TArray<int32> Indices;
-	Indices.InsertDefaulted(0, IndicesCount);
-	for (int i = 0; i < IndicesCount; ++i)
-	{
-		uint32 Index;
-		FromBuffer >> Index;
-		Indices[i] = (int32)Index;
-	}
+	// Geometry streams carry no header, they are read with the current layout
+	kh::GetCurrentProtocolDecoder().ReadMeshPart(FromBuffer, Vertices, Indices);
+	const int32 VertCount = Vertices.Num();
 
 	TArray<FVector> Normals; Normals.InsertDefaulted(0, VertCount);
 	TArray<FVector2D> Uv0; Uv0.InsertDefaulted(0, VertCount);
 	TArray<FLinearColor> VertexColors; VertexColors.InsertDefaulted(0, VertCount);
 	TArray<FProcMeshTangent> Tangents;// tangents.InsertDefaulted(0, bfmesh.vertnum);
 
-	Mesh->CreateMeshSection_LinearColor(Section, Vertices, Indices, Normals, Uv0, VertexColors, Tangents, false);
+	INC_DWORD_STAT_BY(STAT_SCT_BytesRead, FromBuffer.Tell() - Start);
+
+	{
+		SCT_SCOPE_CYCLE_COUNTER(STAT_SCT_CreateMeshSection);
+		Mesh->CreateMeshSection_LinearColor(Section, Vertices, Indices, Normals, Uv0, VertexColors, Tangents, false);
+	}
+	INC_DWORD_STAT(STAT_SCT_SectionsRebuilt);
+	INC_DWORD_STAT_BY(STAT_SCT_VerticesUploaded, Vertices.Num());
 }
 
 #undef LOCTEXT_NAMESPACE
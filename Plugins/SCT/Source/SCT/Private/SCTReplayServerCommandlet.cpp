@@ -0,0 +1,459 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTReplayServerCommandlet.h"
+#include "SCTCompactFrame.h"
+#include "SCTProtocol.h"
+#include "SCTSpatialSkeletonAsset.h"
+#include "SpatialDataDeserializer.h"
+
+#include "Common/UdpSocketBuilder.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSCTReplayServer, Log, All);
+
+// Devices resend their header at this interval so a source started later picks them up
+static constexpr double HeaderIntervalSeconds = 1.0;
+static constexpr double ReportIntervalSeconds = 1.0;
+
+namespace
+{
+	struct FReplayCapture
+	{
+		FString Path;
+		bool bIsSkeletonCapture = false;
+		TArray<int32> ParentIndices;
+		// Header, user anchors and skeleton definition as recorded, the device name is appended per device
+		TArray<uint8> HeaderPayload;
+		TArray<uint8> FrameData;
+		int32 SkeletonFrameSize = 0;
+		int32 FrameSize = 0;
+		TArray<double> Timestamps;
+		double LoopLength = 0.0;
+
+		int32 GetFrameCount() const { return Timestamps.Num(); }
+		const uint8* GetFrame(int32 Frame) const { return FrameData.GetData() + Frame * FrameSize; }
+	};
+
+	struct FReplayDevice
+	{
+		const FReplayCapture* Capture = nullptr;
+		FSocket* Socket = nullptr;
+		TArray<uint8> HeaderPacket;
+		kh::FCompactFrameEncoder Encoder;
+		TArray<FTransform> Joints;
+
+		// Offset of this device's schedule from the start, so devices don't send in lockstep
+		double StartOffset = 0.0;
+		double LastHeaderTime = -1.0;
+		int32 Frame = 0;
+		int32 Loop = 0;
+		uint32 Sequence = 0;
+		bool bIsDone = false;
+	};
+
+	struct FPendingPacket
+	{
+		double SendTime;
+		int32 Device;
+		TArray<uint8> Data;
+	};
+
+	struct FPendingPacketOrder
+	{
+		bool operator()(const FPendingPacket& A, const FPendingPacket& B) const { return A.SendTime < B.SendTime; }
+	};
+}
+
+static bool LoadReplayCapture(const FString& Path, FReplayCapture& OutCapture)
+{
+	TArray<uint8> FileBuffer;
+	if (FFileHelper::LoadFileToArray(FileBuffer, *Path) == false)
+	{
+		UE_LOG(LogSCTReplayServer, Error, TEXT("Could not read %s"), *Path);
+		return false;
+	}
+
+	FMRSerializeFromBuffer FromBuffer(FileBuffer.GetData(), FileBuffer.Num());
+
+	kh::FSpatialHeader Header;
+	kh::ReadHeaderFromBuffer(FromBuffer, Header);
+
+	TArray<FVector> UserAnchors;
+	kh::ReadUserAnchorsFromBuffer(FromBuffer, UserAnchors);
+
+	FSCTSkeletonDefinition SkeletonDefinition;
+	OutCapture.bIsSkeletonCapture = Header.CaptureType == (int32)kh::ECaptureType::Skeleton;
+	if (OutCapture.bIsSkeletonCapture)
+	{
+		kh::ReadSkeletonDefinitionFromBuffer(FromBuffer, SkeletonDefinition);
+	}
+
+	if (FromBuffer.HasOverflow() || Header.Version != kh::SpatialProtocolVersion)
+	{
+		UE_LOG(LogSCTReplayServer, Error, TEXT("%s is not a version %d capture"), *Path, kh::SpatialProtocolVersion);
+		return false;
+	}
+
+	const int32 HeaderEnd = FromBuffer.Tell();
+	OutCapture.Path = Path;
+	OutCapture.ParentIndices = SkeletonDefinition.ParentIndices;
+	OutCapture.HeaderPayload.Append(FileBuffer.GetData(), HeaderEnd);
+	OutCapture.SkeletonFrameSize = OutCapture.bIsSkeletonCapture ? kh::GetSkeletonFrameSize(SkeletonDefinition.JointNames.Num()) : 0;
+	OutCapture.FrameSize = OutCapture.SkeletonFrameSize + kh::CameraFrameSize;
+
+	// Trust the data over the header, a capture cut short has fewer frames than it claims
+	const int32 FrameCount = (FileBuffer.Num() - HeaderEnd) / OutCapture.FrameSize;
+	if (FrameCount <= 0)
+	{
+		UE_LOG(LogSCTReplayServer, Error, TEXT("%s has no frames"), *Path);
+		return false;
+	}
+
+	OutCapture.FrameData.Append(FileBuffer.GetData() + HeaderEnd, FrameCount * OutCapture.FrameSize);
+
+	for (int32 Frame = 0; Frame < FrameCount; ++Frame)
+	{
+		FMRSerializeFromBuffer FrameBuffer(OutCapture.FrameData.GetData() + Frame * OutCapture.FrameSize + OutCapture.SkeletonFrameSize, kh::CameraFrameSize);
+		double Timestamp = 0.0;
+		FrameBuffer >> Timestamp;
+		OutCapture.Timestamps.Add(Timestamp);
+	}
+
+	// One frame interval past the last frame, so the first frame of the next loop keeps the cadence
+	const double Span = OutCapture.Timestamps.Last() - OutCapture.Timestamps[0];
+	OutCapture.LoopLength = FrameCount > 1 ? Span * FrameCount / (FrameCount - 1) : 1.0 / 60.0;
+
+	UE_LOG(LogSCTReplayServer, Display, TEXT("Loaded %s: %s capture, %d frames, %.2f s"), *Path, OutCapture.bIsSkeletonCapture ? TEXT("skeleton") : TEXT("camera"), FrameCount, OutCapture.LoopLength);
+	return true;
+}
+
+// The timestamp is the first field of the camera frame, a big endian double like the rest of the doubles in the format
+static void WriteTimestamp(uint8* CameraFrame, double Timestamp)
+{
+	uint64 Bits;
+	FMemory::Memcpy(&Bits, &Timestamp, sizeof(Bits));
+	for (int32 i = 0; i < 8; ++i)
+	{
+		CameraFrame[i] = (uint8)(Bits >> (56 - i * 8));
+	}
+}
+
+static void AppendPacketPrefix(TArray<uint8>& Packet, kh::ELivePacketType Type, uint32 Sequence)
+{
+	Packet.Add((uint8)Type);
+	Packet.Append((const uint8*)&Sequence, sizeof(Sequence));
+}
+
+USCTReplayServerCommandlet::USCTReplayServerCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 USCTReplayServerCommandlet::Main(const FString& Params)
+{
+	const TCHAR* Stream = *Params;
+
+	FString FileList;
+	FString Host = TEXT("127.0.0.1");
+	FString NamePrefix = TEXT("Replay");
+	int32 Port = kh::LiveDefaultPort;
+	int32 DeviceCount = 1;
+	float Speed = 1.0f;
+	float DurationSeconds = 0.0f;
+	float JitterSeconds = 0.0f;
+	float LossRate = 0.0f;
+
+	FParse::Value(Stream, TEXT("Files="), FileList, false);
+	FParse::Value(Stream, TEXT("Host="), Host);
+	FParse::Value(Stream, TEXT("Name="), NamePrefix);
+	FParse::Value(Stream, TEXT("Port="), Port);
+	FParse::Value(Stream, TEXT("Devices="), DeviceCount);
+	FParse::Value(Stream, TEXT("Speed="), Speed);
+	FParse::Value(Stream, TEXT("Duration="), DurationSeconds);
+	FParse::Value(Stream, TEXT("Jitter="), JitterSeconds);
+	FParse::Value(Stream, TEXT("Loss="), LossRate);
+	const bool bFast = FParse::Param(Stream, TEXT("Fast"));
+	const bool bLoop = FParse::Param(Stream, TEXT("Loop"));
+	const bool bCompact = FParse::Param(Stream, TEXT("Compact"));
+
+	DeviceCount = FMath::Clamp(DeviceCount, 1, 1024);
+	Speed = FMath::Max(Speed, 0.01f);
+
+	TArray<FString> Paths;
+	FileList.ParseIntoArray(Paths, TEXT(","));
+	if (Paths.Num() == 0)
+	{
+		UE_LOG(LogSCTReplayServer, Error, TEXT("No captures given, use -Files=a.dat,b.dat"));
+		return 1;
+	}
+
+	TArray<FReplayCapture> Captures;
+	Captures.SetNum(Paths.Num());
+	for (int32 i = 0; i < Paths.Num(); ++i)
+	{
+		if (LoadReplayCapture(Paths[i].TrimStartAndEnd(), Captures[i]) == false)
+			return 1;
+	}
+
+	FIPv4Address HostAddress;
+	if (FIPv4Address::Parse(Host, HostAddress) == false)
+	{
+		UE_LOG(LogSCTReplayServer, Error, TEXT("Host must be an IPv4 address, got %s"), *Host);
+		return 1;
+	}
+	const TSharedRef<FInternetAddr> Destination = FIPv4Endpoint(HostAddress, Port).ToInternetAddr();
+
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+
+	// Every device gets its own socket, the live source tells devices apart by sender address
+	TArray<TUniquePtr<FReplayDevice>> Devices;
+	for (int32 i = 0; i < DeviceCount; ++i)
+	{
+		TUniquePtr<FReplayDevice> Device = MakeUnique<FReplayDevice>();
+		Device->Capture = &Captures[i % Captures.Num()];
+		Device->Socket = FUdpSocketBuilder(TEXT("SCTReplayDevice"))
+			.AsNonBlocking()
+			.BoundToPort(0)
+			.WithSendBufferSize(kh::LiveMaxPacketSize * 16);
+
+		if (Device->Socket == nullptr)
+		{
+			UE_LOG(LogSCTReplayServer, Error, TEXT("Could not open socket for device %d"), i);
+			break;
+		}
+
+		const FReplayCapture& Capture = *Device->Capture;
+		const FTCHARToUTF8 Name(*FString::Printf(TEXT("%s %d"), *NamePrefix, i + 1));
+		const int32 NameLength = Name.Length();
+
+		AppendPacketPrefix(Device->HeaderPacket, kh::ELivePacketType::Header, 0);
+		Device->HeaderPacket.Append(Capture.HeaderPayload);
+		Device->HeaderPacket.Append((const uint8*)&NameLength, sizeof(NameLength));
+		Device->HeaderPacket.Append((const uint8*)Name.Get(), NameLength);
+
+		if (bCompact && Capture.bIsSkeletonCapture)
+		{
+			if (Device->Encoder.Init(Capture.ParentIndices))
+			{
+				Device->Joints.SetNum(Capture.ParentIndices.Num());
+			}
+			else if (i < Captures.Num())
+			{
+				UE_LOG(LogSCTReplayServer, Warning, TEXT("%d joints is more than compact frames support, sending full skeleton frames"), Capture.ParentIndices.Num());
+			}
+		}
+
+		Device->StartOffset = (double)i / DeviceCount * (Capture.LoopLength / Capture.GetFrameCount()) / Speed;
+		Devices.Add(MoveTemp(Device));
+	}
+
+	if (Devices.Num() == DeviceCount)
+	{
+		UE_LOG(LogSCTReplayServer, Display, TEXT("Streaming %d devices to %s:%d at %s%s%s"), DeviceCount, *Host, Port,
+			bFast ? TEXT("full speed") : *FString::Printf(TEXT("%.2fx"), Speed), bLoop ? TEXT(", looping") : TEXT(""), bCompact ? TEXT(", compact frames") : TEXT(""));
+
+		FRandomStream Random(4321);
+		TArray<FPendingPacket> Pending;
+		TArray<uint8> Packet;
+		uint8 AckPacket[16];
+
+		int64 FramesSent = 0;
+		int64 FramesLost = 0;
+		int64 SendFailures = 0;
+		int64 BytesSent = 0;
+		double MaxLateness = 0.0;
+		double TotalLateness = 0.0;
+		int64 IntervalFrames = 0;
+		int64 IntervalBytes = 0;
+
+		auto Send = [&](FReplayDevice& Device, const TArray<uint8>& Data)
+		{
+			int32 Sent = 0;
+			if (Device.Socket->SendTo(Data.GetData(), Data.Num(), Sent, *Destination) == false)
+			{
+				++SendFailures;
+				return false;
+			}
+			BytesSent += Sent;
+			IntervalBytes += Sent;
+			return true;
+		};
+
+		const double StartTime = FPlatformTime::Seconds();
+		double LastReportTime = StartTime;
+
+		while (true)
+		{
+			const double Now = FPlatformTime::Seconds();
+			const double Elapsed = Now - StartTime;
+			if (DurationSeconds > 0.0f && Elapsed >= DurationSeconds)
+				break;
+
+			while (Pending.Num() > 0 && Pending.HeapTop().SendTime <= Now)
+			{
+				FPendingPacket Delayed;
+				Pending.HeapPop(Delayed, FPendingPacketOrder(), false);
+				Send(*Devices[Delayed.Device], Delayed.Data);
+			}
+
+			double NextEventTime = Pending.Num() > 0 ? Pending.HeapTop().SendTime : MAX_dbl;
+			bool bAnyActive = false;
+
+			for (int32 DeviceIndex = 0; DeviceIndex < Devices.Num(); ++DeviceIndex)
+			{
+				FReplayDevice& Device = *Devices[DeviceIndex];
+				const FReplayCapture& Capture = *Device.Capture;
+
+				int32 AckSize = 0;
+				while (Device.Socket->Recv(AckPacket, sizeof(AckPacket), AckSize))
+				{
+					if (AckSize == 7 && AckPacket[0] == (uint8)kh::ELivePacketType::Ack)
+					{
+						uint16 KeyframeId;
+						FMemory::Memcpy(&KeyframeId, &AckPacket[5], sizeof(KeyframeId));
+						Device.Encoder.Acknowledge(KeyframeId);
+					}
+				}
+
+				if (Device.bIsDone)
+					continue;
+				bAnyActive = true;
+
+				// Schedule in capture time, starting at zero for the first frame of the first loop
+				const double CaptureTime = Capture.Timestamps[Device.Frame] - Capture.Timestamps[0] + Device.Loop * Capture.LoopLength;
+				const double DueTime = bFast ? Elapsed : Device.StartOffset + CaptureTime / Speed;
+				if (DueTime > Elapsed)
+				{
+					NextEventTime = FMath::Min(NextEventTime, StartTime + DueTime);
+					continue;
+				}
+
+				if (Device.LastHeaderTime < 0.0 || Now - Device.LastHeaderTime >= HeaderIntervalSeconds)
+				{
+					Send(Device, Device.HeaderPacket);
+					Device.LastHeaderTime = Now;
+				}
+
+				// Device clocks follow the send schedule, so the receiver sees a steady clock at any speed
+				const uint8* Frame = Capture.GetFrame(Device.Frame);
+				const double Timestamp = Capture.Timestamps[0] + DueTime;
+
+				Packet.Reset();
+				++Device.Sequence;
+				if (Device.Joints.Num() > 0)
+				{
+					FMRSerializeFromBuffer FromBuffer(const_cast<uint8*>(Frame), Capture.SkeletonFrameSize);
+					kh::FSpatialDataDeserializer::ReadSkeletonFrame(FromBuffer, Device.Joints);
+
+					AppendPacketPrefix(Packet, kh::ELivePacketType::CompactFrame, Device.Sequence);
+					Device.Encoder.Encode(FromBuffer.HasOverflow() ? nullptr : Device.Joints.GetData(), Packet);
+					Packet.Append(Frame + Capture.SkeletonFrameSize, kh::CameraFrameSize);
+				}
+				else
+				{
+					AppendPacketPrefix(Packet, Capture.bIsSkeletonCapture ? kh::ELivePacketType::SkeletonFrame : kh::ELivePacketType::CameraFrame, Device.Sequence);
+					Packet.Append(Frame, Capture.FrameSize);
+				}
+				WriteTimestamp(Packet.GetData() + Packet.Num() - kh::CameraFrameSize, Timestamp);
+
+				const double Lateness = Elapsed - DueTime;
+				MaxLateness = FMath::Max(MaxLateness, Lateness);
+				TotalLateness += Lateness;
+				++FramesSent;
+				++IntervalFrames;
+
+				if (Random.FRand() < LossRate)
+				{
+					++FramesLost;
+				}
+				else if (JitterSeconds > 0.0f)
+				{
+					const double SendTime = Now + Random.FRand() * JitterSeconds;
+					Pending.HeapPush(FPendingPacket{ SendTime, DeviceIndex, Packet }, FPendingPacketOrder());
+					NextEventTime = FMath::Min(NextEventTime, SendTime);
+				}
+				else
+				{
+					Send(Device, Packet);
+				}
+
+				if (++Device.Frame == Capture.GetFrameCount())
+				{
+					Device.Frame = 0;
+					++Device.Loop;
+					Device.bIsDone = bLoop == false;
+				}
+				NextEventTime = Now;
+			}
+
+			if (bAnyActive == false && Pending.Num() == 0)
+				break;
+
+			if (Now - LastReportTime >= ReportIntervalSeconds)
+			{
+				const double Interval = Now - LastReportTime;
+				UE_LOG(LogSCTReplayServer, Display, TEXT("%.0f frames/s (%.1f per device), %.2f Mbit/s, %lld lost, %lld send failures"),
+					IntervalFrames / Interval, IntervalFrames / Interval / Devices.Num(), IntervalBytes * 8.0 / Interval / 1e6, FramesLost, SendFailures);
+				IntervalFrames = 0;
+				IntervalBytes = 0;
+				LastReportTime = Now;
+			}
+
+			// Sleep coarsely and spin the last bit, the OS scheduler alone can't hold a 60 Hz cadence per device accurately
+			const double Wait = NextEventTime - FPlatformTime::Seconds();
+			if (Wait > 0.002)
+			{
+				FPlatformProcess::SleepNoStats(FMath::Min((float)(Wait - 0.001), (float)ReportIntervalSeconds));
+			}
+			else if (Wait > 0.0)
+			{
+				FPlatformProcess::YieldThread();
+			}
+		}
+
+		const double TotalSeconds = FMath::Max(FPlatformTime::Seconds() - StartTime, 1e-6);
+		UE_LOG(LogSCTReplayServer, Display, TEXT("Sent %lld frames in %.2f s: %.1f frames/s, %.1f per device, %.2f Mbit/s"),
+			FramesSent, TotalSeconds, FramesSent / TotalSeconds, FramesSent / TotalSeconds / Devices.Num(), BytesSent * 8.0 / TotalSeconds / 1e6);
+		UE_LOG(LogSCTReplayServer, Display, TEXT("Lost %lld frames on purpose, %lld send failures, %d still delayed at exit"), FramesLost, SendFailures, Pending.Num());
+		if (bFast == false && FramesSent > 0)
+		{
+			UE_LOG(LogSCTReplayServer, Display, TEXT("Schedule lateness: mean %.3f ms, max %.3f ms"), TotalLateness / FramesSent * 1000.0, MaxLateness * 1000.0);
+		}
+	}
+
+	for (const TUniquePtr<FReplayDevice>& Device : Devices)
+	{
+		SocketSubsystem->DestroySocket(Device->Socket);
+	}
+
+	return Devices.Num() == DeviceCount ? 0 : 1;
+}
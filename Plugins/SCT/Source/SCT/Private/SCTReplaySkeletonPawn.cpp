@@ -51,6 +51,10 @@ void ASCTReplaySkeletonPawn::BeginPlay()
 	{
  		SpatialData.InitWithSkeletonAsset(SkeletonDataAsset);
 	}
+	else if (TailFilePath.FilePath.IsEmpty() == false)
+	{
+		Tail = MakeUnique<kh::FCaptureFileTail>(TailFilePath.FilePath);
+	}
 }
 
 void ASCTReplaySkeletonPawn::Tick(float DeltaTime)
@@ -60,8 +64,19 @@ void ASCTReplaySkeletonPawn::Tick(float DeltaTime)
 	if (bRunning == false)
 		return;
 
-	SpatialData.DeserialiseSkeleton();
-	SpatialData.DeserialiseCamera();
+	// When following a file, hold the last frame until more is written
+	bool bHasNewFrame = true;
+	if (Tail.IsValid())
+	{
+		SpatialData.UpdateFromTail(*Tail);
+		bHasNewFrame = SpatialData.HasFrameToRead() && Tail->IsSkeletonCapture();
+	}
+
+	if (bHasNewFrame)
+	{
+		SpatialData.DeserialiseSkeleton();
+		SpatialData.DeserialiseCamera();
+	}
 
 	const kh::FSkeletonTransforms& SkeletonTransforms = SpatialData.GetSkeletonTransforms();
 	for (int i = 0, e = SkeletonTransforms.Transforms.Num(); i < e; ++i)
@@ -74,7 +89,10 @@ void ASCTReplaySkeletonPawn::Tick(float DeltaTime)
 	//CameraAnchor->SetRelativeTransform(CameraTransform);
 
 
-	SpatialData.StepFrame(bLoop);
+	if (bHasNewFrame)
+	{
+		SpatialData.StepFrame(bLoop && Tail.IsValid() == false);
+	}
 }
 
 void ASCTReplaySkeletonPawn::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
@@ -82,6 +100,12 @@ void ASCTReplaySkeletonPawn::SetupPlayerInputComponent(UInputComponent* PlayerIn
 	Super::SetupPlayerInputComponent(PlayerInputComponent);
 }
 
+void ASCTReplaySkeletonPawn::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(SpatialData.GetAllocatedSize() + (Tail.IsValid() ? Tail->GetAllocatedSize() : 0));
+}
+
 FTransform ASCTReplaySkeletonPawn::GetRelativeTransformByIndex(int index)
 {
 	const kh::FSkeletonTransforms& SkeletonTransforms = SpatialData.GetSkeletonTransforms();
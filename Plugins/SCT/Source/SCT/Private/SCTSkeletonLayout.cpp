@@ -0,0 +1,144 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTSkeletonLayout.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSCTSkeletonLayout, Log, All);
+
+namespace kh
+{
+	constexpr int32 FSCTBodySkeletonLayout::ParentIndices[];
+
+	FSkeletonPoseSolver::FSkeletonPoseSolver()
+		: bIsBodySkeletonLayout(false)
+	{
+	}
+
+	void FSkeletonPoseSolver::Init(const FSCTSkeletonDefinition& Definition)
+	{
+		const int32 JointCount = Definition.ParentIndices.Num();
+
+		bIsBodySkeletonLayout = MatchesSkeletonLayout<FSCTBodySkeletonLayout>(Definition);
+
+		ParentIndices = Definition.ParentIndices;
+		HasChildren.Init(false, JointCount);
+		ParentInverses.SetNum(JointCount);
+		EvaluationOrder.Reset(JointCount);
+
+		for (int32 i = 0; i < JointCount; ++i)
+		{
+			int32& ParentIdx = ParentIndices[i];
+			if (ParentIdx < -1 || ParentIdx >= JointCount || ParentIdx == i)
+			{
+				UE_LOG(LogSCTSkeletonLayout, Warning, TEXT("[SCT Skeleton] Joint %d has invalid parent %d, treating it as a root"), i, ParentIdx);
+				ParentIdx = -1;
+			}
+		}
+
+		// Breadth first from the roots so parents are always evaluated before their children
+		TArray<TArray<int32>> Children;
+		Children.SetNum(JointCount);
+		for (int32 i = 0; i < JointCount; ++i)
+		{
+			if (ParentIndices[i] == -1)
+			{
+				EvaluationOrder.Add(i);
+			}
+			else
+			{
+				Children[ParentIndices[i]].Add(i);
+				HasChildren[ParentIndices[i]] = true;
+			}
+		}
+
+		for (int32 Cursor = 0; Cursor < EvaluationOrder.Num(); ++Cursor)
+		{
+			EvaluationOrder.Append(Children[EvaluationOrder[Cursor]]);
+		}
+
+		// Joints that are part of a cycle never get reached from a root
+		if (EvaluationOrder.Num() != JointCount)
+		{
+			UE_LOG(LogSCTSkeletonLayout, Warning, TEXT("[SCT Skeleton] Skeleton hierarchy contains a cycle, treating unreachable joints as roots"));
+
+			TBitArray<> Reached(false, JointCount);
+			for (int32 JointIdx : EvaluationOrder)
+			{
+				Reached[JointIdx] = true;
+			}
+
+			for (int32 i = 0; i < JointCount; ++i)
+			{
+				if (Reached[i] == false)
+				{
+					ParentIndices[i] = -1;
+					EvaluationOrder.Add(i);
+				}
+			}
+		}
+	}
+
+	bool FSkeletonPoseSolver::ComputeLocalPose(const TArray<FTransform>& ModelSpace, TArray<FTransform>& OutLocal)
+	{
+		if (ModelSpace.Num() != ParentIndices.Num())
+		{
+			UE_LOG(LogSCTSkeletonLayout, Verbose, TEXT("[SCT Skeleton] Pose has %d joints, skeleton has %d"), ModelSpace.Num(), ParentIndices.Num());
+			OutLocal.Reset();
+			return false;
+		}
+
+		if (bIsBodySkeletonLayout)
+		{
+			OutLocal.SetNumUninitialized(FSCTBodySkeletonLayout::JointCount, false);
+			kh::ComputeLocalPose<FSCTBodySkeletonLayout>(ModelSpace.GetData(), OutLocal.GetData(), BodyParentInverses);
+			return true;
+		}
+
+		OutLocal.SetNumUninitialized(ParentIndices.Num(), false);
+
+		const FTransform* RESTRICT Model = ModelSpace.GetData();
+		FTransform* RESTRICT Local = OutLocal.GetData();
+		FTransform* RESTRICT Inverses = ParentInverses.GetData();
+
+		for (int32 JointIdx : EvaluationOrder)
+		{
+			const int32 ParentIdx = ParentIndices[JointIdx];
+			const FTransform& Joint = Model[JointIdx];
+
+			if (ParentIdx == -1)
+			{
+				Local[JointIdx] = Joint;
+			}
+			else
+			{
+				FTransform::Multiply(&Local[JointIdx], &Joint, &Inverses[ParentIdx]);
+			}
+
+			if (HasChildren[JointIdx])
+			{
+				Inverses[JointIdx] = Joint.Inverse();
+			}
+		}
+		return true;
+	}
+}
@@ -0,0 +1,162 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
+#include "SCTSpatialSkeletonAsset.h"
+
+namespace kh
+{
+	/**
+	 * The body skeleton streamed by the SCT app. Joint order matches EJointIndex
+	 */
+	struct FSCTBodySkeletonLayout
+	{
+		static constexpr int32 JointCount = 21;
+		static constexpr int32 ParentIndices[JointCount] =
+		{
+			-1,				// Root
+			0,				// Pelvis
+			1, 2, 3,		// Spine_01, Spine_02, Spine_03
+			4, 5,			// Neck_01, Head
+			4, 7, 8, 9,		// Clavicle_l, Upperarm_l, Lowerarm_l, Hand_l
+			4, 11, 12, 13,	// Clavicle_r, Upperarm_r, Lowerarm_r, Hand_r
+			1, 15, 16,		// Thigh_l, Calf_l, Foot_l
+			1, 18, 19		// Thigh_r, Calf_r, Foot_r
+		};
+	};
+
+	/** Fixed size joint storage for a known skeleton layout */
+	template<typename LayoutType>
+	using TSkeletonPose = TStaticArray<FTransform, LayoutType::JointCount>;
+
+	/** Returns true if the skeleton definition has exactly the topology described by LayoutType */
+	template<typename LayoutType>
+	bool MatchesSkeletonLayout(const FSCTSkeletonDefinition& Definition)
+	{
+		if (Definition.ParentIndices.Num() != LayoutType::JointCount || Definition.JointNames.Num() != LayoutType::JointCount)
+			return false;
+
+		for (int32 i = 0; i < LayoutType::JointCount; ++i)
+		{
+			if (Definition.ParentIndices[i] != LayoutType::ParentIndices[i])
+				return false;
+		}
+
+		return true;
+	}
+
+	namespace SkeletonLayout_Private
+	{
+		template<typename LayoutType>
+		constexpr bool HasChildJoint(int32 JointIndex)
+		{
+			for (int32 i = JointIndex + 1; i < LayoutType::JointCount; ++i)
+			{
+				if (LayoutType::ParentIndices[i] == JointIndex)
+					return true;
+			}
+			return false;
+		}
+
+		template<typename LayoutType, int32 JointIndex, bool bDone = (JointIndex >= LayoutType::JointCount)>
+		struct TLocalPoseUnroller
+		{
+			static FORCEINLINE void Compute(const FTransform* ModelSpace, FTransform* OutLocal, FTransform* ParentInverses)
+			{
+				constexpr int32 ParentIndex = LayoutType::ParentIndices[JointIndex];
+				static_assert(ParentIndex < JointIndex, "Skeleton layouts must list parents before their children");
+
+				if (ParentIndex == -1)
+				{
+					OutLocal[JointIndex] = ModelSpace[JointIndex];
+				}
+				else
+				{
+					FTransform::Multiply(&OutLocal[JointIndex], &ModelSpace[JointIndex], &ParentInverses[ParentIndex]);
+				}
+
+				// Parents precede their children, so the inverse is ready before any child needs it
+				if (HasChildJoint<LayoutType>(JointIndex))
+				{
+					ParentInverses[JointIndex] = ModelSpace[JointIndex].Inverse();
+				}
+				TLocalPoseUnroller<LayoutType, JointIndex + 1>::Compute(ModelSpace, OutLocal, ParentInverses);
+			}
+		};
+
+		template<typename LayoutType, int32 JointIndex>
+		struct TLocalPoseUnroller<LayoutType, JointIndex, true>
+		{
+			static FORCEINLINE void Compute(const FTransform* ModelSpace, FTransform* OutLocal, FTransform* ParentInverses)
+			{
+			}
+		};
+	}
+
+	/**
+	 * Converts model space joints to parent relative joints. The hierarchy walk is unrolled at compile time from the layout's parent table,
+	 * and each parent's inverse is computed once
+	 *
+	 * @param ModelSpace LayoutType::JointCount model space joint transforms
+	 * @param OutLocal receives LayoutType::JointCount parent relative joint transforms
+	 * @param ParentInverses scratch, written for joints with children
+	 */
+	template<typename LayoutType>
+	FORCEINLINE void ComputeLocalPose(const FTransform* ModelSpace, FTransform* OutLocal, TSkeletonPose<LayoutType>& ParentInverses)
+	{
+		SkeletonLayout_Private::TLocalPoseUnroller<LayoutType, 0>::Compute(ModelSpace, OutLocal, &ParentInverses[0]);
+	}
+
+	/**
+	 * Converts model space joints to parent relative joints for any skeleton definition.
+	 * Skeletons matching FSCTBodySkeletonLayout take the unrolled fixed layout path, all others are
+	 * evaluated in a precomputed hierarchy order with each parent's inverse computed once per frame
+	 */
+	class FSkeletonPoseSolver
+	{
+	public:
+		FSkeletonPoseSolver();
+
+		void Init(const FSCTSkeletonDefinition& Definition);
+		/** @return false if the pose doesn't have one transform per joint, OutLocal is left empty */
+		bool ComputeLocalPose(const TArray<FTransform>& ModelSpace, TArray<FTransform>& OutLocal);
+
+		bool IsBodySkeletonLayout() const { return bIsBodySkeletonLayout; }
+		int32 GetJointCount() const { return ParentIndices.Num(); }
+
+	private:
+		TArray<int32> ParentIndices;
+		// Joints sorted so that every parent precedes its children
+		TArray<int32> EvaluationOrder;
+		// True for joints that have at least one child
+		TBitArray<> HasChildren;
+		// Per frame scratch, only written for joints with children
+		TArray<FTransform> ParentInverses;
+
+		bool bIsBodySkeletonLayout;
+		TSkeletonPose<FSCTBodySkeletonLayout> BodyParentInverses;
+	};
+}
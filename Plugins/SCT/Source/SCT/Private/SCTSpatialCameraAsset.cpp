@@ -22,4 +22,103 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #include "SCTSpatialCameraAsset.h"
+#include "SCTSpatialSkeletonAsset.h"
+#include "SCTCustomVersion.h"
+#include "SCTMemory.h"
 
+#if WITH_EDITORONLY_DATA
+#include "EditorFramework/AssetImportData.h"
+#endif
+
+void USCTSpatialCameraAsset::PostInitProperties()
+{
+#if WITH_EDITORONLY_DATA
+	if (HasAnyFlags(RF_ClassDefaultObject) == false)
+	{
+		AssetImportData = NewObject<UAssetImportData>(this, TEXT("AssetImportData"));
+	}
+#endif
+	Super::PostInitProperties();
+}
+
+void USCTSpatialCameraAsset::PostLoad()
+{
+	Super::PostLoad();
+#if WITH_EDITOR
+	if (DecodedCapture.IsEmpty())
+	{
+		CacheDecodedCapture();
+	}
+#endif
+}
+
+void USCTSpatialCameraAsset::Serialize(FArchive& Ar)
+{
+	SCT_LLM_SCOPE(Captures);
+	Ar.UsingCustomVersion(FSCTCustomVersion::GUID);
+	Super::Serialize(Ar);
+
+	if (Ar.CustomVer(FSCTCustomVersion::GUID) < FSCTCustomVersion::CookedDecodedCapture)
+		return;
+
+	// Cooked assets carry the decoded frames, the editor decodes them or fetches them from the derived data cache on load
+	bool bCookedDecodedCapture = Ar.IsCooking() && bPreDecode;
+	Ar << bCookedDecodedCapture;
+	if (bCookedDecodedCapture)
+	{
+#if WITH_EDITOR
+		if (Ar.IsSaving() && DecodedCapture.IsEmpty())
+		{
+			CacheDecodedCapture();
+		}
+#endif
+		SCT_LLM_SCOPE(DecodedTracks);
+		Ar << DecodedCapture;
+	}
+}
+
+int32 USCTSpatialCameraAsset::GetJointCount() const
+{
+	const USCTSpatialSkeletonAsset* SkeletonAsset = Cast<USCTSpatialSkeletonAsset>(this);
+	return SkeletonAsset ? SkeletonAsset->SkeletonDefinition.JointNames.Num() : 0;
+}
+
+void USCTSpatialCameraAsset::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(FrameData.GetAllocatedSize() + UserAnchors.GetAllocatedSize() + DecodedCapture.GetAllocatedSize());
+}
+
+#if WITH_EDITOR
+void USCTSpatialCameraAsset::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	if (PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(USCTSpatialCameraAsset, bPreDecode))
+	{
+		CacheDecodedCapture();
+	}
+}
+
+void USCTSpatialCameraAsset::CacheDecodedCapture()
+{
+	if (bPreDecode == false || FrameCount <= 0)
+	{
+		DecodedCapture.Empty();
+		return;
+	}
+
+	DecodedCapture.CacheDerivedData(FrameData, Version, FrameCount, GetJointCount());
+}
+#endif
+
+#if WITH_EDITORONLY_DATA
+void USCTSpatialCameraAsset::GetAssetRegistryTags(TArray<FAssetRegistryTag>& OutTags) const
+{
+	if (AssetImportData)
+	{
+		OutTags.Add(FAssetRegistryTag(SourceFileTagName(), AssetImportData->GetSourceData().ToJson(), FAssetRegistryTag::TT_Hidden));
+	}
+	Super::GetAssetRegistryTags(OutTags);
+}
+#endif
@@ -23,3 +23,8 @@ SOFTWARE.
 */
 #include "SCTSpatialSkeletonAsset.h"
 
+void USCTSpatialSkeletonAsset::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(SkeletonDefinition.GetAllocatedSize());
+}
@@ -0,0 +1,141 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTSpscRing.h"
+
+namespace kh
+{
+	static_assert(sizeof(FSpscByteRing::FHeader) == 192, "The ring header layout is shared with out of process writers");
+
+	static FORCEINLINE uint32 AlignRecord(uint32 Size)
+	{
+		return Align(FSpscByteRing::RecordHeaderSize + Size, 8);
+	}
+
+	FSpscByteRing::FSpscByteRing()
+		: Header(nullptr)
+		, Data(nullptr)
+		, Capacity(0)
+		, PendingWriteOffset(0)
+		, PendingReadOffset(0)
+	{
+	}
+
+	bool FSpscByteRing::Init(void* Memory, SIZE_T MemorySize, bool bInitialize)
+	{
+		Header = nullptr;
+
+		if (Memory == nullptr || MemorySize <= HeaderSize || IsAligned(Memory, 64) == false)
+			return false;
+
+		FHeader* NewHeader = (FHeader*)Memory;
+		if (bInitialize)
+		{
+			FMemory::Memzero(NewHeader, HeaderSize);
+			NewHeader->Capacity = (uint32)AlignDown(MemorySize - HeaderSize, 8);
+			FPlatformAtomics::AtomicStore(&NewHeader->WriteOffset, 0);
+			FPlatformAtomics::AtomicStore(&NewHeader->ReadOffset, 0);
+			FPlatformMisc::MemoryBarrier();
+			NewHeader->Magic = Magic;
+		}
+		else if (NewHeader->Magic != Magic || NewHeader->Capacity == 0 || NewHeader->Capacity > MemorySize - HeaderSize || NewHeader->Capacity % 8 != 0)
+		{
+			return false;
+		}
+
+		Header = NewHeader;
+		Data = (uint8*)Memory + HeaderSize;
+		Capacity = NewHeader->Capacity;
+		PendingWriteOffset = FPlatformAtomics::AtomicRead(&Header->WriteOffset);
+		PendingReadOffset = FPlatformAtomics::AtomicRead(&Header->ReadOffset);
+		return true;
+	}
+
+	uint8* FSpscByteRing::BeginWrite(uint32 Size)
+	{
+		const uint32 RecordSize = AlignRecord(Size);
+		if (RecordSize > Capacity / 2)
+			return nullptr;
+
+		int64 WriteOffset = FPlatformAtomics::AtomicRead_Relaxed(&Header->WriteOffset);
+		const int64 ReadOffset = FPlatformAtomics::AtomicRead(&Header->ReadOffset);
+
+		uint32 Pos = (uint32)(WriteOffset % Capacity);
+		const uint32 ToEnd = Capacity - Pos;
+		const uint32 Needed = ToEnd < RecordSize ? ToEnd + RecordSize : RecordSize;
+
+		if (Capacity - (WriteOffset - ReadOffset) < Needed)
+			return nullptr;
+
+		// Not enough room before the end, mark the tail as unused and start over. Published together with the record
+		if (ToEnd < RecordSize)
+		{
+			*(uint32*)(Data + Pos) = WrapMarker;
+			WriteOffset += ToEnd;
+			Pos = 0;
+		}
+
+		*(uint32*)(Data + Pos) = Size;
+		PendingWriteOffset = WriteOffset + RecordSize;
+		return Data + Pos + RecordHeaderSize;
+	}
+
+	void FSpscByteRing::EndWrite()
+	{
+		FPlatformAtomics::AtomicStore(&Header->WriteOffset, PendingWriteOffset);
+	}
+
+	bool FSpscByteRing::BeginRead(uint8*& OutData, uint32& OutSize)
+	{
+		int64 ReadOffset = FPlatformAtomics::AtomicRead_Relaxed(&Header->ReadOffset);
+		const int64 WriteOffset = FPlatformAtomics::AtomicRead(&Header->WriteOffset);
+
+		while (ReadOffset != WriteOffset)
+		{
+			const uint32 Pos = (uint32)(ReadOffset % Capacity);
+			const uint32 Size = *(const uint32*)(Data + Pos);
+
+			if (Size == WrapMarker)
+			{
+				ReadOffset += Capacity - Pos;
+				continue;
+			}
+
+			// Only possible if an out of process writer corrupted the ring
+			if (Size > Capacity - Pos - RecordHeaderSize)
+				return false;
+
+			OutData = Data + Pos + RecordHeaderSize;
+			OutSize = Size;
+			PendingReadOffset = ReadOffset + AlignRecord(Size);
+			return true;
+		}
+
+		return false;
+	}
+
+	void FSpscByteRing::EndRead()
+	{
+		FPlatformAtomics::AtomicStore(&Header->ReadOffset, PendingReadOffset);
+	}
+}
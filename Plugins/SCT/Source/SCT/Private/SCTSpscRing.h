@@ -0,0 +1,98 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace kh
+{
+	/**
+	 * Single producer, single consumer queue of variable sized records in a caller provided block of memory.
+	 * Neither side takes a lock or allocates. Records are written and read in place, so the consumer can parse
+	 * straight from the ring. The block can live in process or in shared memory, the layout is:
+	 *
+	 * [Header 192 bytes] [Data Capacity bytes]
+	 *
+	 * Each record is [Size uint32] [Reserved uint32] [Payload] padded to 8 bytes. A Size of WrapMarker means
+	 * the rest of the data region is unused and the next record starts at offset 0.
+	 * Offsets in the header count bytes since the ring was created and never wrap
+	 */
+	class FSpscByteRing
+	{
+	public:
+		static constexpr uint32 Magic = 0x53435452; // SCTR
+		static constexpr uint32 WrapMarker = 0xFFFFFFFF;
+		static constexpr uint32 RecordHeaderSize = 8;
+
+		struct FHeader
+		{
+			uint32 Magic;
+			uint32 Capacity;
+			uint8 Pad0[56];
+			// Written by the producer only
+			volatile int64 WriteOffset;
+			uint8 Pad1[56];
+			// Written by the consumer only
+			volatile int64 ReadOffset;
+			uint8 Pad2[56];
+		};
+
+		static constexpr uint32 HeaderSize = sizeof(FHeader);
+
+		/** Total bytes needed for a ring with DataCapacity bytes of records */
+		static SIZE_T GetMemorySize(uint32 DataCapacity) { return HeaderSize + DataCapacity; }
+
+		FSpscByteRing();
+
+		/**
+		 * Attaches to a block of memory
+		 *
+		 * @param Memory the block, at least GetMemorySize bytes and 64 byte aligned
+		 * @param MemorySize the size of the block
+		 * @param bInitialize true for the side that creates the ring, false to attach to an existing one
+		 * @return false if the memory doesn't hold a valid ring
+		 */
+		bool Init(void* Memory, SIZE_T MemorySize, bool bInitialize);
+
+		/** Producer: returns where to write Size bytes, nullptr if the ring is full */
+		uint8* BeginWrite(uint32 Size);
+		/** Producer: publishes the record started by BeginWrite */
+		void EndWrite();
+
+		/** Consumer: points at the next record in place, false if the ring is empty */
+		bool BeginRead(uint8*& OutData, uint32& OutSize);
+		/** Consumer: frees the record returned by BeginRead */
+		void EndRead();
+
+		bool IsValid() const { return Header != nullptr; }
+
+	private:
+		FHeader* Header;
+		uint8* Data;
+		uint32 Capacity;
+
+		int64 PendingWriteOffset;
+		int64 PendingReadOffset;
+	};
+}
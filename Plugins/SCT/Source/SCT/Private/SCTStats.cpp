@@ -0,0 +1,50 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTStats.h"
+
+DEFINE_STAT(STAT_SCT_DeserialiseCamera);
+DEFINE_STAT(STAT_SCT_DeserialiseSkeleton);
+DEFINE_STAT(STAT_SCT_PollTail);
+DEFINE_STAT(STAT_SCT_ReadMeshPart);
+DEFINE_STAT(STAT_SCT_CreateMeshSection);
+
+DEFINE_STAT(STAT_SCT_RoutePacket);
+DEFINE_STAT(STAT_SCT_ParsePacket);
+DEFINE_STAT(STAT_SCT_DecodeCompactFrame);
+DEFINE_STAT(STAT_SCT_PredictPose);
+DEFINE_STAT(STAT_SCT_PushLiveLink);
+DEFINE_STAT(STAT_SCT_ReadPlaybackFrame);
+DEFINE_STAT(STAT_SCT_WriteRecordedFrame);
+
+DEFINE_STAT(STAT_SCT_FramesDecoded);
+DEFINE_STAT(STAT_SCT_BytesRead);
+DEFINE_STAT(STAT_SCT_FramesPushed);
+DEFINE_STAT(STAT_SCT_SectionsRebuilt);
+DEFINE_STAT(STAT_SCT_VerticesUploaded);
+
+namespace kh
+{
+	FThreadSafeCounter64 FSCTCounters::FramesDecoded;
+	FThreadSafeCounter64 FSCTCounters::MeshUpdates;
+}
@@ -0,0 +1,68 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("SCT"), STATGROUP_SCT, STATCAT_Advanced);
+
+// Replay
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Deserialise camera"), STAT_SCT_DeserialiseCamera, STATGROUP_SCT, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Deserialise skeleton"), STAT_SCT_DeserialiseSkeleton, STATGROUP_SCT, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Poll capture tail"), STAT_SCT_PollTail, STATGROUP_SCT, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Read mesh part"), STAT_SCT_ReadMeshPart, STATGROUP_SCT, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Create mesh section"), STAT_SCT_CreateMeshSection, STATGROUP_SCT, );
+
+// LiveLink
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Route live packet"), STAT_SCT_RoutePacket, STATGROUP_SCT, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Parse live packet"), STAT_SCT_ParsePacket, STATGROUP_SCT, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Decode compact frame"), STAT_SCT_DecodeCompactFrame, STATGROUP_SCT, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Predict pose"), STAT_SCT_PredictPose, STATGROUP_SCT, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Push to LiveLink"), STAT_SCT_PushLiveLink, STATGROUP_SCT, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Read playback frame"), STAT_SCT_ReadPlaybackFrame, STATGROUP_SCT, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Write recorded frame"), STAT_SCT_WriteRecordedFrame, STATGROUP_SCT, );
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Frames decoded"), STAT_SCT_FramesDecoded, STATGROUP_SCT, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Bytes read"), STAT_SCT_BytesRead, STATGROUP_SCT, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Frames pushed to LiveLink"), STAT_SCT_FramesPushed, STATGROUP_SCT, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Mesh sections rebuilt"), STAT_SCT_SectionsRebuilt, STATGROUP_SCT, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Vertices uploaded"), STAT_SCT_VerticesUploaded, STATGROUP_SCT, );
+
+// Times the scope for "stat SCT" and names it in Unreal Insights captures
+#define SCT_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE(Stat)
+
+namespace kh
+{
+	/** Totals since startup for the benchmarks. Unlike the stats these are counted in every build configuration */
+	struct FSCTCounters
+	{
+		static FThreadSafeCounter64 FramesDecoded;
+		static FThreadSafeCounter64 MeshUpdates;
+	};
+}
@@ -0,0 +1,273 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTSyntheticCapture.h"
+#include "SCTBlueprintFunctionLibrary.h"
+#include "SCTCaptureWriter.h"
+#include "SCTProtocol.h"
+
+#include "Math/RandomStream.h"
+
+namespace kh
+{
+	/** A hand held camera walking around, in device space (meters, radians), with a little tracking noise */
+	struct FSyntheticCameraPath
+	{
+		FVector Frequency;
+		FVector Amplitude;
+		FVector RotationFrequency;
+		FVector RotationAmplitude;
+		float YawRate;
+
+		void Init(FRandomStream& Random)
+		{
+			Frequency = FVector(Random.FRandRange(0.2f, 0.8f), Random.FRandRange(1.5f, 3.5f), Random.FRandRange(0.2f, 0.8f));
+			Amplitude = FVector(Random.FRandRange(0.5f, 3.0f), Random.FRandRange(0.02f, 0.08f), Random.FRandRange(0.5f, 3.0f));
+			RotationFrequency = FVector(Random.FRandRange(0.5f, 1.5f), Random.FRandRange(0.5f, 2.0f), Random.FRandRange(1.0f, 3.0f));
+			RotationAmplitude = FVector(Random.FRandRange(0.05f, 0.3f), Random.FRandRange(0.1f, 0.5f), Random.FRandRange(0.01f, 0.08f));
+			YawRate = Random.FRandRange(-0.4f, 0.4f);
+		}
+
+		void Sample(double Time, FRandomStream& Random, FVector& OutPosition, FVector& OutRotation) const
+		{
+			const FVector Noise(Random.FRandRange(-0.001f, 0.001f), Random.FRandRange(-0.001f, 0.001f), Random.FRandRange(-0.001f, 0.001f));
+			OutPosition = FVector(
+				FMath::Sin(Time * Frequency.X) * Amplitude.X,
+				1.4f + FMath::Sin(Time * Frequency.Y) * Amplitude.Y,
+				FMath::Cos(Time * Frequency.Z) * Amplitude.Z) + Noise;
+			OutRotation = FVector(
+				FMath::Sin(Time * RotationFrequency.X) * RotationAmplitude.X,
+				Time * YawRate + FMath::Sin(Time * RotationFrequency.Y) * RotationAmplitude.Y,
+				FMath::Sin(Time * RotationFrequency.Z) * RotationAmplitude.Z);
+		}
+	};
+
+	/** A joint hierarchy swinging every joint around its own axis while the root walks in a circle */
+	struct FSyntheticSkeleton
+	{
+		TArray<FString> JointNames;
+		TArray<int32> ParentIndices;
+		TArray<FVector> BoneOffsets;
+		TArray<FVector> Axes;
+		TArray<float> Frequencies;
+		TArray<float> Phases;
+
+		void Init(int32 JointCount, FRandomStream& Random)
+		{
+			// The body skeleton keeps its topology and names, so the output also drives the body helpers
+			const bool bBody = JointCount == FSCTBodySkeletonLayout::JointCount;
+			const UEnum* JointEnum = StaticEnum<EJointIndex>();
+
+			for (int32 i = 0; i < JointCount; ++i)
+			{
+				JointNames.Add(bBody ? JointEnum->GetNameStringByIndex(i).ToLower() : FString::Printf(TEXT("joint_%d"), i));
+				ParentIndices.Add(bBody ? FSCTBodySkeletonLayout::ParentIndices[i] : (i == 0 ? INDEX_NONE : Random.RandRange(FMath::Max(0, i - 4), i - 1)));
+				BoneOffsets.Add(i == 0 ? FVector::ZeroVector : FVector(Random.FRandRange(-0.05f, 0.05f), Random.FRandRange(0.05f, 0.3f), Random.FRandRange(-0.05f, 0.05f)));
+				Axes.Add(Random.GetUnitVector());
+				Frequencies.Add(Random.FRandRange(0.5f, 4.0f));
+				Phases.Add(Random.FRandRange(0.0f, 2.0f * PI));
+			}
+		}
+
+		void Pose(double Time, const FVector& Center, FMatrix* OutJoints) const
+		{
+			TArray<FTransform, TInlineAllocator<64>> ModelSpace;
+			ModelSpace.SetNum(JointNames.Num());
+
+			const float Heading = Time * 0.3f;
+			const FVector Root = Center + FVector(FMath::Sin(Heading) * 2.0f, 0.95f, FMath::Cos(Heading) * 2.0f);
+
+			for (int32 i = 0; i < ModelSpace.Num(); ++i)
+			{
+				const FQuat Local(Axes[i], 0.5f * FMath::Sin(Time * Frequencies[i] + Phases[i]));
+				const int32 Parent = ParentIndices[i];
+				if (Parent == INDEX_NONE)
+				{
+					ModelSpace[i] = FTransform(FQuat(FVector(0.0f, 1.0f, 0.0f), Heading) * Local, Root);
+				}
+				else
+				{
+					ModelSpace[i] = FTransform(ModelSpace[Parent].GetRotation() * Local, ModelSpace[Parent].TransformPosition(BoneOffsets[i]));
+				}
+				OutJoints[i] = ModelSpace[i].ToMatrixWithScale();
+			}
+		}
+
+		TArray<FMatrix> GetNeutralPose() const
+		{
+			TArray<FMatrix> Pose;
+			Pose.SetNum(JointNames.Num());
+			FSyntheticSkeleton Neutral = *this;
+			for (float& Frequency : Neutral.Frequencies)
+			{
+				Frequency = 0.0f;
+			}
+			for (float& Phase : Neutral.Phases)
+			{
+				Phase = 0.0f;
+			}
+			Neutral.Pose(0.0, FVector::ZeroVector, Pose.GetData());
+			return Pose;
+		}
+	};
+
+	void FSyntheticCaptureSettings::Clamp()
+	{
+		Frames = FMath::Max(Frames, 1);
+		FrameRate = FMath::Clamp(FrameRate, 1.0f, 1000.0f);
+		Anchors = FMath::Clamp(Anchors, 0, 1024);
+		Joints = FMath::Clamp(Joints, 1, 255);
+		Skeletons = FMath::Clamp(Skeletons, 1, 64);
+		MeshParts = FMath::Clamp(MeshParts, 1, 1024);
+		MeshVertices = FMath::Clamp(MeshVertices, 4, 16 * 1024 * 1024);
+		MeshInterval = FMath::Max(MeshInterval, 1);
+	}
+
+	bool WriteSyntheticCapture(FCaptureWriter& Writer, const FSyntheticCaptureSettings& Settings, bool bSkeleton, TFunctionRef<bool(int32)> OnFrame)
+	{
+		FRandomStream Random(Settings.Seed);
+
+		FSyntheticCameraPath CameraPath;
+		CameraPath.Init(Random);
+
+		FSyntheticSkeleton Skeleton;
+		if (bSkeleton)
+		{
+			Skeleton.Init(Settings.Joints, Random);
+		}
+
+		FSpatialHeader Header;
+		Header.Version = SpatialProtocolVersion;
+		Header.FrameCount = Settings.Frames;
+		Header.DeviceOrientation = 3;
+		Header.HorizontalFOV = 60.0f;
+		Header.VerticalFOV = 47.0f;
+		Header.FocalLengthX = 1450.0f;
+		Header.FocalLengthY = 1450.0f;
+		Header.CaptureType = (int32)(bSkeleton ? ECaptureType::Skeleton : ECaptureType::Camera);
+		Writer.Header(Header);
+
+		TArray<FVector> Anchors;
+		for (int32 i = 0; i < Settings.Anchors; ++i)
+		{
+			Anchors.Add(FVector(Random.FRandRange(-3.0f, 3.0f), Random.FRandRange(0.0f, 1.5f), Random.FRandRange(-3.0f, 3.0f)));
+		}
+		Writer.UserAnchors(Anchors);
+
+		if (bSkeleton)
+		{
+			Writer.SkeletonDefinition(Skeleton.JointNames, Skeleton.ParentIndices, Skeleton.GetNeutralPose());
+		}
+
+		// Device clocks count from boot, so the stream doesn't start at zero
+		const double StartTime = 1000.0 + Random.FRandRange(0.0f, 1000.0f);
+		TArray<FMatrix> Joints;
+		Joints.SetNum(Settings.Joints * Settings.Skeletons);
+
+		for (int32 Frame = 0; Frame < Settings.Frames; ++Frame)
+		{
+			const double Time = Frame / (double)Settings.FrameRate;
+
+			if (bSkeleton)
+			{
+				for (int32 i = 0; i < Settings.Skeletons; ++i)
+				{
+					Skeleton.Pose(Time + i * 0.37, FVector(i * 1.5f, 0.0f, 0.0f), Joints.GetData() + i * Settings.Joints);
+				}
+				Writer.SkeletonFrame(Joints.GetData(), Settings.Joints, Settings.Skeletons);
+			}
+
+			FVector Position;
+			FVector Rotation;
+			CameraPath.Sample(Time, Random, Position, Rotation);
+			Writer.CameraFrame(StartTime + Time, Position, Rotation, Random.FRandRange(-0.5f, 0.5f), 1.0 / 120.0);
+
+			if (OnFrame(Frame) == false)
+				return false;
+		}
+
+		return true;
+	}
+
+	bool WriteSyntheticGeometry(FCaptureWriter& Writer, const FSyntheticCaptureSettings& Settings, TFunctionRef<bool(int32)> OnPart)
+	{
+		FRandomStream Random(Settings.Seed);
+
+		// Every part is a square grid, a patch of reconstructed surface that is refined with every update
+		const int32 GridSize = FMath::Max(2, FMath::RoundToInt(FMath::Sqrt((float)Settings.MeshVertices)));
+		const int64 VertexCount = (int64)GridSize * GridSize;
+		const int64 IndexCount = (int64)(GridSize - 1) * (GridSize - 1) * 6;
+
+		TArray<FVector> PartOrigins;
+		TArray<float> PartPhases;
+		for (int32 Part = 0; Part < Settings.MeshParts; ++Part)
+		{
+			PartOrigins.Add(FVector(Random.FRandRange(-5.0f, 5.0f), Random.FRandRange(-0.5f, 0.5f), Random.FRandRange(-5.0f, 5.0f)));
+			PartPhases.Add(Random.FRandRange(0.0f, 2.0f * PI));
+		}
+
+		const float Spacing = 4.0f / GridSize;
+
+		for (int32 Update = 0; Update < Settings.Frames; ++Update)
+		{
+			// The replay actor reads the tick of the next update first
+			Writer.Int32((Update + 1) * Settings.MeshInterval);
+			Writer.Int32(Settings.MeshParts);
+
+			for (int32 Part = 0; Part < Settings.MeshParts; ++Part)
+			{
+				const float Refinement = 1.0f / (1.0f + Update);
+
+				Writer.Int64(VertexCount);
+				for (int32 Y = 0; Y < GridSize; ++Y)
+				{
+					for (int32 X = 0; X < GridSize; ++X)
+					{
+						const float Height = 0.2f * FMath::Sin(X * 0.3f + PartPhases[Part]) * FMath::Cos(Y * 0.2f) + Random.FRandRange(-0.05f, 0.05f) * Refinement;
+						Writer.Vector(PartOrigins[Part] + FVector(X * Spacing, Height, Y * Spacing));
+					}
+				}
+
+				Writer.Int64(IndexCount);
+				for (int32 Y = 0; Y < GridSize - 1; ++Y)
+				{
+					for (int32 X = 0; X < GridSize - 1; ++X)
+					{
+						const uint32 Corner = Y * GridSize + X;
+						Writer.UInt32(Corner);
+						Writer.UInt32(Corner + GridSize);
+						Writer.UInt32(Corner + 1);
+						Writer.UInt32(Corner + 1);
+						Writer.UInt32(Corner + GridSize);
+						Writer.UInt32(Corner + GridSize + 1);
+					}
+				}
+
+				if (OnPart(Update) == false)
+					return false;
+			}
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,61 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SCTSkeletonLayout.h"
+
+namespace kh
+{
+	class FCaptureWriter;
+
+	struct FSyntheticCaptureSettings
+	{
+		int32 Frames = 3600;
+		float FrameRate = 60.0f;
+		int32 Seed = 1;
+		int32 Anchors = 2;
+		int32 Joints = FSCTBodySkeletonLayout::JointCount;
+		int32 Skeletons = 1;
+		int32 MeshParts = 4;
+		int32 MeshVertices = 10000;
+		int32 MeshInterval = 30;
+
+		/** Clamps every value to what the format and the readers accept */
+		void Clamp();
+	};
+
+	/**
+	 * Writes a synthetic camera or skeleton capture: header, user anchors, the skeleton definition and Settings.Frames
+	 * frames. All randomness comes from Settings.Seed, so the same settings always give the same bytes.
+	 * OnFrame is called after every frame with its index, so callers can flush or report progress. Returning false stops
+	 */
+	bool WriteSyntheticCapture(FCaptureWriter& Writer, const FSyntheticCaptureSettings& Settings, bool bSkeleton, TFunctionRef<bool(int32)> OnFrame);
+
+	/**
+	 * Writes the stream the geometry replay actor reads, Settings.Frames updates of Settings.MeshParts parts, one every
+	 * Settings.MeshInterval ticks. OnPart is called after every part with the index of its update
+	 */
+	bool WriteSyntheticGeometry(FCaptureWriter& Writer, const FSyntheticCaptureSettings& Settings, TFunctionRef<bool(int32)> OnPart);
+}
@@ -0,0 +1,250 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTWireFormatBenchmarkCommandlet.h"
+#include "SCTCompactFrame.h"
+#include "SCTProtocol.h"
+#include "SCTSkeletonLayout.h"
+#include "SCTSpatialSkeletonAsset.h"
+#include "SpatialDataDeserializer.h"
+
+#include "Math/RandomStream.h"
+#include "Misc/Parse.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSCTWireFormatBenchmark, Log, All);
+
+// Packet Type and Sequence
+static constexpr int32 PacketPrefixSize = 5;
+
+static void MakeSyntheticFrames(int32 FrameCount, const TArray<int32>& ParentIndices, TArray<TArray<FTransform>>& OutFrames)
+{
+	const int32 JointCount = ParentIndices.Num();
+	FRandomStream Random(1234);
+
+	TArray<FVector> BoneOffsets;
+	for (int32 i = 0; i < JointCount; ++i)
+	{
+		BoneOffsets.Add(FVector(Random.FRandRange(5.0f, 30.0f), Random.FRandRange(-5.0f, 5.0f), Random.FRandRange(-5.0f, 5.0f)));
+	}
+
+	// Every joint swings around its own axis while the root walks forward
+	OutFrames.SetNum(FrameCount);
+	for (int32 Frame = 0; Frame < FrameCount; ++Frame)
+	{
+		const float Time = Frame / 60.0f;
+		TArray<FTransform>& Joints = OutFrames[Frame];
+		Joints.SetNum(JointCount);
+
+		for (int32 i = 0; i < JointCount; ++i)
+		{
+			const FVector Axis = FVector(FMath::Sin(i * 1.3f), FMath::Cos(i * 0.7f), 0.5f).GetSafeNormal();
+			const FQuat LocalRotation(Axis, 0.8f * FMath::Sin(Time * 2.0f + i));
+
+			const int32 Parent = ParentIndices[i];
+			if (Parent == INDEX_NONE)
+			{
+				Joints[i] = FTransform(LocalRotation, FVector(Time * 120.0f, 0.0f, 95.0f));
+			}
+			else
+			{
+				Joints[i] = FTransform(Joints[Parent].GetRotation() * LocalRotation, Joints[Parent].TransformPosition(BoneOffsets[i]));
+			}
+		}
+	}
+}
+
+static bool LoadCaptureFrames(const FString& CapturePath, TArray<int32>& OutParentIndices, TArray<TArray<FTransform>>& OutFrames, double& OutRawDecodeSeconds)
+{
+	USCTSpatialSkeletonAsset* Asset = LoadObject<USCTSpatialSkeletonAsset>(nullptr, *CapturePath);
+	if (Asset == nullptr)
+	{
+		UE_LOG(LogSCTWireFormatBenchmark, Error, TEXT("Could not load skeleton capture %s"), *CapturePath);
+		return false;
+	}
+
+	// Assets built in code leave the version unset, those are in the current layout
+	const kh::FProtocolDecoder* Decoder = Asset->Version == 0 ? &kh::GetCurrentProtocolDecoder() : kh::FindProtocolDecoder(Asset->Version);
+	if (Decoder == nullptr)
+	{
+		UE_LOG(LogSCTWireFormatBenchmark, Error, TEXT("Skeleton capture %s has unsupported version %d"), *CapturePath, Asset->Version);
+		return false;
+	}
+
+	OutParentIndices = Asset->SkeletonDefinition.ParentIndices;
+	const int32 JointCount = OutParentIndices.Num();
+
+	const int32 FrameSize = Decoder->GetFrameSize(true, JointCount);
+	const int32 FrameCount = FMath::Min(Asset->FrameCount, Asset->FrameData.Num() / FrameSize);
+
+	OutFrames.SetNum(FrameCount);
+	for (TArray<FTransform>& Joints : OutFrames)
+	{
+		Joints.SetNum(JointCount);
+	}
+
+	// Decoding the recorded format is the baseline the compact decoder is compared against
+	FMRSerializeFromBuffer FromBuffer(Asset->FrameData.GetData(), Asset->FrameData.Num());
+	FTransform CameraTransform;
+	kh::FCameraFrameMetaData CameraMetaData;
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (TArray<FTransform>& Joints : OutFrames)
+	{
+		Decoder->ReadSkeletonFrame(FromBuffer, Joints);
+		Decoder->ReadCameraFrame(FromBuffer, CameraTransform, CameraMetaData);
+	}
+	OutRawDecodeSeconds = FPlatformTime::Seconds() - StartTime;
+
+	return FrameCount > 0;
+}
+
+USCTWireFormatBenchmarkCommandlet::USCTWireFormatBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 USCTWireFormatBenchmarkCommandlet::Main(const FString& Params)
+{
+	const TCHAR* Stream = *Params;
+
+	FString CapturePath;
+	int32 SyntheticFrames = 3600;
+	float LossRate = 0.0f;
+	kh::FCompactFrameSettings Settings;
+
+	FParse::Value(Stream, TEXT("Capture="), CapturePath);
+	FParse::Value(Stream, TEXT("Frames="), SyntheticFrames);
+	FParse::Value(Stream, TEXT("KeyframeInterval="), Settings.KeyframeInterval);
+	FParse::Value(Stream, TEXT("Loss="), LossRate);
+
+	TArray<int32> ParentIndices;
+	TArray<TArray<FTransform>> Frames;
+	double RawDecodeSeconds = -1.0;
+
+	if (CapturePath.IsEmpty())
+	{
+		ParentIndices.Append(kh::FSCTBodySkeletonLayout::ParentIndices, kh::FSCTBodySkeletonLayout::JointCount);
+		MakeSyntheticFrames(FMath::Max(SyntheticFrames, 1), ParentIndices, Frames);
+	}
+	else if (LoadCaptureFrames(CapturePath, ParentIndices, Frames, RawDecodeSeconds) == false)
+	{
+		return 1;
+	}
+
+	const int32 FrameCount = Frames.Num();
+	const int32 JointCount = ParentIndices.Num();
+
+	// Encode everything first so encode and decode are timed separately, acks are fed back as if over a lossy link
+	kh::FCompactFrameEncoder Encoder;
+	kh::FCompactFrameDecoder Decoder;
+	if (Encoder.Init(ParentIndices, Settings) == false)
+	{
+		UE_LOG(LogSCTWireFormatBenchmark, Error, TEXT("%d joints is more than the compact format supports (%d)"), ParentIndices.Num(), kh::CompactMaxJoints);
+		return 1;
+	}
+	Decoder.Init(ParentIndices);
+
+	TArray<uint8> Encoded;
+	FRandomStream Random(5678);
+
+	double EncodeSeconds = 0.0;
+	int64 KeyframeBytes = 0;
+	int32 KeyframeCount = 0;
+	int32 LostCount = 0;
+	int32 MissingKeyframeCount = 0;
+	float MaxRotationError = 0.0f;
+	float MaxPositionError = 0.0f;
+	double DecodeSeconds = 0.0;
+
+	TArray<FTransform> Decoded;
+	Decoded.SetNum(JointCount);
+
+	for (int32 Frame = 0; Frame < FrameCount; ++Frame)
+	{
+		const int32 Offset = Encoded.Num();
+
+		const double EncodeStart = FPlatformTime::Seconds();
+		Encoder.Encode(Frames[Frame].GetData(), Encoded);
+		EncodeSeconds += FPlatformTime::Seconds() - EncodeStart;
+
+		if (Random.FRand() < LossRate)
+		{
+			++LostCount;
+			continue;
+		}
+
+		FMRSerializeFromBuffer FromBuffer(Encoded.GetData() + Offset, Encoded.Num() - Offset);
+		kh::FCompactFrameInfo Info;
+
+		const double DecodeStart = FPlatformTime::Seconds();
+		const kh::ECompactDecodeResult Result = Decoder.Decode(FromBuffer, Decoded, Info);
+		DecodeSeconds += FPlatformTime::Seconds() - DecodeStart;
+
+		if (Result == kh::ECompactDecodeResult::MissingKeyframe)
+		{
+			++MissingKeyframeCount;
+			continue;
+		}
+
+		if (Result != kh::ECompactDecodeResult::Decoded)
+		{
+			UE_LOG(LogSCTWireFormatBenchmark, Error, TEXT("Frame %d failed to decode"), Frame);
+			return 1;
+		}
+
+		if (Info.bIsKeyframe)
+		{
+			++KeyframeCount;
+			KeyframeBytes += Encoded.Num() - Offset;
+			Encoder.Acknowledge(Info.KeyframeId);
+		}
+
+		for (int32 i = 0; i < JointCount; ++i)
+		{
+			const FTransform& Expected = Frames[Frame][i];
+			MaxRotationError = FMath::Max(MaxRotationError, FMath::RadiansToDegrees(Decoded[i].GetRotation().AngularDistance(Expected.GetRotation())));
+			MaxPositionError = FMath::Max(MaxPositionError, FVector::Dist(Decoded[i].GetLocation(), Expected.GetLocation()));
+		}
+	}
+
+	const int32 DecodedCount = FrameCount - LostCount;
+	const int32 RawFrameBytes = PacketPrefixSize + kh::GetSkeletonFrameSize(JointCount) + kh::CameraFrameSize;
+	const double CompactFrameBytes = PacketPrefixSize + kh::CameraFrameSize + (double)Encoded.Num() / FrameCount;
+
+	UE_LOG(LogSCTWireFormatBenchmark, Display, TEXT("%d frames, %d joints, keyframe interval %d, %.1f%% loss"), FrameCount, JointCount, Settings.KeyframeInterval, LossRate * 100.0f);
+	UE_LOG(LogSCTWireFormatBenchmark, Display, TEXT("Recorded format: %d bytes per frame"), RawFrameBytes);
+	UE_LOG(LogSCTWireFormatBenchmark, Display, TEXT("Compact format:  %.1f bytes per frame (%.1fx smaller), keyframes %.1f bytes"), CompactFrameBytes, RawFrameBytes / CompactFrameBytes, KeyframeCount > 0 ? PacketPrefixSize + kh::CameraFrameSize + (double)KeyframeBytes / KeyframeCount : 0.0);
+	UE_LOG(LogSCTWireFormatBenchmark, Display, TEXT("Encode: %.2f us per frame"), EncodeSeconds * 1e6 / FrameCount);
+	UE_LOG(LogSCTWireFormatBenchmark, Display, TEXT("Decode: %.2f us per frame"), DecodedCount > 0 ? DecodeSeconds * 1e6 / DecodedCount : 0.0);
+	if (RawDecodeSeconds >= 0.0)
+	{
+		UE_LOG(LogSCTWireFormatBenchmark, Display, TEXT("Decode recorded format: %.2f us per frame"), RawDecodeSeconds * 1e6 / FrameCount);
+	}
+	UE_LOG(LogSCTWireFormatBenchmark, Display, TEXT("Max error: %.3f degrees, %.3f cm"), MaxRotationError, MaxPositionError);
+	UE_LOG(LogSCTWireFormatBenchmark, Display, TEXT("Lost %d frames, %d more undecodable until the next keyframe"), LostCount, MissingKeyframeCount);
+
+	return 0;
+}
@@ -22,6 +22,9 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #include "SpatialDataDeserializer.h"
+#include "SCTCaptureFileTail.h"
+#include "SCTMemory.h"
+#include "SCTStats.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogSpatialDataDeserializer, Log, All);
 
@@ -32,6 +35,10 @@ namespace kh
 		, CurrFrame(0)
 		, FrameCount(0)
 		, DeviceOrientation(0)
+		, TailGeneration(INDEX_NONE)
+		, Decoder(&GetCurrentProtocolDecoder())
+		, DecodedCapture(nullptr)
+		, DecodedFrame(0)
 	{
 		CameraTransform.SetLocation(FVector::ZeroVector);
 		CameraTransform.SetRotation(FQuat::Identity);
@@ -44,36 +51,110 @@ namespace kh
 
 	void FSpatialDataDeserializer::InitWithCameraAsset(class USCTSpatialCameraAsset* Asset)
 	{
-		FrameCount = Asset->FrameCount;
+		SCT_LLM_SCOPE(DecodedTracks);
 		DeviceOrientation = Asset->DeviceOrientation;
+		DecodedFrame = 0;
+
+		// Assets built in code leave the version unset, those are read as the current version. Any other version
+		// without a decoder would be read with the wrong layout, so nothing is read from it
+		const FProtocolDecoder* AssetDecoder = Asset->Version == 0 ? &GetCurrentProtocolDecoder() : FindProtocolDecoder(Asset->Version);
+		if (AssetDecoder == nullptr)
+		{
+			UE_LOG(LogSpatialDataDeserializer, Error, TEXT("%s has unsupported version %d, it can't be read"), *Asset->GetName(), Asset->Version);
+			FrameCount = 0;
+			FromBuffer.Init(nullptr, 0);
+			DecodedCapture = nullptr;
+			bShouldDeserialize = false;
+			return;
+		}
+
+		Decoder = AssetDecoder;
+		FrameCount = Asset->FrameCount;
 		FromBuffer.Init(Asset->FrameData.GetData(), Asset->FrameData.Num());
+		DecodedCapture = Asset->GetDecodedCapture().IsEmpty() ? nullptr : &Asset->GetDecodedCapture();
+		bShouldDeserialize = true;
 	}
 
 	void FSpatialDataDeserializer::InitWithSkeletonAsset(USCTSpatialSkeletonAsset* Asset)
 	{
+		SCT_LLM_SCOPE(DecodedTracks);
 		InitWithCameraAsset(Asset);
 		SkeletonDefinition = Asset->SkeletonDefinition;
 
 		SkeletonTransforms.Transforms.AddDefaulted(SkeletonDefinition.JointNames.Num());
 	}
 
+	void FSpatialDataDeserializer::UpdateFromTail(FCaptureFileTail& Tail)
+	{
+		SCT_LLM_SCOPE(DecodedTracks);
+		const int32 NewFrames = Tail.Poll();
+		if (Tail.HasHeader() == false)
+			return;
+
+		// Start over when the file was replaced
+		if (TailGeneration != Tail.GetGeneration())
+		{
+			TailGeneration = Tail.GetGeneration();
+			InitWithTail(Tail);
+		}
+		else if (NewFrames > 0)
+		{
+			UpdateFrameData(Tail.GetFrameData(), Tail.GetFrameCount());
+		}
+	}
+
+	void FSpatialDataDeserializer::InitWithTail(const FCaptureFileTail& Tail)
+	{
+		DecodedCapture = nullptr;
+		Decoder = Tail.GetDecoder();
+		CurrFrame = 0;
+		FrameCount = 0;
+		DeviceOrientation = Tail.GetHeader().DeviceOrientation;
+		SkeletonDefinition = Tail.GetSkeletonDefinition();
+
+		SkeletonTransforms.Transforms.Reset();
+		SkeletonTransforms.Transforms.AddDefaulted(SkeletonDefinition.JointNames.Num());
+
+		FromBuffer.Reset();
+		UpdateFrameData(Tail.GetFrameData(), Tail.GetFrameCount());
+	}
+
+	void FSpatialDataDeserializer::UpdateFrameData(const TArray<uint8>& FrameData, int32 NewFrameCount)
+	{
+		// Init keeps the read position. Only read from, the buffer just doesn't take const data
+		FromBuffer.Init(const_cast<uint8*>(FrameData.GetData()), FrameData.Num());
+
+		FrameCount = NewFrameCount;
+		bShouldDeserialize = true;
+	}
+
 	void FSpatialDataDeserializer::DeserialiseCamera()
 	{
 		if (bShouldDeserialize == false)
 			return;
 
-		FVector Pos = FVector::ZeroVector;
-		FVector Rot = FVector::ZeroVector;
-
-		FromBuffer >> CameraMetaData.Timestamp;
-		FromBuffer >> Pos;
-		FromBuffer >> Rot;
-		FromBuffer >> CameraMetaData.ExposureOffset;
-		FromBuffer >> CameraMetaData.ExposureDuration;
+		SCT_SCOPE_CYCLE_COUNTER(STAT_SCT_DeserialiseCamera);
+		if (DecodedCapture)
+		{
+			// The camera is read last in a frame. Past the end the last frame is held
+			if (DecodedFrame < DecodedCapture->GetFrameCount())
+			{
+				CameraTransform = DecodedCapture->CameraTransforms[DecodedFrame];
+				CameraMetaData.Timestamp = DecodedCapture->Timestamps[DecodedFrame];
+				CameraMetaData.ExposureOffset = DecodedCapture->ExposureOffsets[DecodedFrame];
+				CameraMetaData.ExposureDuration = DecodedCapture->ExposureDurations[DecodedFrame];
+				++DecodedFrame;
+			}
+			INC_DWORD_STAT(STAT_SCT_FramesDecoded);
+			FSCTCounters::FramesDecoded.Increment();
+			return;
+		}
 
-		CameraTransform.SetLocation(FVector(-Pos.Z, Pos.X, Pos.Y) * 100.0f);
-		//PYR from RPY
-		CameraTransform.SetRotation(FRotator(FMath::RadiansToDegrees(Rot.X), FMath::RadiansToDegrees(-Rot.Y), FMath::RadiansToDegrees(-Rot.Z)).Quaternion());
+		const int32 Start = FromBuffer.Tell();
+		Decoder->ReadCameraFrame(FromBuffer, CameraTransform, CameraMetaData);
+		INC_DWORD_STAT(STAT_SCT_FramesDecoded);
+		FSCTCounters::FramesDecoded.Increment();
+		INC_DWORD_STAT_BY(STAT_SCT_BytesRead, FromBuffer.Tell() - Start);
 	}
 
 	void FSpatialDataDeserializer::DeserialiseSkeleton()
@@ -81,19 +162,78 @@ namespace kh
 		if (bShouldDeserialize == false)
 			return;
 
+		SCT_SCOPE_CYCLE_COUNTER(STAT_SCT_DeserialiseSkeleton);
+		if (DecodedCapture)
+		{
+			if (DecodedFrame < DecodedCapture->GetFrameCount())
+			{
+				const int32 JointCount = FMath::Min(SkeletonTransforms.Transforms.Num(), DecodedCapture->JointCount);
+				FMemory::Memcpy(SkeletonTransforms.Transforms.GetData(), DecodedCapture->GetJointTransforms(DecodedFrame), JointCount * sizeof(FTransform));
+			}
+			return;
+		}
+
+		const int32 Start = FromBuffer.Tell();
+		Decoder->ReadSkeletonFrame(FromBuffer, SkeletonTransforms.Transforms);
+		INC_DWORD_STAT_BY(STAT_SCT_BytesRead, FromBuffer.Tell() - Start);
+	}
+
+	void FSpatialDataDeserializer::ConvertCameraFrame(const sct::CameraFrame& Frame, FTransform& OutTransform, FCameraFrameMetaData& OutMetaData)
+	{
+		OutMetaData.Timestamp = Frame.Timestamp;
+		OutMetaData.ExposureOffset = Frame.ExposureOffset;
+		OutMetaData.ExposureDuration = Frame.ExposureDuration;
+
+		const FVector Pos(Frame.Position.X, Frame.Position.Y, Frame.Position.Z);
+		const FVector Rot(Frame.Rotation.X, Frame.Rotation.Y, Frame.Rotation.Z);
+		OutTransform.SetLocation(FVector(-Pos.Z, Pos.X, Pos.Y) * 100.0f);
+		//PYR from RPY
+		OutTransform.SetRotation(FRotator(FMath::RadiansToDegrees(Rot.X), FMath::RadiansToDegrees(-Rot.Y), FMath::RadiansToDegrees(-Rot.Z)).Quaternion());
+	}
+
+	void FSpatialDataDeserializer::ReadSkeletonFrame(FMRSerializeFromBuffer& FromBuffer, TArray<FTransform>& InOutTransforms)
+	{
 		uint32 AnchorCount = 0;
 		FromBuffer >> AnchorCount;
 
 		// TODO(kbenjaminsson): Support multiple skeletons
 		// for (int i=0; i<AnchorCount; ++i)
 		{
-			for (int i = 0, e = SkeletonDefinition.ParentIndices.Num(); i<e; ++i)
+			for (int i = 0, e = InOutTransforms.Num(); i<e; ++i)
 			{
-				FromBuffer >> SkeletonTransforms.Transforms[i];
+				FromBuffer >> InOutTransforms[i];
 			}
 		}
 	}
 
+	void FSpatialDataDeserializer::ReadMeshPart(FMRSerializeFromBuffer& FromBuffer, TArray<FVector>& OutVertices, TArray<int32>& OutIndices)
+	{
+		// Counts are bounded by what is left to read, so a truncated stream can't allocate without limit
+		int64 VertCount = 0;
+		FromBuffer >> VertCount;
+		VertCount = FMath::Clamp<int64>(VertCount, 0, FromBuffer.AvailableToRead() / (int32)sizeof(FVector));
+
+		OutVertices.SetNumUninitialized((int32)VertCount);
+		for (int32 v = 0; v < VertCount; ++v)
+		{
+			FVector Vert;
+			FromBuffer >> Vert;
+			OutVertices[v] = FVector(-Vert.Z, Vert.X, Vert.Y) * 100.0f;
+		}
+
+		int64 IndicesCount = 0;
+		FromBuffer >> IndicesCount;
+		IndicesCount = FMath::Clamp<int64>(IndicesCount, 0, FromBuffer.AvailableToRead() / (int32)sizeof(uint32));
+
+		OutIndices.SetNumUninitialized((int32)IndicesCount);
+		for (int32 i = 0; i < IndicesCount; ++i)
+		{
+			uint32 Index;
+			FromBuffer >> Index;
+			OutIndices[i] = (int32)Index;
+		}
+	}
+
 	bool FSpatialDataDeserializer::StepFrame(bool bLoop)
 	{
 		if (bLoop == false && CurrFrame >= FrameCount)
@@ -107,6 +247,7 @@ namespace kh
 		if (CurrFrame >= FrameCount)
 		{
 			FromBuffer.Reset();
+			DecodedFrame = 0;
 			CurrFrame = 0;
 			bDidReset = true;
 		}
@@ -140,4 +281,9 @@ namespace kh
 	{
 		return DeviceOrientation;
 	}
+
+	SIZE_T FSpatialDataDeserializer::GetAllocatedSize() const
+	{
+		return SkeletonDefinition.GetAllocatedSize() + SkeletonTransforms.Transforms.GetAllocatedSize();
+	}
 }
\ No newline at end of file
@@ -25,11 +25,14 @@ SOFTWARE.
 
 #include "CoreMinimal.h"
 #include "SCTSerializeFromBuffer.h"
+#include "SCTProtocol.h"
 #include "SCTSpatialCameraAsset.h"
 #include "SCTSpatialSkeletonAsset.h"
 
 namespace kh
 {
+	class FCaptureFileTail;
+
 	struct FSkeletonTransforms
 	{
 		TArray<FTransform>Transforms;
@@ -53,10 +56,35 @@ namespace kh
 
 		void InitWithCameraAsset(USCTSpatialCameraAsset* Asset);
 		void InitWithSkeletonAsset(USCTSpatialSkeletonAsset* Asset);
+		/** Plays a file that is still being written. Call every tick, it picks up the frames appended since the last call */
+		void UpdateFromTail(FCaptureFileTail& Tail);
 		void DeserialiseCamera();
 		void DeserialiseSkeleton();
 
 		bool StepFrame(bool bLoop = true);
+		bool HasFrameToRead() const { return CurrFrame < FrameCount; }
+
+		// Frame readers of the current protocol version, shared by asset replay and live streams. Captures of other versions are read through their FProtocolDecoder
+		static void ReadCameraFrame(FMRSerializeFromBuffer& FromBuffer, FTransform& OutTransform, FCameraFrameMetaData& OutMetaData)
+		{
+			ReadCameraFrameWith<&sct::ReadCameraFrame>(FromBuffer, OutTransform, OutMetaData);
+		}
+		/** Reads a camera frame with one of the SCTCore frame readers and converts it to Unreal space */
+		template<void (*ReadFrame)(sct::ByteReader&, sct::CameraFrame&)>
+		static void ReadCameraFrameWith(FMRSerializeFromBuffer& FromBuffer, FTransform& OutTransform, FCameraFrameMetaData& OutMetaData)
+		{
+			// Fields past a truncation keep the previous frame's timing
+			sct::CameraFrame Frame;
+			Frame.Timestamp = OutMetaData.Timestamp;
+			Frame.ExposureOffset = OutMetaData.ExposureOffset;
+			Frame.ExposureDuration = OutMetaData.ExposureDuration;
+			ReadFrame(FromBuffer.GetReader(), Frame);
+			ConvertCameraFrame(Frame, OutTransform, OutMetaData);
+		}
+		static void ConvertCameraFrame(const sct::CameraFrame& Frame, FTransform& OutTransform, FCameraFrameMetaData& OutMetaData);
+		static void ReadSkeletonFrame(FMRSerializeFromBuffer& FromBuffer, TArray<FTransform>& InOutTransforms);
+		/** Reads one part of a geometry stream, vertices are converted to Unreal space */
+		static void ReadMeshPart(FMRSerializeFromBuffer& FromBuffer, TArray<FVector>& OutVertices, TArray<int32>& OutIndices);
 
 		const FTransform& GetCameraTransform() const;
 		const FCameraFrameMetaData& GetCameraFrameMetaData() const;
@@ -64,14 +92,26 @@ namespace kh
 		const FSkeletonTransforms& GetSkeletonTransforms() const;
 		const int32 GetDeviceOrientation() const;
 
+		/** Heap memory owned by the deserializer, the frame data it reads from isn't included */
+		SIZE_T GetAllocatedSize() const;
+
 	private:
+		void InitWithTail(const FCaptureFileTail& Tail);
+		/** Points at frame data that grew, keeping the playback position */
+		void UpdateFrameData(const TArray<uint8>& FrameData, int32 NewFrameCount);
 
 		bool bShouldDeserialize;
 		int32 CurrFrame;
 		int32 FrameCount;
 		int32 DeviceOrientation;
+		int32 TailGeneration;
 
 		FMRSerializeFromBuffer FromBuffer;
+		// Picked from the capture's version when initialized
+		const FProtocolDecoder* Decoder;
+		// Assets with bPreDecode are read from their decoded frames instead of FromBuffer
+		const FSCTDecodedCapture* DecodedCapture;
+		int32 DecodedFrame;
 
 		FTransform CameraTransform;
 		FCameraFrameMetaData CameraMetaData;
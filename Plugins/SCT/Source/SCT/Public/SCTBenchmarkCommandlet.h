@@ -0,0 +1,50 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SCTBenchmarkCommandlet.generated.h"
+
+/**
+ * Measures the throughput of the SCT parsing path on small and very large synthetic inputs: buffer reads, the matrix
+ * to transform conversion, camera and skeleton deserialisation and geometry parts. Also replays camera motion with a
+ * delay to measure the error left by each pose prediction model.
+ *
+ * UE4Editor-Cmd.exe Project.uproject -run=SCTBenchmark [-Filter=Skeleton] [-Small] [-Large] [-MinTime=1.0]
+ *     [-Capture=/Game/Path/Asset] [-Delays=0.033,0.066,0.1] [-Output=File.json] [-Baseline=File.json] [-Tolerance=0.1] [-UpdateBaseline]
+ *
+ * Results are written as JSON. Given a baseline, every benchmark slower, or prediction error larger, than the tolerance
+ * is reported as a regression and the commandlet fails. Baselines are kept per platform in Plugins/SCT/Benchmarks
+ */
+UCLASS()
+class USCTBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USCTBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -28,6 +28,8 @@ SOFTWARE.
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "SCTBlueprintFunctionLibrary.generated.h"
 
+class USCTSpatialCameraAsset;
+
 
 UENUM(BlueprintType)
 enum class EJointIndex : uint8
@@ -67,4 +69,8 @@ class SCT_API USCTBlueprintFunctionLibrary : public UBlueprintFunctionLibrary
 	static FVector GetJointLocationFromPawnByEnum(ASCTReplaySkeletonPawn* pawn, EJointIndex Joint);
 	UFUNCTION(BlueprintCallable, Category = "Skeleton")
 	static FTransform GetCameraTransformFromPawn(ASCTReplaySkeletonPawn* pawn);
+
+	/** Adds a LiveLink source that plays the captures back as live subjects, returns false if LiveLink isn't available */
+	UFUNCTION(BlueprintCallable, Category = "LiveLink")
+	static bool AddLiveLinkPlaybackSource(const TArray<USCTSpatialCameraAsset*>& Captures, bool bLoop = true, float PlaybackRate = 1.0f);
 };
@@ -0,0 +1,65 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/FrameRate.h"
+#include "SCTCaptureTrim.generated.h"
+
+/** The part of a capture that is kept when it is imported, and the rate it is resampled to. Kept on the asset for reimport */
+USTRUCT(BlueprintType)
+struct SCT_API FSCTCaptureTrimSettings
+{
+	GENERATED_BODY()
+
+	/** Seconds after the first frame to start at */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trim", meta = (ClampMin = "0"))
+	float StartTime = 0.0f;
+
+	/** Seconds after the first frame to end at, 0 keeps everything after StartTime */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trim", meta = (ClampMin = "0"))
+	float EndTime = 0.0f;
+
+	/** Interpolates frames at FrameRate, starting at StartTime, so they line up one to one with Sequencer frames */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trim")
+	bool bResample = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trim", meta = (EditCondition = "bResample"))
+	FFrameRate FrameRate = FFrameRate(24, 1);
+
+	bool IsSet() const { return StartTime > 0.0f || EndTime > 0.0f || bResample; }
+};
+
+namespace kh
+{
+	/**
+	 * Cuts the frames of a capture down to the window in Settings and resamples them if asked to. Rotations are
+	 * interpolated with slerp. Resampled frames are written in the current protocol layout and InOutVersion is
+	 * updated to match, trimmed frames are kept as they are
+	 *
+	 * @param bSkeleton whether the frames start with a skeleton frame of JointCount joints
+	 * @return false with OutError set if the capture can't be read or no frames are left
+	 */
+	SCT_API bool TrimCaptureFrames(const FSCTCaptureTrimSettings& Settings, int32& InOutVersion, bool bSkeleton, int32 JointCount, TArray<uint8>& InOutFrameData, int32& InOutFrameCount, FString& OutError);
+}
@@ -0,0 +1,233 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SCTSerializeFromBuffer.h"
+
+namespace kh
+{
+	/** Packs values LSB first into a byte array */
+	class FCompactBitWriter
+	{
+	public:
+		explicit FCompactBitWriter(TArray<uint8>& InBytes)
+			: Bytes(InBytes)
+			, Scratch(0)
+			, ScratchBits(0)
+		{
+		}
+
+		/** Writes the low NumBits of Value, NumBits at most 32 */
+		FORCEINLINE void WriteBits(uint32 Value, int32 NumBits)
+		{
+			checkSlow(NumBits >= 0 && NumBits <= 32);
+			Scratch |= (uint64)(Value & (uint32)((1ull << NumBits) - 1)) << ScratchBits;
+			ScratchBits += NumBits;
+			while (ScratchBits >= 8)
+			{
+				Bytes.Add((uint8)Scratch);
+				Scratch >>= 8;
+				ScratchBits -= 8;
+			}
+		}
+
+		/** Pads the last partial byte with zeros */
+		void Flush()
+		{
+			if (ScratchBits > 0)
+			{
+				Bytes.Add((uint8)Scratch);
+				Scratch = 0;
+				ScratchBits = 0;
+			}
+		}
+
+	private:
+		TArray<uint8>& Bytes;
+		uint64 Scratch;
+		int32 ScratchBits;
+	};
+
+	/** Reads values written by FCompactBitWriter, pulling bytes from the buffer as needed so overflow is tracked by the buffer */
+	class FCompactBitReader
+	{
+	public:
+		explicit FCompactBitReader(FMRSerializeFromBuffer& InFromBuffer)
+			: FromBuffer(InFromBuffer)
+			, Scratch(0)
+			, ScratchBits(0)
+		{
+		}
+
+		FORCEINLINE uint32 ReadBits(int32 NumBits)
+		{
+			checkSlow(NumBits >= 0 && NumBits <= 32);
+			while (ScratchBits < NumBits)
+			{
+				uint8 Byte = 0;
+				FromBuffer >> Byte;
+				Scratch |= (uint64)Byte << ScratchBits;
+				ScratchBits += 8;
+			}
+
+			const uint32 Value = (uint32)(Scratch & ((1ull << NumBits) - 1));
+			Scratch >>= NumBits;
+			ScratchBits -= NumBits;
+			return Value;
+		}
+
+		bool HasOverflow() const { return FromBuffer.HasOverflow(); }
+
+	private:
+		FMRSerializeFromBuffer& FromBuffer;
+		uint64 Scratch;
+		int32 ScratchBits;
+	};
+
+	/** Quantized joint as it is sent, deltas are coded against these values */
+	struct FCompactJoint
+	{
+		// Smallest three rotation, relative to the parent
+		uint8 LargestComponent;
+		uint16 Components[3];
+		// Position relative to joint 0, CompactPositionScale units
+		int16 Position[3];
+	};
+
+	struct FCompactPose
+	{
+		uint16 KeyframeId = 0;
+		bool bIsValid = false;
+		TArray<FCompactJoint> Joints;
+	};
+
+	/** Joint positions are sent in 1/CompactPositionScale cm, which limits them to about 3.2m from joint 0 */
+	static constexpr float CompactPositionScale = 100.0f;
+	static constexpr int32 CompactRotationBits = 10;
+	static constexpr int32 CompactKeyframeHistory = 8;
+	static constexpr int32 CompactMaxJoints = 255;
+
+	enum ECompactFrameFlags : uint8
+	{
+		CompactFrame_Keyframe = 1 << 0,
+		CompactFrame_HasSkeleton = 1 << 1,
+	};
+
+	struct FCompactFrameSettings
+	{
+		// A keyframe is sent at least this often so receivers that join or lose packets recover
+		int32 KeyframeInterval = 60;
+		// Without acks deltas are coded against the last keyframe sent, which only suits lossless links such as files
+		bool bUseAcks = true;
+	};
+
+	/** Joint evaluation order shared by the encoder and decoder, parents always come before their children */
+	class SCT_API FCompactSkeleton
+	{
+	public:
+		void Init(const TArray<int32>& InParentIndices);
+
+		int32 GetJointCount() const { return ParentIndices.Num(); }
+
+	protected:
+		TArray<int32> ParentIndices;
+		TArray<int32> EvaluationOrder;
+	};
+
+	/**
+	 * Encodes model space skeleton poses into the compact live format described in Protocol.md.
+	 * Rotations are sent relative to the parent as smallest three, positions relative to joint 0, and frames between
+	 * keyframes as deltas against the newest keyframe the receiver acknowledged
+	 */
+	class SCT_API FCompactFrameEncoder : public FCompactSkeleton
+	{
+	public:
+		/**
+		 * @return false for skeletons with more than CompactMaxJoints joints, the encoder then only writes camera only
+		 * frames and the sender should use full skeleton frames instead
+		 */
+		bool Init(const TArray<int32>& InParentIndices, const FCompactFrameSettings& InSettings = FCompactFrameSettings());
+
+		/**
+		 * Appends the skeleton part of a compact frame, the camera frame follows it
+		 *
+		 * @param Joints model space joints in Unreal space, nullptr for a camera only frame
+		 */
+		void Encode(const FTransform* Joints, TArray<uint8>& OutBytes);
+
+		/** Called when the receiver acknowledges a keyframe */
+		void Acknowledge(uint16 KeyframeId);
+
+		void ForceKeyframe() { bForceKeyframe = true; }
+
+	private:
+		void Quantize(const FTransform* Joints, FCompactPose& OutPose);
+		const FCompactPose* FindReference() const;
+
+		FCompactFrameSettings Settings;
+		FCompactPose History[CompactKeyframeHistory];
+		FCompactPose Current;
+		TArray<FQuat> ModelRotations;
+		uint16 NextKeyframeId = 0;
+		int32 LastAckedKeyframeId = INDEX_NONE;
+		int32 FramesSinceKeyframe = 0;
+		bool bForceKeyframe = true;
+	};
+
+	enum class ECompactDecodeResult : uint8
+	{
+		Decoded,
+		// A delta frame whose keyframe never arrived, recovered by the next keyframe
+		MissingKeyframe,
+		Malformed
+	};
+
+	struct FCompactFrameInfo
+	{
+		bool bIsKeyframe = false;
+		bool bHasSkeleton = false;
+		// Sent back in an Ack packet when bIsKeyframe is set
+		uint16 KeyframeId = 0;
+	};
+
+	/** Decodes frames written by FCompactFrameEncoder into model space joints */
+	class SCT_API FCompactFrameDecoder : public FCompactSkeleton
+	{
+	public:
+		void Init(const TArray<int32>& InParentIndices);
+
+		/**
+		 * Reads the skeleton part of a compact frame, leaving the buffer at the camera frame
+		 *
+		 * @param InOutJoints resized to the joint count, untouched unless the result is Decoded
+		 */
+		ECompactDecodeResult Decode(FMRSerializeFromBuffer& FromBuffer, TArray<FTransform>& InOutJoints, FCompactFrameInfo& OutInfo);
+
+	private:
+		FCompactPose History[CompactKeyframeHistory];
+		FCompactPose Current;
+		TArray<FQuat> ModelRotations;
+	};
+}
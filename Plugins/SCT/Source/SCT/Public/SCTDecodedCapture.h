@@ -0,0 +1,67 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Every frame of a capture decoded once up front, so replay indexes instead of converting the raw frames every tick.
+ * Tracks are stored per field, the joint transforms frame after frame with JointCount transforms each.
+ * Built in the editor through the derived data cache, keyed by a hash of the frame data and SCT_DECODED_CAPTURE_VERSION,
+ * and saved into cooked assets
+ */
+struct SCT_API FSCTDecodedCapture
+{
+	int32 JointCount = 0;
+
+	TArray<double> Timestamps;
+	TArray<float> ExposureOffsets;
+	TArray<double> ExposureDurations;
+	TArray<FTransform> CameraTransforms;
+	TArray<FTransform> JointTransforms;
+
+	int32 GetFrameCount() const { return CameraTransforms.Num(); }
+	bool IsEmpty() const { return CameraTransforms.Num() == 0; }
+	const FTransform* GetJointTransforms(int32 Frame) const { return JointTransforms.GetData() + Frame * JointCount; }
+
+	/**
+	 * Decodes up to FrameCount frames of a capture of protocol version Version, stopping early if the frame data is truncated.
+	 * Captures of a version without a decoder are left empty
+	 */
+	void Decode(const TArray<uint8>& FrameData, int32 Version, int32 FrameCount, int32 InJointCount);
+	void Empty();
+
+#if WITH_EDITOR
+	/**
+	 * Fetches the decoded frames from the derived data cache, decoding and storing them on a miss
+	 *
+	 * @return true if the frames were found in the cache
+	 */
+	bool CacheDerivedData(const TArray<uint8>& FrameData, int32 Version, int32 FrameCount, int32 InJointCount);
+#endif
+
+	SIZE_T GetAllocatedSize() const;
+
+	friend FArchive& operator<<(FArchive& Ar, FSCTDecodedCapture& Decoded);
+};
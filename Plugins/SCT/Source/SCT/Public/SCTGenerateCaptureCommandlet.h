@@ -0,0 +1,48 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SCTGenerateCaptureCommandlet.generated.h"
+
+/**
+ * Writes synthetic, protocol valid captures for scale and load testing. Output only depends on the arguments, so the
+ * same seed always gives the same file.
+ *
+ * UE4Editor-Cmd.exe Project.uproject -run=SCTGenerateCapture -Output=C:/Data/capture.dat [-Type=Camera|Skeleton|Geometry]
+ *     [-Frames=3600] [-FrameRate=60] [-Seed=1] [-Anchors=2] [-Joints=21] [-Skeletons=1] [-MeshParts=4] [-MeshVertices=10000] [-MeshInterval=30]
+ *
+ * Geometry streams write -Frames mesh updates, one every -MeshInterval ticks of the geometry replay actor
+ */
+UCLASS()
+class USCTGenerateCaptureCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USCTGenerateCaptureCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
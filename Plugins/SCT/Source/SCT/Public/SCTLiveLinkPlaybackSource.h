@@ -0,0 +1,98 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ILiveLinkSource.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+
+class FEvent;
+class FRunnableThread;
+class ILiveLinkClient;
+class USCTSpatialCameraAsset;
+
+struct SCT_API FSCTLiveLinkPlaybackSettings
+{
+	bool bLoop = true;
+	float PlaybackRate = 1.0f;
+};
+
+/**
+ * Plays imported camera and skeleton captures back as LiveLink subjects, so rigs driven by the live source can be
+ * rehearsed without a device. Every asset becomes its own subjects, "<Asset> Camera Transform" and
+ * "<Asset> Skeleton Transforms", and frames are published at their recorded timestamps from a worker thread.
+ * The frame data is copied when the source is created, which has to happen on the game thread
+ */
+class SCT_API FSCTLiveLinkPlaybackSource : public ILiveLinkSource, public FRunnable
+{
+public:
+	FSCTLiveLinkPlaybackSource(const TArray<USCTSpatialCameraAsset*>& Assets, const FSCTLiveLinkPlaybackSettings& InSettings = FSCTLiveLinkPlaybackSettings());
+	virtual ~FSCTLiveLinkPlaybackSource();
+
+	// Begin ILiveLinkSource Interface
+	virtual void ReceiveClient(ILiveLinkClient* InClient, FGuid InSourceGuid) override;
+	virtual bool IsSourceStillValid() const override;
+	virtual bool RequestSourceShutdown() override;
+	virtual FText GetSourceType() const override;
+	virtual FText GetSourceMachineName() const override;
+	virtual FText GetSourceStatus() const override;
+	// End ILiveLinkSource Interface
+
+	// Begin FRunnable Interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	// End FRunnable Interface
+
+private:
+	// Defined in the cpp, holds the private decoder and solver types
+	struct FPlaybackTrack;
+
+	void StopThread();
+
+	// Worker thread only
+	void StartTrack(FPlaybackTrack& Track, double StartTime);
+	bool ReadNextFrame(FPlaybackTrack& Track);
+	void PublishFrame(FPlaybackTrack& Track);
+
+	// Livelink Identifiers
+	ILiveLinkClient* LiveLinkClient;
+	FGuid LiveLinkSourceGuid;
+
+	// Livelink Source Parameters
+	FText SourceType;
+	FText SourceMachineName;
+
+	FSCTLiveLinkPlaybackSettings Settings;
+	TArray<TUniquePtr<FPlaybackTrack>> Tracks;
+
+	FRunnableThread* Thread;
+	FEvent* WakeEvent;
+	FThreadSafeBool bStopping;
+
+	// Status, read from the game thread
+	FThreadSafeCounter FramesPublished;
+	FThreadSafeCounter ActiveTracks;
+};
@@ -25,19 +25,62 @@ SOFTWARE.
 
 #include "CoreMinimal.h"
 #include "ILiveLinkSource.h"
-#include "Containers/Ticker.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+
+#include "SCTProtocol.h"
+#include "SCTLiveSettings.h"
+
+class FSocket;
+class FRunnableThread;
+class FInternetAddr;
+class ISocketSubsystem;
+class ILiveLinkClient;
 
-#include "SpatialDataDeserializer.h"
+namespace kh
+{
+	class FLiveDevice;
+	class FLiveDeviceWorker;
+	class FLiveRecorder;
+	class FSpscByteRing;
+}
 
-class ILiveLinkClient;
-struct FLiveLinkSkeletonStaticData;
-struct FLiveLinkTransformFrameData;
-struct FLiveLinkAnimationFrameData;
+struct SCT_API FSCTLiveLinkSourceSettings
+{
+	int32 Port = kh::LiveDefaultPort;
+	// Threads parsing and publishing device streams, 0 uses the spare cores
+	int32 WorkerThreads = 0;
+	// When set, frames are read from a ring in this named shared memory region instead of UDP
+	FString SharedMemoryName;
+	int32 SharedMemorySize = 4 * 1024 * 1024;
+	// When set, every device stream is also recorded to a capture file in this directory
+	FString RecordDirectory;
+	kh::FLiveTimingSettings Timing;
+	kh::FPosePredictionSettings Prediction;
+
+	/** Parses connection strings like "Port=7700 Workers=2 JitterBuffer=true MaxDelay=0.25 Predict=true Record=C:/Takes" or "SharedMemory=SCTLive" */
+	static FSCTLiveLinkSourceSettings FromConnectionString(const FString& ConnectionString);
+};
 
-class SCT_API FSCTLiveLinkSource : public ILiveLinkSource
+/**
+ * Receives SCT frames streamed from any number of devices over UDP and publishes them as LiveLink subjects,
+ * one camera subject and one skeleton subject per device, prefixed with the device name.
+ * A receive thread only reads datagrams and routes them by sender to worker threads, which parse the packets,
+ * hold them in a per device adaptive jitter buffer and publish them. Optionally the published poses are
+ * extrapolated forward by the measured delay to hide latency.
+ * A process on the same machine can instead write packets into a ring in named shared memory, which the receive
+ * thread parses in place and publishes itself.
+ * Streams can be recorded to capture files as they are received, without the recording touching the receive or
+ * publish threads.
+ * The latency of every frame is tracked from capture to the engine frame that consumes it, see "stat SCTLiveLink"
+ * and the SCT.LiveLink.LatencyCsv console command
+ */
+class SCT_API FSCTLiveLinkSource : public ILiveLinkSource, public FRunnable
 {
 public:
-	FSCTLiveLinkSource();
+	FSCTLiveLinkSource(const FSCTLiveLinkSourceSettings& InSettings = FSCTLiveLinkSourceSettings());
 	virtual ~FSCTLiveLinkSource();
 
 	// Begin ILiveLinkSource Interface
@@ -49,37 +92,71 @@ public:
 	virtual FText GetSourceStatus() const override;
 	// End ILiveLinkSource Interface
 
+	// Begin FRunnable Interface
+	virtual bool Init() override;
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	// End FRunnable Interface
+
+	/** Latency of every stage per device and for all devices, as CSV rows without a header line */
+	FString GetLatencyCsvRows() const;
+	void ResetLatency();
+
 private:
-	// Add a Tick Function to this livelink source
-	bool Tick(float DeltaTime);
-	// Update LiveLinkData
-	void UpdateLiveLink(float DeltaTime);
-
-	// Role population
-	void PopulateBasePropertyNames(TArray<FName>& PropertyNames);
-	void UpdateBaseStaticData(FLiveLinkBaseStaticData& InOutData);
-	void UpdateSkeletonStaticData(FLiveLinkSkeletonStaticData& InOutData);
-	void UpdateBaseFrameData(FLiveLinkBaseFrameData& InOutData, float DeltaTime);
-	void UpdateTransformFrameData(FLiveLinkTransformFrameData& InOutData, float DeltaTime);
-	void UpdateSkeletonFrameData(FLiveLinkAnimationFrameData& InOutData, float DeltaTime);
-
-	// Property Names
-	TArray<FName> BasePropertyNames;
-
-	// Tick Delegate Handles
-	FTickerDelegate TickDelegate;
-	FDelegateHandle TickDelegateHandle;
+	struct FDeviceRoute
+	{
+		TSharedRef<FInternetAddr> Address;
+		kh::FLiveDevice* Device;
+		kh::FLiveDeviceWorker* Worker;
+	};
+
+	void Start();
+	bool StartSharedMemory();
+	void StopThreads();
+	void OnBeginFrame();
+
+	kh::FLiveDevice* CreateDevice(const FString& Address);
+
+	// Receive thread only
+	void RunSharedMemory();
+	void RoutePacket(const uint8* Data, int32 Size, double ArrivalTime);
+	const FDeviceRoute* AddDevice();
 
 	// Livelink Identifiers
-	bool bIsInitialized = false;
 	ILiveLinkClient* LiveLinkClient;
 	FGuid LiveLinkSourceGuid;
 
 	// Livelink Source Parameters
 	FText SourceType;
 	FText SourceMachineName;
-	FText SourceStatus;
 
-	// Spatial Data
-	kh::FSpatialDataDeserializer SpatialData;
+	FSCTLiveLinkSourceSettings Settings;
+	int32 MaxWorkers;
+	FDelegateHandle BeginFrameHandle;
+
+	// Network
+	FSocket* Socket;
+	ISocketSubsystem* SocketSubsystem;
+	FRunnableThread* Thread;
+	FThreadSafeBool bStopping;
+	TArray<uint8> ReceiveBuffer;
+
+	// Shared memory
+	FPlatformMemory::FSharedMemoryRegion* SharedMemoryRegion;
+	TUniquePtr<kh::FSpscByteRing> SharedMemoryRing;
+	TMap<uint32, kh::FLiveDevice*> SharedMemoryStreams;
+
+	// Receive thread only
+	TSharedPtr<FInternetAddr> Sender;
+	TArray<FDeviceRoute> Routes;
+	int32 LastRoute;
+
+	TUniquePtr<kh::FLiveRecorder> Recorder;
+
+	// Workers are created as devices appear and live until shutdown
+	TArray<TUniquePtr<kh::FLiveDeviceWorker>> Workers;
+
+	// Only taken when a device is added and when the status is read
+	mutable FCriticalSection DevicesLock;
+	TArray<TUniquePtr<kh::FLiveDevice>> Devices;
 };
@@ -0,0 +1,64 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace kh
+{
+	/** Playout timing of live streams, see FLiveJitterBuffer */
+	struct FLiveTimingSettings
+	{
+		// When disabled frames are published on arrival, still stamped with their mapped device time
+		bool bUseJitterBuffer = true;
+		double MinDelay = 0.0;
+		double MaxDelay = 0.25;
+		// Playout delay as a multiple of the smoothed jitter
+		double JitterMultiplier = 3.0;
+	};
+
+	enum class EPosePredictionModel : uint8
+	{
+		// Extrapolate the velocity between the last two frames
+		ConstantVelocity,
+		// Steady state Kalman (alpha-beta) filter on position and rotation, smoother under measurement noise
+		AlphaBeta
+	};
+
+	/** Latency hiding of live streams, see FSubjectPredictor */
+	struct FPosePredictionSettings
+	{
+		bool bEnabled = false;
+		bool bPredictJoints = false;
+		EPosePredictionModel Model = EPosePredictionModel::AlphaBeta;
+		// Latency not visible to the source, e.g. device processing and rendering. Added to the measured buffer and transit delay
+		double AdditionalLatency = 0.0;
+		// Predictions never reach further than this
+		double MaxHorizon = 0.15;
+		// Velocities are discarded after a gap this long
+		double MaxGap = 0.25;
+		float Alpha = 0.5f;
+		float Beta = 0.1f;
+	};
+}
@@ -0,0 +1,52 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SCTPlaybackBenchmarkCommandlet.generated.h"
+
+/**
+ * Runs the replay actors end to end in a headless game world: replay camera and skeleton pawns playing synthetic
+ * captures and geometry replay actors streaming synthetic meshes, ticked at a fixed rate for a simulated duration.
+ * Reports game thread time per frame, frames decoded per second, allocations per frame and memory.
+ *
+ * UE4Editor-Cmd Project.uproject -run=SCTPlaybackBenchmark -nullrhi [-Cameras=8] [-Skeletons=8] [-Geometry=1] [-Duration=60]
+ *     [-FrameRate=60] [-Warmup=60] [-CaptureFrames=3600] [-Joints=21] [-MeshParts=4] [-MeshVertices=10000] [-MeshInterval=30] [-Seed=1]
+ *     [-Output=File.json] [-Baseline=File.json] [-Tolerance=0.1] [-UpdateBaseline]
+ *
+ * Results are written as JSON. Given a baseline recorded with the same arguments, a frame time, allocation count or
+ * memory use higher than the tolerance is reported as a regression and the commandlet fails.
+ * Baselines are kept per platform in Plugins/SCT/Benchmarks
+ */
+UCLASS()
+class USCTPlaybackBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USCTPlaybackBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
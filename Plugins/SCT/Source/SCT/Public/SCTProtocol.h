@@ -0,0 +1,110 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SCTSerializeFromBuffer.h"
+#include "sct/Protocol.h"
+
+struct FSCTSkeletonDefinition;
+
+namespace kh
+{
+	/** Protocol version written by the current SCT app. See Protocol.md */
+	static constexpr int32 SpatialProtocolVersion = sct::ProtocolVersion;
+	/** Oldest version captures can still be imported and played from, see "Version History" in Protocol.md */
+	static constexpr int32 OldestSpatialProtocolVersion = sct::OldestProtocolVersion;
+
+	struct FCameraFrameMetaData;
+
+	/** Capture Type values found in the header */
+	enum class ECaptureType : int32
+	{
+		Skeleton = 0,
+		Camera = 1
+	};
+
+	struct FSpatialHeader
+	{
+		int32 Version;
+		int32 FrameCount;
+		int32 DeviceOrientation;
+		float HorizontalFOV;
+		float VerticalFOV;
+		float FocalLengthX;
+		float FocalLengthY;
+		int CaptureType;
+	};
+
+	/** Encoded frame sizes in bytes, frames have a fixed size for a given joint count */
+	static constexpr int32 CameraFrameSize = sct::CameraFrameSize;
+	static constexpr int32 SkeletonJointSize = sct::SkeletonJointSize;
+	static constexpr int32 GetSkeletonFrameSize(int32 JointCount) { return 4 + JointCount * SkeletonJointSize; }
+
+	/** Live streaming, see "Live Streaming" in Protocol.md */
+	static constexpr int32 LiveDefaultPort = 7700;
+	static constexpr int32 LiveMaxPacketSize = 65507;
+	static constexpr int32 LiveSequenceRestartWindow = 1024;
+
+	enum class ELivePacketType : uint8
+	{
+		Header = 0,
+		CameraFrame = 1,
+		SkeletonFrame = 2,
+		CompactFrame = 3,
+		// Sent by the receiver back to the device
+		Ack = 4
+	};
+
+	/**
+	 * Readers for the capture layout of one protocol version, into engine types. Readers look the decoder up once
+	 * from the header version and call through it for every frame, so frame loops never branch on the version.
+	 * The versions and layouts are SCTCore's, see sct::FindLayout. A format change adds an entry there and to the
+	 * table in SCTProtocol.cpp instead of touching the loops
+	 */
+	struct FProtocolDecoder
+	{
+		int32 Version;
+		int32 CameraFrameSize;
+		int32 SkeletonJointSize;
+
+		void (*ReadUserAnchors)(FMRSerializeFromBuffer& FromBuffer, TArray<FVector>& UserAnchors);
+		void (*ReadSkeletonDefinition)(FMRSerializeFromBuffer& FromBuffer, FSCTSkeletonDefinition& SkeletonDefinition);
+		void (*ReadCameraFrame)(FMRSerializeFromBuffer& FromBuffer, FTransform& OutTransform, FCameraFrameMetaData& OutMetaData);
+		void (*ReadSkeletonFrame)(FMRSerializeFromBuffer& FromBuffer, TArray<FTransform>& InOutTransforms);
+		void (*ReadMeshPart)(FMRSerializeFromBuffer& FromBuffer, TArray<FVector>& OutVertices, TArray<int32>& OutIndices);
+
+		int32 GetSkeletonFrameSize(int32 JointCount) const { return 4 + JointCount * SkeletonJointSize; }
+		int32 GetFrameSize(bool bSkeleton, int32 JointCount) const { return (bSkeleton ? GetSkeletonFrameSize(JointCount) : 0) + CameraFrameSize; }
+	};
+
+	/** The decoder for a protocol version, nullptr for versions this plugin can't read */
+	SCT_API const FProtocolDecoder* FindProtocolDecoder(int32 Version);
+	/** The decoder for SpatialProtocolVersion */
+	SCT_API const FProtocolDecoder& GetCurrentProtocolDecoder();
+
+	SCT_API void ReadHeaderFromBuffer(FMRSerializeFromBuffer& FromBuffer, FSpatialHeader& Header);
+	SCT_API void ReadUserAnchorsFromBuffer(FMRSerializeFromBuffer& FromBuffer, TArray<FVector>& UserAnchors);
+	SCT_API void ReadSkeletonDefinitionFromBuffer(FMRSerializeFromBuffer& FromBuffer, FSCTSkeletonDefinition& SkeletonDefinition);
+}
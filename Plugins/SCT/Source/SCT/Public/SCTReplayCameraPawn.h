@@ -26,6 +26,7 @@ SOFTWARE.
 #include "CoreMinimal.h"
 #include "GameFramework/Pawn.h"
 #include "SpatialDataDeserializer.h"
+#include "SCTCaptureFileTail.h"
 #include "SCTSpatialCameraAsset.h"
 
 #include "SCTReplayCameraPawn.generated.h"
@@ -39,6 +40,7 @@ public:
 	ASCTReplayCameraPawn();
 	virtual void Tick(float DeltaTime) override;
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
 
 	UPROPERTY(EditAnywhere, Category = "Spatial Settings")
 	USCTSpatialCameraAsset* CameraDataAsset;
@@ -46,6 +48,10 @@ public:
 	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Spatial Settings")
 	bool bLoop = false;
 
+	/** Used when no asset is set. Follows a capture that is still being written and plays frames as they are appended */
+	UPROPERTY(EditAnywhere, Category = "Spatial Settings", meta = (FilePathFilter = "dat", AbsolutePath))
+	FFilePath TailFilePath;
+
 	UFUNCTION(BlueprintCallable, Category = Logic)
 	void Start();
 
@@ -54,5 +60,6 @@ protected:
 
 private:
 	kh::FSpatialDataDeserializer SpatialData;
+	TUniquePtr<kh::FCaptureFileTail> Tail;
 	bool bRunning = false;
 };
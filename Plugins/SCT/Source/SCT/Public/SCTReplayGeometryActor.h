@@ -38,6 +38,7 @@ class SCT_API ASCTReplayGeometryActor : public AActor
 public:	
 	ASCTReplayGeometryActor();
 	virtual void Tick(float DeltaTime) override;
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
 
 	UFUNCTION(BlueprintCallable, Category = Logic)
 	void Start();
@@ -0,0 +1,50 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SCTReplayServerCommandlet.generated.h"
+
+/**
+ * Streams recorded .dat captures to a live source as if they came from devices, for soak tests and for
+ * measuring ingest latency and throughput without hardware.
+ *
+ * UE4Editor-Cmd.exe Project.uproject -run=SCTReplayServer -Files=C:/Takes/a.dat,C:/Takes/b.dat [-Host=127.0.0.1] [-Port=7700]
+ *     [-Devices=8] [-Speed=1.0] [-Fast] [-Loop] [-Duration=60] [-Jitter=0.01] [-Loss=0.02] [-Compact] [-Name=Replay]
+ *
+ * Each simulated device sends from its own socket and plays the files round robin. Frames are paced by their
+ * recorded timestamps scaled by Speed, or sent as fast as possible with -Fast. Jitter delays every packet by a
+ * random amount up to the given seconds, which also reorders them, and Loss drops that fraction of frames
+ */
+UCLASS()
+class USCTReplayServerCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USCTReplayServerCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -24,46 +24,47 @@ SOFTWARE.
 #pragma once
 
 #include "CoreMinimal.h"
+#include "sct/ByteReader.h"
 
-MSVC_PRAGMA(warning(push))
-// Disable used without initialization warning because the reads are initializing
-MSVC_PRAGMA(warning(disable : 4700))
+namespace kh
+{
+	/** Converts a simd_float4x4 from Y up device space, in metres, to an Unreal space transform */
+	inline void ConvertDeviceMatrix(const float (&M)[4][4], FTransform& Transform)
+	{
+		FMatrix RawYUpFMatrix;
+		FMemory::Memcpy(RawYUpFMatrix.M, M, sizeof(RawYUpFMatrix.M));
+
+		// Extract & convert rotation
+		FQuat RawRotation(RawYUpFMatrix);
+		FQuat Rotation(-RawRotation.Z, RawRotation.X, RawRotation.Y, -RawRotation.W);
+
+		Transform.SetLocation(FVector(-RawYUpFMatrix.M[3][2], RawYUpFMatrix.M[3][0], RawYUpFMatrix.M[3][1]) * 100.0f);
+		Transform.SetRotation(Rotation);
+	}
+}
 
 /**
- * Class used to read data from a NBO data buffer
+ * Class used to read data from a NBO data buffer.
+ * Reading and bounds checking is done by sct::ByteReader from SCTCore, this adds the engine types
  */
 class FMRSerializeFromBuffer
 {
 protected:
-	/** Pointer to the data this reader is attached to */
-	uint8* Data;
-	/** The size of the data in bytes */
-	int32 NumBytes;
-	/** The current location in the byte stream for reading */
-	int32 CurrentOffset;
-	/** Indicates whether reading from the buffer caused an overflow or not */
-	bool bHasOverflowed;
-
+	sct::ByteReader Reader;
 
 public:
 	FMRSerializeFromBuffer(void)
-		: Data(nullptr)
-		, NumBytes(0)
-		, CurrentOffset(0)
-		, bHasOverflowed(false)
 	{
 	}
 
 	void Init(uint8* InData, int32 Length)
 	{
-		Data = InData;
-		NumBytes = Length;
+		Reader.Attach(InData, (size_t)Length);
 	}
 
 	void Reset()
 	{
-		CurrentOffset = 0;
-		bHasOverflowed = false;
+		Reader.Reset();
 	}
 
 	/**
@@ -73,133 +74,65 @@ public:
 	 * @param Length the size of the buffer we are attaching to
 	 */
 	FMRSerializeFromBuffer(uint8* InData, int32 Length) 
-		: Data(InData)
-		, NumBytes(Length)
-		, CurrentOffset(0)
-		, bHasOverflowed(false)
+		: Reader(InData, (size_t)Length)
 	{
 	}
 
-	/**
-	 * Reads a char from the buffer
-	 */
+	/** The engine independent reader, for the SCTCore parsers */
+	sct::ByteReader& GetReader() { return Reader; }
+
 	friend inline FMRSerializeFromBuffer& operator>>(FMRSerializeFromBuffer& Ar, char& Ch)
 	{
-		if (!Ar.HasOverflow() && Ar.CurrentOffset + 1 <= Ar.NumBytes)
-		{
-			Ch = Ar.Data[Ar.CurrentOffset++];
-		}
-		else
-		{
-			Ar.bHasOverflowed = true;
-		}
+		Ar.Reader >> Ch;
 		return Ar;
 	}
 
-	/**
-	 * Reads a byte from the buffer
-	 */
 	friend inline FMRSerializeFromBuffer& operator>>(FMRSerializeFromBuffer& Ar, uint8& B)
 	{
-		if (!Ar.HasOverflow() && Ar.CurrentOffset + 1 <= Ar.NumBytes)
-		{
-			B = Ar.Data[Ar.CurrentOffset++];
-		}
-		else
-		{
-			Ar.bHasOverflowed = true;
-		}
+		Ar.Reader >> B;
 		return Ar;
 	}
 
-	/**
-	 * Reads an int32 from the buffer
-	 */
 	friend inline FMRSerializeFromBuffer& operator>>(FMRSerializeFromBuffer& Ar, int32& I)
 	{
-		return Ar >> *(uint32*)&I;
-	}
-
-	template<typename T>
-	friend inline void readPod(FMRSerializeFromBuffer& Ar, T& val)
-	{
-		uint8_t* data = (uint8_t*)&val;
-		int64 size = sizeof(T);
-		FMemory::Memcpy(data, &Ar.Data[Ar.CurrentOffset], size);
+		Ar.Reader >> I;
+		return Ar;
 	}
 
-	/**
-	 * Reads a uint32 from the buffer
-	 */
 	friend inline FMRSerializeFromBuffer& operator>>(FMRSerializeFromBuffer& Ar, uint32& D)
 	{
-		if (!Ar.HasOverflow() && Ar.CurrentOffset + 4 <= Ar.NumBytes)
-		{
-			readPod<uint32>(Ar, D);
-			Ar.CurrentOffset += 4;
-		}
-		else
-		{
-			Ar.bHasOverflowed = true;
-		}
+		Ar.Reader >> D;
 		return Ar;
 	}
 
-	/**
-	 * Reads an int64 from the buffer
-	 */
 	friend inline FMRSerializeFromBuffer& operator>>(FMRSerializeFromBuffer& Ar, int64& I)
 	{
-		if (!Ar.HasOverflow() && Ar.CurrentOffset + 8 <= Ar.NumBytes)
-		{
-			readPod<int64>(Ar, I);
-			Ar.CurrentOffset += 8;
-		}
-		else
-		{
-			Ar.bHasOverflowed = true;
-		}
+		Ar.Reader >> I;
 		return Ar;
 	}
 
 	/**
-	 * Adds a uint64 to the buffer
+	 * Reads a big endian uint64 from the buffer
 	 */
 	friend inline FMRSerializeFromBuffer& operator>>(FMRSerializeFromBuffer& Ar, uint64& Q)
 	{
-		if (!Ar.HasOverflow() && Ar.CurrentOffset + 8 <= Ar.NumBytes)
-		{
-			Q = ((uint64)Ar.Data[Ar.CurrentOffset + 0] << 56) |
-				((uint64)Ar.Data[Ar.CurrentOffset + 1] << 48) |
-				((uint64)Ar.Data[Ar.CurrentOffset + 2] << 40) |
-				((uint64)Ar.Data[Ar.CurrentOffset + 3] << 32) |
-				((uint64)Ar.Data[Ar.CurrentOffset + 4] << 24) |
-				((uint64)Ar.Data[Ar.CurrentOffset + 5] << 16) |
-				((uint64)Ar.Data[Ar.CurrentOffset + 6] << 8) |
-				(uint64)Ar.Data[Ar.CurrentOffset + 7];
-			Ar.CurrentOffset += 8;
-		}
-		else
-		{
-			Ar.bHasOverflowed = true;
-		}
+		Ar.Reader >> Q;
 		return Ar;
 	}
 
-	/**
-	 * Reads a float from the buffer
-	 */
 	friend inline FMRSerializeFromBuffer& operator>>(FMRSerializeFromBuffer& Ar, float& F)
 	{
-		return Ar >> *(uint32*)&F;
+		Ar.Reader >> F;
+		return Ar;
 	}
 
 	/**
-	 * Reads a double from the buffer
+	 * Reads a big endian double from the buffer
 	 */
 	friend inline FMRSerializeFromBuffer& operator>>(FMRSerializeFromBuffer& Ar, double& Dbl)
 	{
-		return Ar >> *(uint64*)&Dbl;
+		Ar.Reader >> Dbl;
+		return Ar;
 	}
 
 	friend inline FMRSerializeFromBuffer& operator>>(FMRSerializeFromBuffer& Ar, FVector& Vec)
@@ -231,66 +164,37 @@ public:
 		return Ar;
 	}
 
+	/**
+	 * Reads a simd_float4x4 from the buffer and converts it from Y up device space to Unreal space
+	 */
 	friend inline FMRSerializeFromBuffer& operator>>(FMRSerializeFromBuffer& Ar, FTransform& Transform)
 	{
-		FPlane C0;
-		FPlane C1;
-		FPlane C2;
-		FPlane C3;
-
-		Ar >> C0;
-		Ar >> C1;
-		Ar >> C2;
-		Ar >> C3;
-
-		FMatrix RawYUpFMatrix(C0, C1, C2, C3);
-
-		// Extract & convert rotation
-		FQuat RawRotation(RawYUpFMatrix);
-		FQuat Rotation(-RawRotation.Z, RawRotation.X, RawRotation.Y, -RawRotation.W);
-
-		Transform.SetLocation(FVector(-RawYUpFMatrix.M[3][2], RawYUpFMatrix.M[3][0], RawYUpFMatrix.M[3][1]) * 100.0f);
-		Transform.SetRotation(Rotation);
-
+		float M[4][4];
+		if (Ar.Reader.ReadBytes(M, sizeof(M)))
+		{
+			kh::ConvertDeviceMatrix(M, Transform);
+		}
 		return Ar;
 	}
 
 	/**
-	 * Reads a FString from the buffer
+	 * Reads a length prefixed UTF-8 string from the buffer
 	 */
 	friend inline FMRSerializeFromBuffer& operator>>(FMRSerializeFromBuffer& Ar, FString& String)
 	{
-		// We send strings length prefixed
 		int32 Len = 0;
 		Ar >> Len;
 
-		// Check this way to trust NumBytes and CurrentOffset to be more accurate than the packet Len value
-		const bool bSizeOk = (Len >= 0) && (Len <= (Ar.NumBytes - Ar.CurrentOffset));
-		if (!Ar.HasOverflow() && bSizeOk)
+		// Check this way to trust the buffer size to be more accurate than the packet Len value
+		const uint8* Bytes = Len >= 0 ? Ar.Reader.Take((size_t)Len) : nullptr;
+		if (Bytes == nullptr)
 		{
-			// Handle strings of zero length
-			if (Len > 0)
-			{
-				char* Temp = (char*)FMemory_Alloca(Len + 1);
-				// memcpy it in from the buffer
-				FMemory::Memcpy(Temp, &Ar.Data[Ar.CurrentOffset], Len);
-				Temp[Len] = '\0';
-
-				FUTF8ToTCHAR Converted(Temp);
-				TCHAR* Ptr = (TCHAR*)Converted.Get();
-				String = Ptr;
-				Ar.CurrentOffset += Len;
-			}
-			else
-			{
-				String.Empty();
-			}
-		}
-		else
-		{
-			Ar.bHasOverflowed = true;
+			Ar.Reader.SetOverflow();
+			return Ar;
 		}
 
+		FUTF8ToTCHAR Converted((const ANSICHAR*)Bytes, Len);
+		String = FString(Converted.Length(), Converted.Get());
 		return Ar;
 	}
 
@@ -310,9 +214,9 @@ public:
 	 */
 	friend inline FMRSerializeFromBuffer& operator>>(FMRSerializeFromBuffer& Ar, TArray<uint8>& Array)
 	{
-		uint32 NumToRead = Ar.NumBytes - Ar.CurrentOffset;
+		const int32 NumToRead = Ar.AvailableToRead();
 		Array.AddUninitialized(NumToRead);
-		Ar.ReadBinary(Array.GetData(), NumToRead);
+		Ar.ReadBinary(Array.GetData() + Array.Num() - NumToRead, NumToRead);
 
 		return Ar;
 	}
@@ -325,15 +229,7 @@ public:
 	 */
 	void ReadBinary(uint8* OutBuffer, uint32 NumToRead)
 	{
-		if (!HasOverflow() && CurrentOffset + (int32)NumToRead <= NumBytes)
-		{
-			FMemory::Memcpy(OutBuffer, &Data[CurrentOffset], NumToRead);
-			CurrentOffset += NumToRead;
-		}
-		else
-		{
-			bHasOverflowed = true;
-		}
+		Reader.ReadBytes(OutBuffer, NumToRead);
 	}
 
 	/**
@@ -344,33 +240,25 @@ public:
 	void Seek(int32 Pos)
 	{
 		checkSlow(Pos >= 0);
-
-		if (!HasOverflow() && Pos < NumBytes)
-		{
-			CurrentOffset = Pos;
-		}
-		else
-		{
-			bHasOverflowed = true;
-		}
+		Reader.Seek(Pos);
 	}
 
 	/** @return Current position of the buffer being to be read */
 	inline int32 Tell(void) const
 	{
-		return CurrentOffset;
+		return (int32)Reader.Tell();
 	}
 
 	/** Returns whether the buffer had an overflow when reading from it */
 	inline bool HasOverflow(void) const
 	{
-		return bHasOverflowed;
+		return Reader.HasOverflow();
 	}
 
 	/** @return Number of bytes remaining to read from the current offset to the end of the buffer */
 	inline int32 AvailableToRead(void) const
 	{
-		return FMath::Max<int32>(0, NumBytes - CurrentOffset);
+		return (int32)Reader.Remaining();
 	}
 
 	/**
@@ -378,8 +266,6 @@ public:
 	 */
 	inline int32 GetBufferSize(void) const
 	{
-		return NumBytes;
+		return (int32)Reader.GetSize();
 	}
 };
-
-MSVC_PRAGMA(warning(pop))
\ No newline at end of file
@@ -25,6 +25,8 @@ SOFTWARE.
 
 #include "CoreMinimal.h"
 #include "Engine/DataAsset.h"
+#include "SCTCaptureTrim.h"
+#include "SCTDecodedCapture.h"
 #include "SCTSpatialCameraAsset.generated.h"
 
 /**
@@ -36,6 +38,24 @@ class SCT_API USCTSpatialCameraAsset : public UDataAsset
 	GENERATED_BODY()
 
 public:
+	virtual void PostInitProperties() override;
+	virtual void PostLoad() override;
+	virtual void Serialize(FArchive& Ar) override;
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+#if WITH_EDITORONLY_DATA
+	virtual void GetAssetRegistryTags(TArray<FAssetRegistryTag>& OutTags) const override;
+#endif
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+
+	/** Decodes the frames if bPreDecode is set, from the derived data cache when the same frames were decoded before */
+	void CacheDecodedCapture();
+#endif
+
+	/** Empty unless bPreDecode is set */
+	const FSCTDecodedCapture& GetDecodedCapture() const { return DecodedCapture; }
+	int32 GetJointCount() const;
+
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Header")
 	int32 Version;
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Header")
@@ -57,4 +77,21 @@ public:
 
 	UPROPERTY(EditDefaultsOnly, Category = "Data")
 	TArray<uint8> FrameData;
+
+	/** Decode every frame once when loaded instead of on every replay tick. Costs about as much memory again as the frame data */
+	UPROPERTY(EditAnywhere, Category = "Playback")
+	bool bPreDecode = false;
+
+#if WITH_EDITORONLY_DATA
+	/** The capture file this was imported from, for reimport */
+	UPROPERTY(VisibleAnywhere, Instanced, Category = "ImportSettings")
+	class UAssetImportData* AssetImportData;
+
+	/** The window of the source file that was imported and the rate it was resampled to. Change them and reimport to apply */
+	UPROPERTY(EditAnywhere, Category = "ImportSettings")
+	FSCTCaptureTrimSettings TrimSettings;
+#endif
+
+private:
+	FSCTDecodedCapture DecodedCapture;
 };
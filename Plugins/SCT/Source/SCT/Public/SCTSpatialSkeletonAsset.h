@@ -38,6 +38,22 @@ struct FSCTSkeletonDefinition
 	TArray<int32> ParentIndices;
 	UPROPERTY(EditDefaultsOnly, Category = "Data")
 	TArray<FTransform> NeutralTransforms;
+
+	SIZE_T GetAllocatedSize() const { return JointNames.GetAllocatedSize() + ParentIndices.GetAllocatedSize() + NeutralTransforms.GetAllocatedSize(); }
+
+	/** True if there is one parent per joint and every parent is -1 or an existing joint */
+	bool HasValidHierarchy() const
+	{
+		if (ParentIndices.Num() != JointNames.Num())
+			return false;
+
+		for (int32 ParentIdx : ParentIndices)
+		{
+			if (ParentIdx < -1 || ParentIdx >= JointNames.Num())
+				return false;
+		}
+		return true;
+	}
 };
 
 /**
@@ -49,6 +65,7 @@ class SCT_API USCTSpatialSkeletonAsset : public USCTSpatialCameraAsset
 	GENERATED_BODY()
 
 public:
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
 
 	UPROPERTY(EditDefaultsOnly, Category = "Data")
 	FSCTSkeletonDefinition SkeletonDefinition;
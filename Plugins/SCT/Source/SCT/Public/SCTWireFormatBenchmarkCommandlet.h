@@ -0,0 +1,47 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SCTWireFormatBenchmarkCommandlet.generated.h"
+
+/**
+ * Compares the compact live wire format with the recorded frame format: bytes per frame, encode and decode cost,
+ * and the error introduced by quantization.
+ *
+ * UE4Editor-Cmd.exe Project.uproject -run=SCTWireFormatBenchmark [-Capture=/Game/Path/Asset] [-Frames=3600] [-KeyframeInterval=60] [-Loss=0.05]
+ *
+ * Without a capture a synthetic body skeleton is animated
+ */
+UCLASS()
+class USCTWireFormatBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USCTWireFormatBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
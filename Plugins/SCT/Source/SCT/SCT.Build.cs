@@ -28,6 +28,7 @@ public class SCT : ModuleRules
 				"Core",
                 "LiveLinkInterface",
                 "ProceduralMeshComponent",
+				"SCTCore",
 				// ... add other public dependencies that you statically link with here ...
 			}
             );
@@ -38,11 +39,20 @@ public class SCT : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
+				"Json",
+				"Networking",
+				"Sockets",
 				"Slate",
 				"SlateCore",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
+
+		if (Target.bBuildEditor)
+		{
+			// Decoded captures are cached in the derived data cache
+			PrivateDependencyModuleNames.Add("DerivedDataCache");
+		}
 		
 		
 		DynamicallyLoadedModuleNames.AddRange(
@@ -0,0 +1,157 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTCaptureFactory.h"
+#include "SCTCaptureImport.h"
+#include "SCTSpatialCameraAsset.h"
+#include "SCTSpatialSkeletonAsset.h"
+
+#include "Editor.h"
+#include "EditorFramework/AssetImportData.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Subsystems/ImportSubsystem.h"
+
+#define LOCTEXT_NAMESPACE "FSCTEditorModule"
+DEFINE_LOG_CATEGORY_STATIC(SCTCaptureFactory, Log, All);
+
+USCTCaptureFactory::USCTCaptureFactory()
+{
+	SupportedClass = USCTSpatialCameraAsset::StaticClass();
+	Formats.Add(TEXT("dat;SCT Capture"));
+	bCreateNew = false;
+	bEditorImport = true;
+	bText = false;
+}
+
+bool USCTCaptureFactory::FactoryCanImport(const FString& Filename)
+{
+	// Other tools use .dat too, and so do the SCT environment and geometry streams. Only take files with a capture header
+	TUniquePtr<IFileHandle> File(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Filename));
+	if (File.IsValid() == false)
+		return false;
+
+	int32 Header[8];
+	if (File->Read((uint8*)Header, sizeof(Header)) == false)
+		return false;
+
+	const int32 Version = Header[0];
+	const int32 CaptureType = Header[7];
+	return kh::FindProtocolDecoder(Version) != nullptr && (CaptureType == (int32)kh::ECaptureType::Camera || CaptureType == (int32)kh::ECaptureType::Skeleton);
+}
+
+UObject* USCTCaptureFactory::FactoryCreateFile(UClass* InClass, UObject* InParent, FName InName, EObjectFlags Flags, const FString& Filename, const TCHAR* Parms, FFeedbackContext* Warn, bool& bOutOperationCanceled)
+{
+	GEditor->GetEditorSubsystem<UImportSubsystem>()->BroadcastAssetPreImport(this, InClass, InParent, InName, TEXT("dat"));
+
+	kh::FParsedCapture Capture;
+	Capture.TrimSettings = TrimSettings;
+	if (kh::LoadCaptureWithProgress(Filename, Capture) == false)
+	{
+		bOutOperationCanceled = true;
+		GEditor->GetEditorSubsystem<UImportSubsystem>()->BroadcastAssetPostImport(this, nullptr);
+		return nullptr;
+	}
+
+	if (Capture.IsValid() == false)
+	{
+		Warn->Logf(ELogVerbosity::Error, TEXT("[SCT Import] %s: %s"), *Filename, *Capture.Error);
+		GEditor->GetEditorSubsystem<UImportSubsystem>()->BroadcastAssetPostImport(this, nullptr);
+		return nullptr;
+	}
+
+	for (const FString& Warning : Capture.Warnings)
+	{
+		Warn->Logf(ELogVerbosity::Warning, TEXT("[SCT Import] %s: %s"), *Filename, *Warning);
+	}
+
+	USCTSpatialCameraAsset* Asset = NewObject<USCTSpatialCameraAsset>(InParent, kh::GetCaptureAssetClass(Capture), InName, Flags);
+	kh::PopulateCaptureAsset(Asset, MoveTemp(Capture));
+
+	GEditor->GetEditorSubsystem<UImportSubsystem>()->BroadcastAssetPostImport(this, Asset);
+	return Asset;
+}
+
+bool USCTCaptureFactory::CanReimport(UObject* Obj, TArray<FString>& OutFilenames)
+{
+	USCTSpatialCameraAsset* Asset = Cast<USCTSpatialCameraAsset>(Obj);
+	if (Asset == nullptr || Asset->AssetImportData == nullptr)
+		return false;
+
+	Asset->AssetImportData->ExtractFilenames(OutFilenames);
+	return OutFilenames.Num() > 0 && OutFilenames[0].IsEmpty() == false;
+}
+
+void USCTCaptureFactory::SetReimportPaths(UObject* Obj, const TArray<FString>& NewReimportPaths)
+{
+	USCTSpatialCameraAsset* Asset = Cast<USCTSpatialCameraAsset>(Obj);
+	if (Asset && Asset->AssetImportData && ensure(NewReimportPaths.Num() == 1))
+	{
+		Asset->AssetImportData->UpdateFilenameOnly(NewReimportPaths[0]);
+	}
+}
+
+EReimportResult::Type USCTCaptureFactory::Reimport(UObject* Obj)
+{
+	USCTSpatialCameraAsset* Asset = Cast<USCTSpatialCameraAsset>(Obj);
+	if (Asset == nullptr || Asset->AssetImportData == nullptr)
+		return EReimportResult::Failed;
+
+	const FString Filename = Asset->AssetImportData->GetFirstFilename();
+	if (Filename.IsEmpty() || FPaths::FileExists(Filename) == false)
+	{
+		UE_LOG(SCTCaptureFactory, Error, TEXT("[SCT Import] Can't reimport %s, the source file %s is missing"), *Asset->GetPathName(), *Filename);
+		return EReimportResult::Failed;
+	}
+
+	kh::FParsedCapture Capture;
+	Capture.TrimSettings = Asset->TrimSettings;
+	if (kh::LoadCaptureWithProgress(Filename, Capture) == false)
+		return EReimportResult::Cancelled;
+
+	// The asset class can't change in place, a camera capture can't replace a skeleton asset or the other way around
+	if (Capture.IsValid() && kh::GetCaptureAssetClass(Capture) != Asset->GetClass())
+	{
+		Capture.Error = Capture.IsSkeleton() ? TEXT("The file is now a skeleton capture, import it as a new asset") : TEXT("The file is now a camera capture, import it as a new asset");
+	}
+
+	if (Capture.IsValid() == false)
+	{
+		UE_LOG(SCTCaptureFactory, Error, TEXT("[SCT Import] Can't reimport %s from %s: %s"), *Asset->GetPathName(), *Filename, *Capture.Error);
+		return EReimportResult::Failed;
+	}
+
+	// Transacted so the swap can be undone, and open editors refresh
+	Asset->Modify();
+	kh::PopulateCaptureAsset(Asset, MoveTemp(Capture));
+	Asset->PostEditChange();
+	Asset->MarkPackageDirty();
+	UE_LOG(SCTCaptureFactory, Display, TEXT("[SCT Import] Reimported %s from %s, %d frames"), *Asset->GetPathName(), *Filename, Asset->FrameCount);
+	return EReimportResult::Succeeded;
+}
+
+int32 USCTCaptureFactory::GetPriority() const
+{
+	return ImportPriority;
+}
+
+#undef LOCTEXT_NAMESPACE
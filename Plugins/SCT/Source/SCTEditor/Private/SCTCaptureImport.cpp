@@ -0,0 +1,248 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTCaptureImport.h"
+#include "SCTSerializeFromBuffer.h"
+#include "SCTSpatialCameraAsset.h"
+
+#include "AssetRegistryModule.h"
+#include "Async/Async.h"
+#include "EditorFramework/AssetImportData.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/PackageName.h"
+#include "Misc/ScopedSlowTask.h"
+#include "UObject/Package.h"
+
+#define LOCTEXT_NAMESPACE "FSCTEditorModule"
+
+DEFINE_LOG_CATEGORY_STATIC(SCTCaptureImport, Log, All);
+
+// Files are read in blocks of this size, so progress can be shown and the read cancelled
+static constexpr int64 ReadBlockSize = 16 * 1024 * 1024;
+
+namespace kh
+{
+	// Recordings cut off before they were closed can claim fewer frames than they hold, and end in a partial frame
+	static void FixupFrameCount(FParsedCapture& Capture, int32 FrameSize)
+	{
+		const int32 FramesInData = Capture.FrameData.Num() / FrameSize;
+		if (Capture.Header.FrameCount != FramesInData)
+		{
+			Capture.Warnings.Add(FString::Printf(TEXT("Header claims %d frames, the file holds %d. Using %d"), Capture.Header.FrameCount, FramesInData, FramesInData));
+			Capture.Header.FrameCount = FramesInData;
+		}
+
+		Capture.FrameData.SetNum(FramesInData * FrameSize, false);
+	}
+
+	void ParseCapture(TArray<uint8>&& FileBuffer, FParsedCapture& OutCapture)
+	{
+		FMRSerializeFromBuffer FromBuffer;
+		FromBuffer.Init(FileBuffer.GetData(), FileBuffer.Num());
+
+		ReadHeaderFromBuffer(FromBuffer, OutCapture.Header);
+		if (FromBuffer.HasOverflow())
+		{
+			OutCapture.Error = TEXT("File is too short for a capture header");
+			return;
+		}
+
+		// Older captures keep their layout, the assets are played back with the decoder for their version
+		const FProtocolDecoder* Decoder = FindProtocolDecoder(OutCapture.Header.Version);
+		if (Decoder == nullptr)
+		{
+			OutCapture.Error = FString::Printf(TEXT("Unsupported version %d, this plugin reads versions %d to %d. Make sure your plugin and App versions match"), OutCapture.Header.Version, OldestSpatialProtocolVersion, SpatialProtocolVersion);
+			return;
+		}
+
+		Decoder->ReadUserAnchors(FromBuffer, OutCapture.UserAnchors);
+
+		int32 FrameSize = Decoder->CameraFrameSize;
+		if (OutCapture.IsSkeleton())
+		{
+			Decoder->ReadSkeletonDefinition(FromBuffer, OutCapture.SkeletonDefinition);
+			FrameSize += Decoder->GetSkeletonFrameSize(OutCapture.SkeletonDefinition.JointNames.Num());
+		}
+
+		if (FromBuffer.HasOverflow())
+		{
+			OutCapture.Error = TEXT("File ends before the first frame");
+			return;
+		}
+
+		// The frames are the rest of the file, shift them down in place
+		const int32 FrameStart = FromBuffer.Tell();
+		OutCapture.FrameData = MoveTemp(FileBuffer);
+		OutCapture.FrameData.RemoveAt(0, FrameStart, false);
+		FixupFrameCount(OutCapture, FrameSize);
+
+		for (const FString& Warning : OutCapture.Warnings)
+		{
+			UE_LOG(SCTCaptureImport, Warning, TEXT("[SCT Import] %s%s"), *(OutCapture.SourceFile.IsEmpty() ? FString() : OutCapture.SourceFile + TEXT(": ")), *Warning);
+		}
+
+		if (OutCapture.TrimSettings.IsSet())
+		{
+			const int32 FramesBefore = OutCapture.Header.FrameCount;
+			if (TrimCaptureFrames(OutCapture.TrimSettings, OutCapture.Header.Version, OutCapture.IsSkeleton(), OutCapture.SkeletonDefinition.JointNames.Num(), OutCapture.FrameData, OutCapture.Header.FrameCount, OutCapture.Error) == false)
+				return;
+
+			UE_LOG(SCTCaptureImport, Display, TEXT("[SCT Import] %s%d frames trimmed to %d"), *(OutCapture.SourceFile.IsEmpty() ? FString() : OutCapture.SourceFile + TEXT(": ")), FramesBefore, OutCapture.Header.FrameCount);
+		}
+	}
+
+	void LoadCapture(const FString& FilePath, FParsedCapture& OutCapture, FCaptureLoadProgress* Progress)
+	{
+		OutCapture.SourceFile = FilePath;
+
+		TUniquePtr<IFileHandle> File(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*FilePath));
+		if (File.IsValid() == false)
+		{
+			OutCapture.Error = TEXT("Could not open the file");
+			return;
+		}
+
+		const int64 Size = File->Size();
+		if (Size > MAX_int32)
+		{
+			OutCapture.Error = FString::Printf(TEXT("The file is %lld bytes, captures over 2 GB can't be held in an asset"), Size);
+			return;
+		}
+
+		if (Progress)
+		{
+			Progress->TotalBytes.Set(Size);
+		}
+
+		TArray<uint8> FileBuffer;
+		FileBuffer.SetNumUninitialized((int32)Size);
+		for (int64 Offset = 0; Offset < Size; Offset += ReadBlockSize)
+		{
+			if (Progress && Progress->bCancel)
+			{
+				OutCapture.Error = TEXT("Cancelled");
+				return;
+			}
+
+			const int64 BlockSize = FMath::Min(ReadBlockSize, Size - Offset);
+			if (File->Read(FileBuffer.GetData() + Offset, BlockSize) == false)
+			{
+				OutCapture.Error = TEXT("Could not read the file");
+				return;
+			}
+
+			if (Progress)
+			{
+				Progress->BytesRead.Add(BlockSize);
+			}
+		}
+
+		ParseCapture(MoveTemp(FileBuffer), OutCapture);
+	}
+
+	bool LoadCaptureWithProgress(const FString& FilePath, FParsedCapture& OutCapture)
+	{
+		check(IsInGameThread());
+
+		FScopedSlowTask SlowTask(1.0f, FText::Format(LOCTEXT("LoadingCapture", "Importing {0}"), FText::FromString(FPaths::GetCleanFilename(FilePath))));
+		SlowTask.MakeDialog(true);
+
+		FCaptureLoadProgress Progress;
+		TFuture<void> Loaded = Async(EAsyncExecution::ThreadPool, [&FilePath, &OutCapture, &Progress]()
+		{
+			LoadCapture(FilePath, OutCapture, &Progress);
+		});
+
+		float Reported = 0.0f;
+		while (Loaded.WaitFor(FTimespan::FromMilliseconds(50.0)) == false)
+		{
+			if (SlowTask.ShouldCancel())
+			{
+				Progress.bCancel = true;
+			}
+
+			const float Fraction = Progress.GetFraction();
+			SlowTask.EnterProgressFrame(Fraction - Reported);
+			Reported = Fraction;
+		}
+
+		return Progress.bCancel == false;
+	}
+
+	UClass* GetCaptureAssetClass(const FParsedCapture& Capture)
+	{
+		return Capture.IsSkeleton() ? USCTSpatialSkeletonAsset::StaticClass() : USCTSpatialCameraAsset::StaticClass();
+	}
+
+	void PopulateCaptureAsset(USCTSpatialCameraAsset* Asset, FParsedCapture&& Capture)
+	{
+		check(IsInGameThread());
+
+		Asset->Version = Capture.Header.Version;
+		Asset->FrameCount = Capture.Header.FrameCount;
+		Asset->DeviceOrientation = Capture.Header.DeviceOrientation;
+		Asset->HorizontalFOV = Capture.Header.HorizontalFOV;
+		Asset->VerticalFOV = Capture.Header.VerticalFOV;
+		Asset->FocalLengthX = Capture.Header.FocalLengthX;
+		Asset->FocalLengthY = Capture.Header.FocalLengthY;
+		Asset->CaptureType = Capture.Header.CaptureType;
+
+		Asset->UserAnchors = MoveTemp(Capture.UserAnchors);
+		Asset->FrameData = MoveTemp(Capture.FrameData);
+		Asset->TrimSettings = Capture.TrimSettings;
+
+		if (USCTSpatialSkeletonAsset* SkeletonAsset = Cast<USCTSpatialSkeletonAsset>(Asset))
+		{
+			SkeletonAsset->SkeletonDefinition = MoveTemp(Capture.SkeletonDefinition);
+		}
+
+		if (Capture.SourceFile.IsEmpty() == false)
+		{
+			Asset->AssetImportData->Update(Capture.SourceFile);
+		}
+
+		// A reimport keeps bPreDecode, the decoded frames are refreshed from the new data
+		Asset->CacheDecodedCapture();
+	}
+
+	USCTSpatialCameraAsset* SaveCaptureAsset(const FString& PackageName, FParsedCapture&& Capture)
+	{
+		const FString ShortName = FPackageName::GetShortName(PackageName);
+		const FString FileName = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
+
+		UPackage* Package = CreatePackage(nullptr, *PackageName);
+		USCTSpatialCameraAsset* Asset = NewObject<USCTSpatialCameraAsset>(Package, GetCaptureAssetClass(Capture), *ShortName, EObjectFlags::RF_Public | EObjectFlags::RF_Standalone);
+		PopulateCaptureAsset(Asset, MoveTemp(Capture));
+
+		FAssetRegistryModule::AssetCreated(Asset);
+		Asset->MarkPackageDirty();
+		if (UPackage::SavePackage(Package, Asset, EObjectFlags::RF_Public | EObjectFlags::RF_Standalone, *FileName) == false)
+		{
+			UE_LOG(SCTCaptureImport, Error, TEXT("[SCT Import] Could not save %s"), *FileName);
+			return nullptr;
+		}
+		return Asset;
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,90 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "SCTCaptureTrim.h"
+#include "SCTProtocol.h"
+#include "SCTSpatialSkeletonAsset.h"
+
+class USCTSpatialCameraAsset;
+
+namespace kh
+{
+	/** A capture file read and parsed, everything needed to fill an asset. Built off the game thread */
+	struct FParsedCapture
+	{
+		FString SourceFile;
+		FSpatialHeader Header;
+		TArray<FVector> UserAnchors;
+		FSCTSkeletonDefinition SkeletonDefinition;
+		TArray<uint8> FrameData;
+		// Applied by ParseCapture, and kept on the asset so a reimport cuts the same window
+		FSCTCaptureTrimSettings TrimSettings;
+
+		// Problems that were worked around, and why the capture can't be imported if Error is set
+		TArray<FString> Warnings;
+		FString Error;
+
+		bool IsValid() const { return Error.IsEmpty(); }
+		bool IsSkeleton() const { return Header.CaptureType == (int32)ECaptureType::Skeleton; }
+	};
+
+	/**
+	 * Parses a capture, taking over FileBuffer as the frame data so large takes aren't copied, then trims and
+	 * resamples the frames as OutCapture.TrimSettings asks. Touches no UObjects, so it can run on any thread
+	 */
+	void ParseCapture(TArray<uint8>&& FileBuffer, FParsedCapture& OutCapture);
+
+	/** Shared between a thread loading a capture and the one showing its progress */
+	struct FCaptureLoadProgress
+	{
+		FThreadSafeCounter64 BytesRead;
+		FThreadSafeCounter64 TotalBytes;
+		FThreadSafeBool bCancel;
+
+		float GetFraction() const { return TotalBytes.GetValue() > 0 ? (float)((double)BytesRead.GetValue() / TotalBytes.GetValue()) : 0.0f; }
+	};
+
+	/** Reads and parses a capture file, see ParseCapture. Reports progress and stops early if asked to through Progress */
+	void LoadCapture(const FString& FilePath, FParsedCapture& OutCapture, FCaptureLoadProgress* Progress = nullptr);
+
+	/**
+	 * Loads a capture on the thread pool while showing a cancellable progress dialog. Game thread only
+	 *
+	 * @return false if the user cancelled
+	 */
+	bool LoadCaptureWithProgress(const FString& FilePath, FParsedCapture& OutCapture);
+
+	/** The asset class a capture imports to */
+	UClass* GetCaptureAssetClass(const FParsedCapture& Capture);
+
+	/** Fills an asset of GetCaptureAssetClass, moving the frame data out of the capture, and records the source file. Game thread only */
+	void PopulateCaptureAsset(USCTSpatialCameraAsset* Asset, FParsedCapture&& Capture);
+
+	/** Creates the asset in a new package named PackageName, like /Game/Captures/Take1, and saves it. Game thread only */
+	USCTSpatialCameraAsset* SaveCaptureAsset(const FString& PackageName, FParsedCapture&& Capture);
+}
@@ -22,17 +22,15 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #include "SCTEditorBlueprintLibrary.h"
+#include "SCTCaptureImport.h"
 
 #include "SCTSerializeFromBuffer.h"
-#include "SCTSpatialCameraAsset.h"
-#include "SCTSpatialSkeletonAsset.h"
 #include "EditorLevelLibrary.h"
 #include "Engine/BoxReflectionCapture.h"
 
 #include "DesktopPlatform/Public/IDesktopPlatform.h"
 #include "DesktopPlatform/Public/DesktopPlatformModule.h"
 
-#include "AssetRegistryModule.h"
 #include "Misc/PackageName.h"
 
 DEFINE_LOG_CATEGORY_STATIC(SCTEditorBlueprintLibrary, Log, All);
@@ -96,187 +94,69 @@ void USCTEditorBlueprintLibrary::ImportEnvironmentProbes()
 
 void USCTEditorBlueprintLibrary::ImportSpatialCamera()
 {
-	TArray<uint8> FileBuffer;
-	{
-		const FString Title = TEXT("Import Spatial Camera");
-		const FString FileTypes = TEXT("SCT Data (*.dat)|*.dat");
-		ReadFileWithDialog(Title, FileTypes, "capture.dat", FileBuffer);
-	}
-
-	if (FileBuffer.Num() == 0)
-		return;
-
-	FMRSerializeFromBuffer FromBuffer;
-	FromBuffer.Init(FileBuffer.GetData(), FileBuffer.Num());
-
-	// Header
-	FSpatialHeader Header;
-	ReadHeaderFromBuffer(FromBuffer, Header);
-
-	// User Anchors
-	TArray<FVector> UserAnchors;
-	ReadUserAnchorsFromBuffer(FromBuffer, UserAnchors);
-
-	// Frame Data
-	TArray<uint8> FrameData;
-	FromBuffer >> FrameData;
-	UE_LOG(SCTEditorBlueprintLibrary, Display, TEXT("[SCT Editor Blueprint] Read frame data: %d"), FrameData.Num());
-
-	FString AssetFileName = "";
-	{
-		const FString Title = TEXT("Save Spatial Camera Asset");
-		const FString FileTypes = TEXT("Data Asset (*.uasset)|*.uasset");
-		if (ChooseSaveLocationWithDialog(Title, FileTypes, "Capture.uasset", AssetFileName) == false)
-			return;
-	}
-
-	// Create Data Asset
-	FString PackageName  = FPackageName::FilenameToLongPackageName(AssetFileName);
-	FString ShortName = FPackageName::GetShortName(PackageName);
-	UPackage* Package = CreatePackage(nullptr, *PackageName);
-	USCTSpatialCameraAsset* Asset = NewObject<USCTSpatialCameraAsset>(Package, USCTSpatialCameraAsset::StaticClass(), *ShortName, EObjectFlags::RF_Public | EObjectFlags::RF_Standalone);
-
-	PopulateSpatialCameraAsset(Asset, Header, UserAnchors, FrameData);
-
-	FAssetRegistryModule::AssetCreated(Asset);
-	Asset->MarkPackageDirty();
-	UPackage::SavePackage(Package, Asset, EObjectFlags::RF_Public | EObjectFlags::RF_Standalone, *AssetFileName);
+	ImportCaptureWithDialog(TEXT("Spatial Camera"), TEXT("Capture.uasset"), false);
 }
 
 void USCTEditorBlueprintLibrary::ImportSpatialSkeleton()
 {
-	TArray<uint8> FileBuffer;
+	ImportCaptureWithDialog(TEXT("Spatial Skeleton"), TEXT("SkeletonCapture.uasset"), true);
+}
+
+void USCTEditorBlueprintLibrary::ImportCaptureWithDialog(const FString& TypeName, const FString& DefaultAssetName, bool bSkeleton)
+{
+	FString FileName;
 	{
-		const FString Title = TEXT("Import Spatial Skeleton");
+		const FString Title = TEXT("Import ") + TypeName;
 		const FString FileTypes = TEXT("SCT Data (*.dat)|*.dat");
-		ReadFileWithDialog(Title, FileTypes, "capture.dat", FileBuffer);
+		if (ChooseFileWithDialog(Title, FileTypes, "capture.dat", FileName) == false)
+			return;
 	}
 
-	if (FileBuffer.Num() == 0)
+	kh::FParsedCapture Capture;
+	if (kh::LoadCaptureWithProgress(FileName, Capture) == false)
 		return;
 
-	FMRSerializeFromBuffer FromBuffer;
-	FromBuffer.Init(FileBuffer.GetData(), FileBuffer.Num());
-
-	// Header
-	FSpatialHeader Header;
-	ReadHeaderFromBuffer(FromBuffer, Header);
-
-	// User Anchors
-	TArray<FVector> UserAnchors;
-	ReadUserAnchorsFromBuffer(FromBuffer, UserAnchors);
-
-	// Skeleton Definition
-	FSCTSkeletonDefinition SkeletonDefinition;
-	ReadSkeletonDefinitionFromBuffer(FromBuffer, SkeletonDefinition);
+	if (Capture.IsValid() && Capture.IsSkeleton() != bSkeleton)
+	{
+		Capture.Error = bSkeleton ? TEXT("This is a camera capture, import it as a Spatial Camera") : TEXT("This is a skeleton capture, import it as a Spatial Skeleton");
+	}
 
-	// Frame Data
-	TArray<uint8> FrameData;
-	FromBuffer >> FrameData;
-	UE_LOG(SCTEditorBlueprintLibrary, Display, TEXT("[SCT Editor Blueprint] Read frame data: %d"), FrameData.Num());
+	if (Capture.IsValid() == false)
+	{
+		UE_LOG(SCTEditorBlueprintLibrary, Error, TEXT("[SCT Editor Blueprint] %s"), *Capture.Error);
+		return;
+	}
+	UE_LOG(SCTEditorBlueprintLibrary, Display, TEXT("[SCT Editor Blueprint] Read frame data: %d"), Capture.FrameData.Num());
 
 	FString AssetFileName = "";
 	{
-		const FString Title = TEXT("Save Spatial Skeleton Asset");
+		const FString Title = TEXT("Save ") + TypeName + TEXT(" Asset");
 		const FString FileTypes = TEXT("Data Asset (*.uasset)|*.uasset");
-		if (ChooseSaveLocationWithDialog(Title, FileTypes, "SkeletonCapture.uasset", AssetFileName) == false)
+		if (ChooseSaveLocationWithDialog(Title, FileTypes, DefaultAssetName, AssetFileName) == false)
 			return;
 	}
 
-	// Create Data Asset
-	FString PackageName = FPackageName::FilenameToLongPackageName(AssetFileName);
-	FString ShortName = FPackageName::GetShortName(PackageName);
-	UPackage* Package = CreatePackage(nullptr, *PackageName);
-	USCTSpatialSkeletonAsset* Asset = NewObject<USCTSpatialSkeletonAsset>(Package, USCTSpatialSkeletonAsset::StaticClass(), *ShortName, EObjectFlags::RF_Public | EObjectFlags::RF_Standalone);
-
-	PopulateSpatialCameraAsset(Asset, Header, UserAnchors, FrameData);
-	Asset->SkeletonDefinition = SkeletonDefinition;
-
-	FAssetRegistryModule::AssetCreated(Asset);
-	Asset->MarkPackageDirty();
-	UPackage::SavePackage(Package, Asset, EObjectFlags::RF_Public | EObjectFlags::RF_Standalone, *AssetFileName);
-}
-
-void USCTEditorBlueprintLibrary::ReadHeaderFromBuffer(FMRSerializeFromBuffer& FromBuffer, FSpatialHeader& Header)
-{
-	FromBuffer >> Header.Version;
-	FromBuffer >> Header.FrameCount;
-	FromBuffer >> Header.DeviceOrientation;
-	FromBuffer >> Header.HorizontalFOV;
-	FromBuffer >> Header.VerticalFOV;
-	FromBuffer >> Header.FocalLengthX;
-	FromBuffer >> Header.FocalLengthY;
-	FromBuffer >> Header.CaptureType;
-
-	check(Header.Version == 202005 && "Version Mismatch. Make sure your plugin and App versions match");
-}
-
-void USCTEditorBlueprintLibrary::ReadUserAnchorsFromBuffer(FMRSerializeFromBuffer& FromBuffer, TArray<FVector>& UserAnchors)
-{
-	int32 AnchorCount = 0;
-	FromBuffer >> AnchorCount;
-
-	for (int32 i = 0; i < AnchorCount; ++i)
-	{
-		FVector Pos = FVector::ZeroVector;
-		FromBuffer >> Pos;
-
-		UserAnchors.Add(Pos * 100.0f);
-	}
+	kh::SaveCaptureAsset(FPackageName::FilenameToLongPackageName(AssetFileName), MoveTemp(Capture));
 }
 
-void USCTEditorBlueprintLibrary::ReadSkeletonDefinitionFromBuffer(FMRSerializeFromBuffer& FromBuffer, FSCTSkeletonDefinition& SkeletonDefinition)
+void USCTEditorBlueprintLibrary::ReadFileWithDialog(const FString& Title, const FString& FileTypes, const FString& DefaultFileName, TArray<uint8>& FileBuffer)
 {
-	SkeletonDefinition.JointNames.Empty();
-	SkeletonDefinition.ParentIndices.Empty();
-	SkeletonDefinition.NeutralTransforms.Empty();
-
-	int JointCount = 0;
-	FromBuffer >> JointCount;
-
-	for (int i = 0; i < JointCount; ++i)
-	{
-		FString JointName;
-		FromBuffer >> JointName;
-
-		SkeletonDefinition.JointNames.Add(FName(JointName));
-	}
-
-	int ParentCount = 0;
-	FromBuffer >> ParentCount;
+	FString FileName;
+	if (ChooseFileWithDialog(Title, FileTypes, DefaultFileName, FileName) == false)
+		return;
 
-	for (int i = 0; i < ParentCount; ++i)
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	TUniquePtr<IFileHandle> File(PlatformFile.OpenRead(*FileName));
+	if (File)
 	{
-		int32 ParentIdx = -1;
-		FromBuffer >> ParentIdx;
-
-		SkeletonDefinition.ParentIndices.Add(ParentIdx);
-	}
+		UE_LOG(SCTEditorBlueprintLibrary, Display, TEXT("[SCT Editor Blueprint] Opened File with size: %d"), File->Size());
 
-	for (int i = 0; i < JointCount; ++i)
-	{
-		FTransform Trans;
-		FromBuffer >> Trans;
-		SkeletonDefinition.NeutralTransforms.Add(Trans);
+		FileBuffer.AddZeroed(File->Size());
+		File->Read(FileBuffer.GetData(), File->Size());
 	}
 }
 
-void USCTEditorBlueprintLibrary::PopulateSpatialCameraAsset(USCTSpatialCameraAsset* Asset, const FSpatialHeader& Header, const TArray<FVector>& UserAnchors, const TArray<uint8>& FrameData)
-{
-	Asset->Version = Header.Version;
-	Asset->FrameCount = Header.FrameCount;
-	Asset->DeviceOrientation = Header.DeviceOrientation;
-	Asset->HorizontalFOV = Header.HorizontalFOV;
-	Asset->VerticalFOV = Header.VerticalFOV;
-	Asset->FocalLengthX = Header.FocalLengthX;
-	Asset->FocalLengthY = Header.FocalLengthY;
-	Asset->CaptureType = Header.CaptureType;
-
-	Asset->UserAnchors = UserAnchors;
-	Asset->FrameData = FrameData;
-}
-
-void USCTEditorBlueprintLibrary::ReadFileWithDialog(const FString& Title, const FString& FileTypes, const FString& DefaultFileName, TArray<uint8>& FileBuffer)
+bool USCTEditorBlueprintLibrary::ChooseFileWithDialog(const FString& Title, const FString& FileTypes, const FString& DefaultFileName, FString& FileName)
 {
 	IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
 	const void* ParentWindowWindowHandle = FSlateApplication::Get().FindBestParentWindowHandleForDialogs(nullptr);
@@ -294,18 +174,11 @@ void USCTEditorBlueprintLibrary::ReadFileWithDialog(const FString& Title, const
 
 	if (OutFilenames.Num() == 0)
 	{
-		return;
+		return false;
 	}
 
-	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
-	IFileHandle* File = PlatformFile.OpenRead(*OutFilenames[0]);
-	if (File)
-	{
-		UE_LOG(SCTEditorBlueprintLibrary, Display, TEXT("[SCT Editor Blueprint] Opened File with size: %d"), File->Size());
-
-		FileBuffer.AddZeroed(File->Size());
-		File->Read(FileBuffer.GetData(), File->Size());
-	}
+	FileName = OutFilenames[0];
+	return true;
 }
 
 bool USCTEditorBlueprintLibrary::ChooseSaveLocationWithDialog(const FString& Title, const FString& FileTypes, const FString& DefaultFileName, FString& FileName)
@@ -0,0 +1,402 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "SCTImportCommandlet.h"
+#include "SCTCaptureImport.h"
+#include "SCTSpatialCameraAsset.h"
+
+#include "Async/Async.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "ObjectTools.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "UObject/UObjectGlobals.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSCTImport, Log, All);
+
+// Saved assets aren't used again, they are released to the garbage collector every this many saves
+static constexpr int32 CollectGarbageInterval = 8;
+
+struct FImportJob
+{
+	FString SourceFile;
+	FString PackageName;
+
+	// Filled on the thread pool
+	kh::FParsedCapture Capture;
+	double ParseSeconds = 0.0;
+	TFuture<void> Parsed;
+
+	// Filled on the game thread
+	FString Status;
+	int64 Bytes = 0;
+	double SaveSeconds = 0.0;
+};
+
+/** Builds a package path from a file path, dropping characters that aren't allowed in object names */
+static FString MakePackageName(const FString& Destination, const FString& RelativeFile)
+{
+	TArray<FString> Parts;
+	FPaths::SetExtension(RelativeFile, TEXT("")).ParseIntoArray(Parts, TEXT("/"));
+
+	FString PackageName = Destination;
+	for (const FString& Part : Parts)
+	{
+		if (Part != TEXT(".") && Part != TEXT(".."))
+		{
+			PackageName /= ObjectTools::SanitizeObjectName(Part);
+		}
+	}
+	return PackageName;
+}
+
+static bool GatherFromDirectory(const FString& Directory, const FString& Destination, bool bRecursive, const FSCTCaptureTrimSettings& TrimSettings, TArray<TUniquePtr<FImportJob>>& OutJobs)
+{
+	TArray<FString> Files;
+	if (bRecursive)
+	{
+		IFileManager::Get().FindFilesRecursive(Files, *Directory, TEXT("*.dat"), true, false);
+	}
+	else
+	{
+		IFileManager::Get().FindFiles(Files, *(Directory / TEXT("*.dat")), true, false);
+		for (FString& File : Files)
+		{
+			File = Directory / File;
+		}
+	}
+	Files.Sort();
+
+	for (const FString& File : Files)
+	{
+		FString Relative = File;
+		FPaths::MakePathRelativeTo(Relative, *(Directory + TEXT("/")));
+
+		TUniquePtr<FImportJob> Job = MakeUnique<FImportJob>();
+		Job->SourceFile = File;
+		Job->PackageName = MakePackageName(Destination, Relative);
+		Job->Capture.TrimSettings = TrimSettings;
+		OutJobs.Add(MoveTemp(Job));
+	}
+	return true;
+}
+
+static bool GatherFromManifest(const FString& Manifest, const FString& Destination, const FSCTCaptureTrimSettings& TrimSettings, TArray<TUniquePtr<FImportJob>>& OutJobs)
+{
+	TArray<FString> Lines;
+	if (FFileHelper::LoadFileToStringArray(Lines, *Manifest) == false)
+	{
+		UE_LOG(LogSCTImport, Error, TEXT("Could not read manifest %s"), *Manifest);
+		return false;
+	}
+
+	const FString ManifestDirectory = FPaths::GetPath(Manifest);
+	for (const FString& RawLine : Lines)
+	{
+		const FString Line = RawLine.TrimStartAndEnd();
+		if (Line.IsEmpty() || Line.StartsWith(TEXT("#")))
+			continue;
+
+		// File, then optionally the package and the start and end of the window to import
+		TArray<FString> Fields;
+		Line.ParseIntoArray(Fields, TEXT(","), false);
+		for (FString& Field : Fields)
+		{
+			Field.TrimStartAndEndInline();
+		}
+		Fields.SetNum(FMath::Max(Fields.Num(), 4));
+
+		FString File = Fields[0];
+		const FString PackageName = Fields[1];
+
+		FSCTCaptureTrimSettings JobTrimSettings = TrimSettings;
+		if (Fields[2].IsEmpty() == false)
+		{
+			JobTrimSettings.StartTime = FCString::Atof(*Fields[2]);
+		}
+		if (Fields[3].IsEmpty() == false)
+		{
+			JobTrimSettings.EndTime = FCString::Atof(*Fields[3]);
+		}
+
+		if (FPaths::IsRelative(File))
+		{
+			File = ManifestDirectory / File;
+		}
+
+		TUniquePtr<FImportJob> Job = MakeUnique<FImportJob>();
+		Job->SourceFile = FPaths::ConvertRelativePathToFull(File);
+		Job->PackageName = PackageName.IsEmpty() ? MakePackageName(Destination, FPaths::GetCleanFilename(File)) : PackageName;
+		Job->Capture.TrimSettings = JobTrimSettings;
+		OutJobs.Add(MoveTemp(Job));
+	}
+	return true;
+}
+
+/** Marks jobs that can't be imported before any work is started */
+static void ValidateJobs(TArray<TUniquePtr<FImportJob>>& Jobs, bool bOverwrite)
+{
+	TSet<FString> PackageNames;
+	for (TUniquePtr<FImportJob>& Job : Jobs)
+	{
+		FText Reason;
+		bool bDuplicate = false;
+		PackageNames.Add(Job->PackageName, &bDuplicate);
+
+		if (FPackageName::IsValidLongPackageName(Job->PackageName, false, &Reason) == false)
+		{
+			Job->Status = TEXT("Failed");
+			Job->Capture.Error = FString::Printf(TEXT("Invalid package name %s: %s"), *Job->PackageName, *Reason.ToString());
+		}
+		else if (bDuplicate)
+		{
+			Job->Status = TEXT("Failed");
+			Job->Capture.Error = FString::Printf(TEXT("Another capture is also imported to %s"), *Job->PackageName);
+		}
+		else if (bOverwrite == false && FPackageName::DoesPackageExist(Job->PackageName))
+		{
+			Job->Status = TEXT("Skipped");
+		}
+	}
+}
+
+static void StartParse(FImportJob& Job)
+{
+	Job.Parsed = Async(EAsyncExecution::ThreadPool, [&Job]()
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		kh::LoadCapture(Job.SourceFile, Job.Capture);
+		Job.ParseSeconds = FPlatformTime::Seconds() - StartTime;
+	});
+}
+
+static void SaveJob(FImportJob& Job, int32& SavedCount)
+{
+	if (Job.Capture.IsValid() == false)
+	{
+		Job.Status = TEXT("Failed");
+		UE_LOG(LogSCTImport, Error, TEXT("%s: %s"), *Job.SourceFile, *Job.Capture.Error);
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	Job.Bytes = Job.Capture.FrameData.Num();
+	USCTSpatialCameraAsset* Asset = kh::SaveCaptureAsset(Job.PackageName, MoveTemp(Job.Capture));
+	Job.SaveSeconds = FPlatformTime::Seconds() - StartTime;
+
+	if (Asset == nullptr)
+	{
+		Job.Status = TEXT("Failed");
+		Job.Capture.Error = TEXT("Could not save the package");
+		return;
+	}
+
+	Job.Status = TEXT("Imported");
+	Job.Capture.Header.FrameCount = Asset->FrameCount;
+	UE_LOG(LogSCTImport, Display, TEXT("%s -> %s: %d frames, %.1f MB, parsed in %.2f s, saved in %.2f s"), *Job.SourceFile, *Job.PackageName, Asset->FrameCount,
+		Job.Bytes / (1024.0 * 1024.0), Job.ParseSeconds, Job.SaveSeconds);
+
+	Asset->ClearFlags(RF_Standalone);
+	if (++SavedCount % CollectGarbageInterval == 0)
+	{
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+}
+
+static TSharedRef<FJsonObject> ToJson(const FString& Source, const FString& Destination, int32 Threads, double Seconds, const TArray<TUniquePtr<FImportJob>>& Jobs)
+{
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetStringField(TEXT("Source"), Source);
+	Root->SetStringField(TEXT("Destination"), Destination);
+	Root->SetStringField(TEXT("Date"), FDateTime::UtcNow().ToIso8601());
+	Root->SetNumberField(TEXT("Threads"), Threads);
+	Root->SetNumberField(TEXT("Seconds"), Seconds);
+
+	TMap<FString, int32> StatusCounts;
+	int64 TotalBytes = 0;
+	int64 TotalFrames = 0;
+
+	TArray<TSharedPtr<FJsonValue>> Files;
+	for (const TUniquePtr<FImportJob>& Job : Jobs)
+	{
+		const bool bImported = Job->Status == TEXT("Imported");
+		StatusCounts.FindOrAdd(Job->Status)++;
+		TotalBytes += Job->Bytes;
+		TotalFrames += bImported ? Job->Capture.Header.FrameCount : 0;
+
+		TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+		Object->SetStringField(TEXT("Source"), Job->SourceFile);
+		Object->SetStringField(TEXT("Asset"), Job->PackageName);
+		Object->SetStringField(TEXT("Status"), Job->Status);
+		if (bImported)
+		{
+			Object->SetStringField(TEXT("Type"), Job->Capture.IsSkeleton() ? TEXT("Skeleton") : TEXT("Camera"));
+			Object->SetNumberField(TEXT("Frames"), Job->Capture.Header.FrameCount);
+			if (Job->Capture.TrimSettings.bResample)
+			{
+				Object->SetNumberField(TEXT("FrameRate"), Job->Capture.TrimSettings.FrameRate.AsDecimal());
+			}
+			Object->SetNumberField(TEXT("Bytes"), Job->Bytes);
+			Object->SetNumberField(TEXT("ParseSeconds"), Job->ParseSeconds);
+			Object->SetNumberField(TEXT("SaveSeconds"), Job->SaveSeconds);
+		}
+		if (Job->Capture.Error.IsEmpty() == false)
+		{
+			Object->SetStringField(TEXT("Error"), Job->Capture.Error);
+		}
+
+		TArray<TSharedPtr<FJsonValue>> Warnings;
+		for (const FString& Warning : Job->Capture.Warnings)
+		{
+			Warnings.Add(MakeShared<FJsonValueString>(Warning));
+		}
+		Object->SetArrayField(TEXT("Warnings"), Warnings);
+
+		Files.Add(MakeShared<FJsonValueObject>(Object));
+	}
+
+	Root->SetNumberField(TEXT("Imported"), StatusCounts.FindRef(TEXT("Imported")));
+	Root->SetNumberField(TEXT("Skipped"), StatusCounts.FindRef(TEXT("Skipped")));
+	Root->SetNumberField(TEXT("Failed"), StatusCounts.FindRef(TEXT("Failed")));
+	Root->SetNumberField(TEXT("Frames"), TotalFrames);
+	Root->SetNumberField(TEXT("Bytes"), TotalBytes);
+	Root->SetArrayField(TEXT("Files"), Files);
+	return Root;
+}
+
+USCTImportCommandlet::USCTImportCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 USCTImportCommandlet::Main(const FString& Params)
+{
+	const TCHAR* Stream = *Params;
+
+	FString Source;
+	FString Destination = TEXT("/Game/Captures");
+	FString ReportPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("SCT"), FString::Printf(TEXT("Import-%s.json"), *FDateTime::Now().ToString()));
+	int32 Threads = FMath::Max(1, FPlatformMisc::NumberOfCoresIncludingHyperthreads() - 1);
+
+	FParse::Value(Stream, TEXT("Source="), Source);
+	FParse::Value(Stream, TEXT("Destination="), Destination);
+	FParse::Value(Stream, TEXT("Report="), ReportPath);
+	FParse::Value(Stream, TEXT("Threads="), Threads);
+	const bool bRecursive = FParse::Param(Stream, TEXT("Recursive"));
+	const bool bOverwrite = FParse::Param(Stream, TEXT("Overwrite"));
+
+	FSCTCaptureTrimSettings TrimSettings;
+	FParse::Value(Stream, TEXT("TrimStart="), TrimSettings.StartTime);
+	FParse::Value(Stream, TEXT("TrimEnd="), TrimSettings.EndTime);
+
+	FString FrameRate;
+	if (FParse::Value(Stream, TEXT("FrameRate="), FrameRate))
+	{
+		TrimSettings.bResample = true;
+		if (TryParseString(TrimSettings.FrameRate, *FrameRate) == false || TrimSettings.FrameRate.IsValid() == false)
+		{
+			UE_LOG(LogSCTImport, Error, TEXT("Invalid frame rate %s, use for example -FrameRate=24 or -FrameRate=24000/1001"), *FrameRate);
+			return 1;
+		}
+	}
+
+	// Every capture in flight is held in memory, so this also bounds memory use
+	Threads = FMath::Clamp(Threads, 1, 64);
+	Destination.RemoveFromEnd(TEXT("/"));
+
+	if (Source.IsEmpty())
+	{
+		UE_LOG(LogSCTImport, Error, TEXT("No source given, use -Source=D:/Shoot/Day1 or -Source=D:/Shoot/Day1/manifest.txt"));
+		return 1;
+	}
+	Source = FPaths::ConvertRelativePathToFull(Source);
+
+	TArray<TUniquePtr<FImportJob>> Jobs;
+	const bool bGathered = IFileManager::Get().DirectoryExists(*Source) ? GatherFromDirectory(Source, Destination, bRecursive, TrimSettings, Jobs) : GatherFromManifest(Source, Destination, TrimSettings, Jobs);
+	if (bGathered == false)
+		return 1;
+
+	ValidateJobs(Jobs, bOverwrite);
+	UE_LOG(LogSCTImport, Display, TEXT("Importing %d captures from %s with %d threads"), Jobs.Num(), *Source, Threads);
+
+	// Only jobs that passed validation are parsed, in order, with at most Threads ahead of the one being saved
+	TArray<FImportJob*> Pending;
+	for (TUniquePtr<FImportJob>& Job : Jobs)
+	{
+		if (Job->Status.IsEmpty())
+		{
+			Pending.Add(Job.Get());
+		}
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	int32 Started = 0;
+	int32 SavedCount = 0;
+	for (int32 i = 0; i < Pending.Num(); ++i)
+	{
+		for (; Started < Pending.Num() && Started <= i + Threads; ++Started)
+		{
+			StartParse(*Pending[Started]);
+		}
+
+		Pending[i]->Parsed.Wait();
+		SaveJob(*Pending[i], SavedCount);
+	}
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+	for (const TUniquePtr<FImportJob>& Job : Jobs)
+	{
+		if (Job->Status == TEXT("Skipped"))
+		{
+			UE_LOG(LogSCTImport, Display, TEXT("%s: %s exists, skipped"), *Job->SourceFile, *Job->PackageName);
+		}
+		else if (Job->Status == TEXT("Failed") && Pending.Contains(Job.Get()) == false)
+		{
+			UE_LOG(LogSCTImport, Error, TEXT("%s: %s"), *Job->SourceFile, *Job->Capture.Error);
+		}
+	}
+
+	const TSharedRef<FJsonObject> Report = ToJson(Source, Destination, Threads, Seconds, Jobs);
+	const int32 Failed = (int32)Report->GetNumberField(TEXT("Failed"));
+	UE_LOG(LogSCTImport, Display, TEXT("Imported %d, skipped %d, failed %d in %.1f s"), (int32)Report->GetNumberField(TEXT("Imported")), (int32)Report->GetNumberField(TEXT("Skipped")), Failed, Seconds);
+
+	FString Text;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Text);
+	if (FJsonSerializer::Serialize(Report, Writer) == false || FFileHelper::SaveStringToFile(Text, *ReportPath) == false)
+	{
+		UE_LOG(LogSCTImport, Error, TEXT("Could not write %s"), *ReportPath);
+		return 1;
+	}
+	UE_LOG(LogSCTImport, Display, TEXT("Wrote %s"), *ReportPath);
+
+	return Failed > 0 ? 1 : 0;
+}
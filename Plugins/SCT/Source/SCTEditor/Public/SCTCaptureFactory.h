@@ -0,0 +1,61 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EditorReimportHandler.h"
+#include "Factories/Factory.h"
+#include "SCTCaptureTrim.h"
+#include "SCTCaptureFactory.generated.h"
+
+/**
+ * Imports SCT capture files (.dat) dropped on the content browser or picked with Import, to a camera or skeleton
+ * asset depending on the capture. The file is read and parsed on the thread pool behind a cancellable progress
+ * dialog, and the source file is kept with the asset for reimport
+ */
+UCLASS(hidecategories = Object)
+class USCTCaptureFactory : public UFactory, public FReimportHandler
+{
+	GENERATED_BODY()
+
+public:
+	USCTCaptureFactory();
+
+	// Begin UFactory Interface
+	virtual bool FactoryCanImport(const FString& Filename) override;
+	virtual UObject* FactoryCreateFile(UClass* InClass, UObject* InParent, FName InName, EObjectFlags Flags, const FString& Filename, const TCHAR* Parms, FFeedbackContext* Warn, bool& bOutOperationCanceled) override;
+	// End UFactory Interface
+
+	// Begin FReimportHandler Interface
+	virtual bool CanReimport(UObject* Obj, TArray<FString>& OutFilenames) override;
+	virtual void SetReimportPaths(UObject* Obj, const TArray<FString>& NewReimportPaths) override;
+	virtual EReimportResult::Type Reimport(UObject* Obj) override;
+	virtual int32 GetPriority() const override;
+	virtual const UObject* GetFactoryObject() const override { return this; }
+	// End FReimportHandler Interface
+
+	/** Applied to new imports, for example from an automated import or a script. Reimports use the settings kept on the asset */
+	UPROPERTY(EditAnywhere, Category = "Import")
+	FSCTCaptureTrimSettings TrimSettings;
+};
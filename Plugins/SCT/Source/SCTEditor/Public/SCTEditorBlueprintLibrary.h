@@ -25,13 +25,10 @@ SOFTWARE.
 
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include "SCTProtocol.h"
 
 #include "SCTEditorBlueprintLibrary.generated.h"
 
-class FMRSerializeFromBuffer;
-class USCTSpatialCameraAsset;
-struct FSCTSkeletonDefinition;
-
 UCLASS()
 class SCTEDITOR_API USCTEditorBlueprintLibrary : public UBlueprintFunctionLibrary
 {
@@ -49,24 +46,9 @@ public:
 	static void ImportSpatialSkeleton();
 
 private:
-	struct FSpatialHeader
-	{
-		int32 Version;
-		int32 FrameCount;
-		int32 DeviceOrientation;
-		float HorizontalFOV;
-		float VerticalFOV;
-		float FocalLengthX;
-		float FocalLengthY;
-		int CaptureType;
-	};
-
-	static void ReadHeaderFromBuffer(FMRSerializeFromBuffer& FromBuffer, FSpatialHeader& Header);
-	static void ReadUserAnchorsFromBuffer(FMRSerializeFromBuffer& FromBuffer, TArray<FVector>& UserAnchors);
-	static void ReadSkeletonDefinitionFromBuffer(FMRSerializeFromBuffer& FromBuffer, FSCTSkeletonDefinition& SkeletonDefinition);
-
-	static void PopulateSpatialCameraAsset(USCTSpatialCameraAsset* Asset, const FSpatialHeader& Header, const TArray<FVector>& UserAnchors, const TArray<uint8>& FrameData);
+	static void ImportCaptureWithDialog(const FString& TypeName, const FString& DefaultAssetName, bool bSkeleton);
 	
 	static void ReadFileWithDialog(const FString& Title, const FString& FileTypes, const FString& DefaultFileName, TArray<uint8>& FileBuffer);
+	static bool ChooseFileWithDialog(const FString& Title, const FString& FileTypes, const FString& DefaultFileName, FString& FileName);
 	static bool ChooseSaveLocationWithDialog(const FString& Title, const FString& FileTypes, const FString& DefaultFileName, FString& FileName);
 };
@@ -0,0 +1,54 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SCTImportCommandlet.generated.h"
+
+/**
+ * Imports every capture in a directory, or listed in a manifest, to camera and skeleton assets without the editor UI.
+ * Files are read and parsed in parallel on the thread pool while the game thread creates and saves the packages in order.
+ *
+ * UE4Editor-Cmd.exe Project.uproject -run=SCTImport -Source=D:/Shoot/Day1 -Destination=/Game/Captures/Day1 [-Recursive]
+ *     [-Overwrite] [-Threads=N] [-Report=File.json] [-TrimStart=Seconds] [-TrimEnd=Seconds] [-FrameRate=24]
+ *
+ * A manifest is a text file with one capture per line, optionally followed by the package to import it to and the
+ * start and end of the window to keep, in seconds from the first frame:
+ *     Takes/take_01.dat, /Game/Captures/Hero/Take01, 12.5, 20
+ * Relative capture paths are relative to the manifest. Captures without a package go to -Destination, and
+ * captures without a window use -TrimStart and -TrimEnd. -FrameRate resamples every capture, see FSCTCaptureTrimSettings.
+ * Existing assets are skipped unless -Overwrite is given. A JSON report of every file is written to Saved/SCT,
+ * and the commandlet fails if any capture could not be imported
+ */
+UCLASS()
+class USCTImportCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USCTImportCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -40,6 +40,9 @@ public class SCTEditor : ModuleRules
 				"Engine",
 				"Slate",
 				"SlateCore",
+				"UnrealEd",
+				"AssetRegistry",
+				"Json",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
@@ -0,0 +1,15 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+using System.IO;
+using UnrealBuildTool;
+
+public class SCTCore : ModuleRules
+{
+	public SCTCore(ReadOnlyTargetRules Target) : base(Target)
+	{
+		// Header only and engine independent, also built on its own with the CMakeLists.txt next to this file
+		Type = ModuleType.External;
+
+		PublicIncludePaths.Add(Path.Combine(ModuleDirectory, "include"));
+	}
+}
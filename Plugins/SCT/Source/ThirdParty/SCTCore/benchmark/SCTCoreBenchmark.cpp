@@ -0,0 +1,213 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+// Measures how fast SCTCore parses and decodes captures, outside the engine.
+//
+// SCTCoreBenchmark [capture.dat] [--frames N] [--joints N] [--seconds S]
+//
+// Without a capture a synthetic skeleton capture is generated in memory. Reports parse time and frame decode
+// throughput in frames and megabytes per second.
+
+#include "sct/Capture.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+	double Seconds()
+	{
+		using namespace std::chrono;
+		return duration<double>(steady_clock::now().time_since_epoch()).count();
+	}
+
+	/** Writes values the way the app does, see sct::ByteReader */
+	class Writer
+	{
+	public:
+		explicit Writer(std::vector<uint8_t>& InBytes) : Bytes(InBytes) {}
+
+		void Raw(const void* Data, size_t Size)
+		{
+			const uint8_t* Begin = static_cast<const uint8_t*>(Data);
+			Bytes.insert(Bytes.end(), Begin, Begin + Size);
+		}
+		void Int32(int32_t Value) { Raw(&Value, 4); }
+		void Float(float Value) { Raw(&Value, 4); }
+		void Double(double Value)
+		{
+			uint64_t Bits;
+			std::memcpy(&Bits, &Value, 8);
+			for (int i = 7; i >= 0; --i)
+			{
+				Bytes.push_back(static_cast<uint8_t>(Bits >> (i * 8)));
+			}
+		}
+		void String(const std::string& Value)
+		{
+			Int32(static_cast<int32_t>(Value.size()));
+			Raw(Value.data(), Value.size());
+		}
+		void Matrix(float Tx, float Ty, float Tz)
+		{
+			const float M[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, Tx, Ty, Tz, 1 };
+			Raw(M, sizeof(M));
+		}
+
+	private:
+		std::vector<uint8_t>& Bytes;
+	};
+
+	void WriteSyntheticCapture(std::vector<uint8_t>& Bytes, int32_t FrameCount, int32_t JointCount)
+	{
+		Writer Out(Bytes);
+		Out.Int32(sct::ProtocolVersion);
+		Out.Int32(FrameCount);
+		Out.Int32(1);
+		Out.Float(60.0f);
+		Out.Float(45.0f);
+		Out.Float(1500.0f);
+		Out.Float(1500.0f);
+		Out.Int32(static_cast<int32_t>(sct::CaptureType::Skeleton));
+
+		Out.Int32(0);
+
+		Out.Int32(JointCount);
+		for (int32_t j = 0; j < JointCount; ++j)
+		{
+			Out.String("joint_" + std::to_string(j));
+		}
+		Out.Int32(JointCount);
+		for (int32_t j = 0; j < JointCount; ++j)
+		{
+			Out.Int32(j - 1);
+		}
+		for (int32_t j = 0; j < JointCount; ++j)
+		{
+			Out.Matrix(0.0f, 0.1f * j, 0.0f);
+		}
+
+		for (int32_t f = 0; f < FrameCount; ++f)
+		{
+			const float T = f / 60.0f;
+			Out.Int32(1);
+			for (int32_t j = 0; j < JointCount; ++j)
+			{
+				Out.Matrix(std::sin(T), 0.1f * j, std::cos(T));
+			}
+
+			Out.Double(T);
+			Out.Float(std::sin(T));
+			Out.Float(1.5f);
+			Out.Float(std::cos(T));
+			Out.Float(0.0f);
+			Out.Float(T);
+			Out.Float(0.0f);
+			Out.Float(0.0f);
+			Out.Double(1.0 / 120.0);
+		}
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	const char* Path = nullptr;
+	int32_t FrameCount = 100000;
+	int32_t JointCount = 91;
+	double MinSeconds = 2.0;
+
+	for (int i = 1; i < Argc; ++i)
+	{
+		const std::string Arg = Argv[i];
+		const bool bHasValue = i + 1 < Argc;
+		if (Arg == "--frames" && bHasValue) FrameCount = std::max(1, std::atoi(Argv[++i]));
+		else if (Arg == "--joints" && bHasValue) JointCount = std::max(0, std::atoi(Argv[++i]));
+		else if (Arg == "--seconds" && bHasValue) MinSeconds = std::max(0.1, std::atof(Argv[++i]));
+		else if (Arg[0] != '-' && Path == nullptr) Path = Argv[i];
+		else
+		{
+			std::fprintf(stderr, "Usage: %s [capture.dat] [--frames N] [--joints N] [--seconds S]\n", Argv[0]);
+			return 1;
+		}
+	}
+
+	std::vector<uint8_t> Bytes;
+	if (Path != nullptr)
+	{
+		std::ifstream File(Path, std::ios::binary);
+		if (!File)
+		{
+			std::fprintf(stderr, "Could not open %s\n", Path);
+			return 1;
+		}
+		Bytes.assign(std::istreambuf_iterator<char>(File), std::istreambuf_iterator<char>());
+	}
+	else
+	{
+		WriteSyntheticCapture(Bytes, FrameCount, JointCount);
+	}
+
+	sct::Capture Capture;
+	std::string Error;
+	const double ParseStart = Seconds();
+	if (!sct::ParseCapture(Bytes.data(), Bytes.size(), Capture, Error))
+	{
+		std::fprintf(stderr, "%s: %s\n", Path ? Path : "synthetic capture", Error.c_str());
+		return 1;
+	}
+	const double ParseTime = Seconds() - ParseStart;
+
+	std::printf("%s: version %d, %s, %d frames of %d bytes, %d joints\n", Path ? Path : "synthetic capture", Capture.Header.Version,
+		Capture.IsSkeleton() ? "skeleton" : "camera", Capture.FrameCount, Capture.FrameSize, Capture.GetJointCount());
+	std::printf("Parse header:  %.3f ms\n", ParseTime * 1000.0);
+
+	std::vector<sct::Matrix4> Joints(static_cast<size_t>(Capture.GetJointCount()));
+	sct::CameraFrame Camera;
+	double Sink = 0.0;
+	uint64_t FramesDecoded = 0;
+	int Passes = 0;
+
+	const double DecodeStart = Seconds();
+	double Elapsed = 0.0;
+	while (Elapsed < MinSeconds)
+	{
+		for (int32_t Frame = 0; Frame < Capture.FrameCount; ++Frame)
+		{
+			Capture.ReadFrame(Frame, Camera, Joints.data());
+			Sink += Camera.Timestamp + (Joints.empty() ? 0.0f : Joints.back().M[3][0]);
+		}
+		FramesDecoded += Capture.FrameCount;
+		++Passes;
+		Elapsed = Seconds() - DecodeStart;
+	}
+
+	const double Megabytes = static_cast<double>(FramesDecoded) * Capture.FrameSize / (1024.0 * 1024.0);
+	std::printf("Decode frames: %.0f frames/s, %.0f MB/s over %d passes\n", FramesDecoded / Elapsed, Megabytes / Elapsed, Passes);
+
+	// Keeps the decode loop from being optimized away
+	return Sink == -1.0 ? 2 : 0;
+}
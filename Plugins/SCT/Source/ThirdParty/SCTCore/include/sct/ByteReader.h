@@ -0,0 +1,180 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace sct
+{
+	/**
+	 * Bounds checked reader over a capture or packet in memory. Once a read runs past the end the reader is
+	 * overflowed, every later read fails and leaves its output untouched, so a frame can be read field by field
+	 * and checked once at the end.
+	 *
+	 * The encoding is the one the SCT app writes: 32 bit values are little endian, doubles and uint64 are big
+	 * endian and int64 is little endian. Captures older than 202005 have little endian doubles. See Protocol.md
+	 */
+	class ByteReader
+	{
+	public:
+		ByteReader() = default;
+		ByteReader(const uint8_t* InData, size_t InSize)
+			: Data(InData)
+			, Size(InSize)
+		{
+		}
+
+		/** Points at new data, keeping the read position. Used when a buffer grows while it is being read */
+		void Attach(const uint8_t* InData, size_t InSize)
+		{
+			Data = InData;
+			Size = InSize;
+		}
+
+		/** Back to the start, clearing the overflow */
+		void Reset()
+		{
+			Offset = 0;
+			bOverflow = false;
+		}
+
+		size_t Tell() const { return Offset; }
+		size_t GetSize() const { return Size; }
+		size_t Remaining() const { return Offset < Size ? Size - Offset : 0; }
+		bool HasOverflow() const { return bOverflow; }
+		/** For callers that find the data invalid, fails every later read */
+		void SetOverflow() { bOverflow = true; }
+		const uint8_t* GetData() const { return Data; }
+
+		void Seek(size_t Pos)
+		{
+			if (!bOverflow && Pos < Size)
+			{
+				Offset = Pos;
+			}
+			else
+			{
+				bOverflow = true;
+			}
+		}
+
+		/** Returns the next Count bytes and moves past them, nullptr on overflow */
+		const uint8_t* Take(size_t Count)
+		{
+			if (bOverflow || Count > Size - Offset)
+			{
+				bOverflow = true;
+				return nullptr;
+			}
+			const uint8_t* Result = Data + Offset;
+			Offset += Count;
+			return Result;
+		}
+
+		void Skip(size_t Count) { Take(Count); }
+
+		bool ReadBytes(void* Out, size_t Count)
+		{
+			const uint8_t* Bytes = Take(Count);
+			if (Bytes == nullptr)
+				return false;
+			std::memcpy(Out, Bytes, Count);
+			return true;
+		}
+
+		ByteReader& operator>>(uint8_t& Value) { ReadBytes(&Value, 1); return *this; }
+		ByteReader& operator>>(char& Value) { ReadBytes(&Value, 1); return *this; }
+		ByteReader& operator>>(uint32_t& Value) { ReadBytes(&Value, 4); return *this; }
+		ByteReader& operator>>(int32_t& Value) { ReadBytes(&Value, 4); return *this; }
+		ByteReader& operator>>(float& Value) { ReadBytes(&Value, 4); return *this; }
+		ByteReader& operator>>(int64_t& Value) { ReadBytes(&Value, 8); return *this; }
+
+		ByteReader& operator>>(uint64_t& Value)
+		{
+			if (const uint8_t* Bytes = Take(8))
+			{
+				Value = ReadBigEndian64(Bytes);
+			}
+			return *this;
+		}
+
+		ByteReader& operator>>(double& Value)
+		{
+			if (const uint8_t* Bytes = Take(8))
+			{
+				Value = ReadBigEndianDouble(Bytes);
+			}
+			return *this;
+		}
+
+		/** Doubles in captures written before version 202005 */
+		void ReadLittleEndian(double& Value)
+		{
+			ReadBytes(&Value, 8);
+		}
+
+		/** Strings are an int32 byte count followed by UTF-8 without a terminator */
+		ByteReader& operator>>(std::string& Value)
+		{
+			int32_t Length = 0;
+			*this >> Length;
+			if (Length < 0)
+			{
+				bOverflow = true;
+			}
+			else if (const uint8_t* Bytes = Take(static_cast<size_t>(Length)))
+			{
+				Value.assign(reinterpret_cast<const char*>(Bytes), static_cast<size_t>(Length));
+			}
+			return *this;
+		}
+
+		static uint64_t ReadBigEndian64(const uint8_t* Bytes)
+		{
+			uint64_t Value = 0;
+			for (int i = 0; i < 8; ++i)
+			{
+				Value = (Value << 8) | Bytes[i];
+			}
+			return Value;
+		}
+
+		static double ReadBigEndianDouble(const uint8_t* Bytes)
+		{
+			const uint64_t Bits = ReadBigEndian64(Bytes);
+			double Value;
+			std::memcpy(&Value, &Bits, sizeof(Value));
+			return Value;
+		}
+
+	private:
+		const uint8_t* Data = nullptr;
+		size_t Size = 0;
+		size_t Offset = 0;
+		bool bOverflow = false;
+	};
+}
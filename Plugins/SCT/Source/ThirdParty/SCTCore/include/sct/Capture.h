@@ -0,0 +1,112 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "sct/Protocol.h"
+
+namespace sct
+{
+	/**
+	 * A capture file parsed up to its frames. The frames are not copied, FrameData points into the buffer the
+	 * capture was parsed from and is only valid as long as it is
+	 */
+	struct Capture
+	{
+		CaptureHeader Header;
+		std::vector<Vec3> UserAnchors;
+		SkeletonDefinition Skeleton;
+
+		const FrameLayout* Layout = nullptr;
+		const uint8_t* FrameData = nullptr;
+		int32_t FrameSize = 0;
+		// Complete frames in the data, which can differ from Header.FrameCount for recordings that were cut off
+		int32_t FrameCount = 0;
+
+		bool IsSkeleton() const { return Header.IsSkeleton(); }
+		int32_t GetJointCount() const { return IsSkeleton() ? Skeleton.GetJointCount() : 0; }
+		const uint8_t* GetFrame(int32_t Index) const { return FrameData + static_cast<size_t>(Index) * FrameSize; }
+
+		/** Reads one frame, OutJoints needs room for GetJointCount transforms */
+		void ReadFrame(int32_t Index, CameraFrame& OutCamera, Matrix4* OutJoints) const
+		{
+			ByteReader Reader(GetFrame(Index), static_cast<size_t>(FrameSize));
+			if (IsSkeleton())
+			{
+				Layout->ReadSkeletonFrame(Reader, OutJoints, GetJointCount());
+			}
+			Layout->ReadCameraFrame(Reader, OutCamera);
+		}
+
+		/** The camera timestamp of a frame, without decoding its joints */
+		double ReadTimestamp(int32_t Index) const
+		{
+			ByteReader Reader(GetFrame(Index) + FrameSize - Layout->CameraFrameSize, static_cast<size_t>(Layout->CameraFrameSize));
+			CameraFrame Camera;
+			Layout->ReadCameraFrame(Reader, Camera);
+			return Camera.Timestamp;
+		}
+	};
+
+	/**
+	 * Parses the header, anchors and skeleton definition of a capture in memory
+	 *
+	 * @param OutError why the data isn't a capture that can be read, when false is returned
+	 */
+	inline bool ParseCapture(const uint8_t* Data, size_t Size, Capture& Out, std::string& OutError)
+	{
+		Out = Capture();
+		ByteReader Reader(Data, Size);
+
+		ReadHeader(Reader, Out.Header);
+		if (Reader.HasOverflow())
+		{
+			OutError = "File is too short for a capture header";
+			return false;
+		}
+
+		Out.Layout = FindLayout(Out.Header.Version);
+		if (Out.Layout == nullptr)
+		{
+			OutError = "Unsupported version " + std::to_string(Out.Header.Version) + ", versions " + std::to_string(OldestProtocolVersion) + " to " + std::to_string(ProtocolVersion) + " can be read";
+			return false;
+		}
+
+		Out.Layout->ReadUserAnchors(Reader, Out.UserAnchors);
+		if (Out.IsSkeleton())
+		{
+			Out.Layout->ReadSkeletonDefinition(Reader, Out.Skeleton);
+		}
+
+		if (Reader.HasOverflow())
+		{
+			OutError = "File ends before the first frame";
+			return false;
+		}
+
+		Out.FrameData = Data + Reader.Tell();
+		Out.FrameSize = Out.Layout->GetFrameSize(Out.IsSkeleton(), Out.Skeleton.GetJointCount());
+		Out.FrameCount = static_cast<int32_t>(std::min<size_t>(Reader.Remaining() / Out.FrameSize, INT32_MAX));
+		return true;
+	}
+}
@@ -0,0 +1,253 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "sct/ByteReader.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace sct
+{
+	/** Protocol version written by the current SCT app. See Protocol.md */
+	const int32_t ProtocolVersion = 202005;
+	/** Oldest version that can still be read, see "Version History" in Protocol.md */
+	const int32_t OldestProtocolVersion = 202003;
+
+	const int32_t HeaderSize = 32;
+	const int32_t CameraFrameSize = 44;
+	const int32_t SkeletonJointSize = 64;
+
+	/** Capture Type values found in the header */
+	enum class CaptureType : int32_t
+	{
+		Skeleton = 0,
+		Camera = 1
+	};
+
+	struct Vec3
+	{
+		float X = 0.0f;
+		float Y = 0.0f;
+		float Z = 0.0f;
+	};
+
+	/** A simd_float4x4 as written by the app, four columns of four floats. M[3] holds the translation */
+	struct Matrix4
+	{
+		float M[4][4];
+	};
+
+	static_assert(sizeof(Vec3) == 12 && sizeof(Matrix4) == 64, "Vectors and matrices are read straight from the stream");
+
+	struct CaptureHeader
+	{
+		int32_t Version = 0;
+		int32_t FrameCount = 0;
+		int32_t DeviceOrientation = 0;
+		float HorizontalFOV = 0.0f;
+		float VerticalFOV = 0.0f;
+		float FocalLengthX = 0.0f;
+		float FocalLengthY = 0.0f;
+		int32_t CaptureType = 0;
+
+		bool IsSkeleton() const { return CaptureType == static_cast<int32_t>(sct::CaptureType::Skeleton); }
+	};
+
+	struct SkeletonDefinition
+	{
+		std::vector<std::string> JointNames;
+		std::vector<int32_t> ParentIndices;
+		std::vector<Matrix4> NeutralTransforms;
+
+		int32_t GetJointCount() const { return static_cast<int32_t>(JointNames.size()); }
+	};
+
+	/** A camera frame in device space: Y up, metres, rotation as roll, pitch, yaw in radians */
+	struct CameraFrame
+	{
+		double Timestamp = 0.0;
+		Vec3 Position;
+		Vec3 Rotation;
+		float ExposureOffset = 0.0f;
+		double ExposureDuration = 0.0;
+	};
+
+	inline ByteReader& operator>>(ByteReader& Reader, Vec3& Value)
+	{
+		return Reader >> Value.X >> Value.Y >> Value.Z;
+	}
+
+	inline ByteReader& operator>>(ByteReader& Reader, Matrix4& Value)
+	{
+		Reader.ReadBytes(Value.M, sizeof(Value.M));
+		return Reader;
+	}
+
+	/** Captures before 202005 have no anchors section */
+	inline void ReadNoUserAnchors(ByteReader&, std::vector<Vec3>& Out)
+	{
+		Out.clear();
+	}
+
+	/** Anchor positions in device space. The count is bounded by what is left to read */
+	inline void ReadUserAnchors(ByteReader& Reader, std::vector<Vec3>& Out)
+	{
+		int32_t Count = 0;
+		Reader >> Count;
+		Out.clear();
+		for (int32_t i = 0; i < Count && !Reader.HasOverflow(); ++i)
+		{
+			Vec3 Position;
+			Reader >> Position;
+			Out.push_back(Position);
+		}
+	}
+
+	inline void ReadSkeletonDefinition(ByteReader& Reader, SkeletonDefinition& Out)
+	{
+		Out = SkeletonDefinition();
+
+		int32_t JointCount = 0;
+		Reader >> JointCount;
+		for (int32_t i = 0; i < JointCount && !Reader.HasOverflow(); ++i)
+		{
+			std::string Name;
+			Reader >> Name;
+			Out.JointNames.push_back(std::move(Name));
+		}
+
+		int32_t ParentCount = 0;
+		Reader >> ParentCount;
+		for (int32_t i = 0; i < ParentCount && !Reader.HasOverflow(); ++i)
+		{
+			int32_t Parent = -1;
+			Reader >> Parent;
+			Out.ParentIndices.push_back(Parent);
+		}
+
+		for (int32_t i = 0; i < JointCount && !Reader.HasOverflow(); ++i)
+		{
+			Matrix4 Transform = {};
+			Reader >> Transform;
+			Out.NeutralTransforms.push_back(Transform);
+		}
+	}
+
+	inline void ReadCameraFrame(ByteReader& Reader, CameraFrame& Out)
+	{
+		Reader >> Out.Timestamp >> Out.Position >> Out.Rotation >> Out.ExposureOffset >> Out.ExposureDuration;
+	}
+
+	/** Camera frames before 202005, the same fields with little endian doubles */
+	inline void ReadLegacyCameraFrame(ByteReader& Reader, CameraFrame& Out)
+	{
+		Reader.ReadLittleEndian(Out.Timestamp);
+		Reader >> Out.Position >> Out.Rotation >> Out.ExposureOffset;
+		Reader.ReadLittleEndian(Out.ExposureDuration);
+	}
+
+	/**
+	 * Reads the joints of the first skeleton in a skeleton frame, which is all the app writes
+	 *
+	 * @return the skeleton count in the frame
+	 */
+	inline uint32_t ReadSkeletonFrame(ByteReader& Reader, Matrix4* OutJoints, int32_t JointCount)
+	{
+		uint32_t SkeletonCount = 0;
+		Reader >> SkeletonCount;
+		Reader.ReadBytes(OutJoints, static_cast<size_t>(JointCount) * sizeof(Matrix4));
+		return SkeletonCount;
+	}
+
+	/** One part of a geometry stream in device space. Counts are bounded by what is left to read */
+	inline void ReadMeshPart(ByteReader& Reader, std::vector<Vec3>& OutVertices, std::vector<uint32_t>& OutIndices)
+	{
+		int64_t VertexCount = 0;
+		Reader >> VertexCount;
+		VertexCount = VertexCount < 0 ? 0 : std::min<int64_t>(VertexCount, Reader.Remaining() / sizeof(Vec3));
+		OutVertices.resize(static_cast<size_t>(VertexCount));
+		Reader.ReadBytes(OutVertices.data(), OutVertices.size() * sizeof(Vec3));
+
+		int64_t IndexCount = 0;
+		Reader >> IndexCount;
+		IndexCount = IndexCount < 0 ? 0 : std::min<int64_t>(IndexCount, Reader.Remaining() / sizeof(uint32_t));
+		OutIndices.resize(static_cast<size_t>(IndexCount));
+		Reader.ReadBytes(OutIndices.data(), OutIndices.size() * sizeof(uint32_t));
+	}
+
+	/**
+	 * Layout of one protocol version. Readers look it up once from the header version, so frame loops never
+	 * branch on the version. A format change adds an entry to the table in FindLayout
+	 */
+	struct FrameLayout
+	{
+		int32_t Version;
+		int32_t CameraFrameSize;
+		int32_t SkeletonJointSize;
+		// Older versions only recorded the camera and leave Capture Type 0
+		bool bSkeletonCaptures;
+
+		void (*ReadUserAnchors)(ByteReader& Reader, std::vector<Vec3>& Out);
+		void (*ReadSkeletonDefinition)(ByteReader& Reader, SkeletonDefinition& Out);
+		void (*ReadCameraFrame)(ByteReader& Reader, CameraFrame& Out);
+		uint32_t (*ReadSkeletonFrame)(ByteReader& Reader, Matrix4* OutJoints, int32_t JointCount);
+
+		int32_t GetSkeletonFrameSize(int32_t JointCount) const { return 4 + JointCount * SkeletonJointSize; }
+		int32_t GetFrameSize(bool bSkeleton, int32_t JointCount) const { return (bSkeleton ? GetSkeletonFrameSize(JointCount) : 0) + CameraFrameSize; }
+	};
+
+	/** The layout of a protocol version, nullptr for versions that can't be read */
+	inline const FrameLayout* FindLayout(int32_t Version)
+	{
+		// One entry per version in Protocol.md, oldest first
+		static const FrameLayout Layouts[] =
+		{
+			{ 202003, CameraFrameSize, SkeletonJointSize, false, &ReadNoUserAnchors, &ReadSkeletonDefinition, &ReadLegacyCameraFrame, &ReadSkeletonFrame },
+			{ 202004, CameraFrameSize, SkeletonJointSize, false, &ReadNoUserAnchors, &ReadSkeletonDefinition, &ReadLegacyCameraFrame, &ReadSkeletonFrame },
+			{ 202005, CameraFrameSize, SkeletonJointSize, true, &ReadUserAnchors, &ReadSkeletonDefinition, &ReadCameraFrame, &ReadSkeletonFrame },
+		};
+
+		for (const FrameLayout& Entry : Layouts)
+		{
+			if (Entry.Version == Version)
+				return &Entry;
+		}
+		return nullptr;
+	}
+
+	/** Reads the header. Captures of versions without skeletons get Capture Type Camera, whatever the file says */
+	inline void ReadHeader(ByteReader& Reader, CaptureHeader& Out)
+	{
+		Reader >> Out.Version >> Out.FrameCount >> Out.DeviceOrientation;
+		Reader >> Out.HorizontalFOV >> Out.VerticalFOV >> Out.FocalLengthX >> Out.FocalLengthY;
+		Reader >> Out.CaptureType;
+
+		const FrameLayout* Layout = FindLayout(Out.Version);
+		if (Layout != nullptr && !Layout->bSkeletonCaptures)
+		{
+			Out.CaptureType = static_cast<int32_t>(CaptureType::Camera);
+		}
+	}
+}
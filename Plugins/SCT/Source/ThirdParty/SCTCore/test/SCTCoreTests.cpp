@@ -0,0 +1,346 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+// Checks the SCTCore readers against hand written and recorded captures, run through CTest.
+//
+// SCTCoreTests <test> [rotate.dat]
+//
+// Every test is registered on its own in CMakeLists.txt. Failed checks are printed and make the test exit non zero.
+
+#include "sct/Capture.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+	int Failures = 0;
+
+	#define SCT_CHECK(Condition) \
+		do { if (!(Condition)) { std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #Condition); ++Failures; } } while (0)
+
+	/** Writes values the way the app does, see sct::ByteReader */
+	class Writer
+	{
+	public:
+		explicit Writer(std::vector<uint8_t>& InBytes) : Bytes(InBytes) {}
+
+		void Raw(const void* Data, size_t Size)
+		{
+			const uint8_t* Begin = static_cast<const uint8_t*>(Data);
+			Bytes.insert(Bytes.end(), Begin, Begin + Size);
+		}
+		void Int32(int32_t Value) { Raw(&Value, 4); }
+		void Float(float Value) { Raw(&Value, 4); }
+		void Double(double Value)
+		{
+			uint64_t Bits;
+			std::memcpy(&Bits, &Value, 8);
+			for (int i = 7; i >= 0; --i)
+			{
+				Bytes.push_back(static_cast<uint8_t>(Bits >> (i * 8)));
+			}
+		}
+		void LittleEndianDouble(double Value) { Raw(&Value, 8); }
+		void String(const std::string& Value)
+		{
+			Int32(static_cast<int32_t>(Value.size()));
+			Raw(Value.data(), Value.size());
+		}
+
+	private:
+		std::vector<uint8_t>& Bytes;
+	};
+
+	/** A current version skeleton capture, returns the size of everything before the first frame */
+	size_t WriteSkeletonCapture(std::vector<uint8_t>& Bytes, int32_t FrameCount, int32_t JointCount)
+	{
+		Writer Out(Bytes);
+		Out.Int32(sct::ProtocolVersion);
+		Out.Int32(FrameCount);
+		Out.Int32(1);
+		Out.Float(60.0f);
+		Out.Float(45.0f);
+		Out.Float(1500.0f);
+		Out.Float(1500.0f);
+		Out.Int32(static_cast<int32_t>(sct::CaptureType::Skeleton));
+
+		Out.Int32(1);
+		Out.Float(1.0f);
+		Out.Float(2.0f);
+		Out.Float(3.0f);
+
+		Out.Int32(JointCount);
+		for (int32_t j = 0; j < JointCount; ++j)
+		{
+			Out.String("joint_" + std::to_string(j));
+		}
+		Out.Int32(JointCount);
+		for (int32_t j = 0; j < JointCount; ++j)
+		{
+			Out.Int32(j - 1);
+		}
+		const sct::Matrix4 Identity = { { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0, 1 } } };
+		for (int32_t j = 0; j < JointCount; ++j)
+		{
+			Out.Raw(&Identity, sizeof(Identity));
+		}
+		const size_t FramesOffset = Bytes.size();
+
+		for (int32_t f = 0; f < FrameCount; ++f)
+		{
+			Out.Int32(1);
+			for (int32_t j = 0; j < JointCount; ++j)
+			{
+				sct::Matrix4 Joint = Identity;
+				Joint.M[3][1] = static_cast<float>(f + j);
+				Out.Raw(&Joint, sizeof(Joint));
+			}
+
+			Out.Double(f / 60.0);
+			for (int i = 0; i < 7; ++i)
+			{
+				Out.Float(static_cast<float>(i));
+			}
+			Out.Double(1.0 / 120.0);
+		}
+		return FramesOffset;
+	}
+
+	void TestByteReaderOverflow()
+	{
+		const uint8_t Data[6] = { 1, 0, 0, 0, 2, 0 };
+		sct::ByteReader Reader(Data, sizeof(Data));
+
+		int32_t First = 0;
+		Reader >> First;
+		SCT_CHECK(First == 1 && !Reader.HasOverflow() && Reader.Remaining() == 2);
+
+		// A failed read leaves its output and the position untouched
+		int32_t Second = -7;
+		Reader >> Second;
+		SCT_CHECK(Reader.HasOverflow() && Second == -7 && Reader.Tell() == 4);
+
+		// Once overflowed, reads that would fit fail too
+		uint8_t Byte = 9;
+		Reader >> Byte;
+		SCT_CHECK(Byte == 9 && Reader.Take(1) == nullptr);
+
+		Reader.Reset();
+		Reader >> First;
+		SCT_CHECK(First == 1 && !Reader.HasOverflow());
+
+		// Counts past the end must not wrap around
+		SCT_CHECK(Reader.Take(SIZE_MAX) == nullptr && Reader.HasOverflow());
+
+		Reader.Reset();
+		Reader.Seek(sizeof(Data));
+		SCT_CHECK(Reader.HasOverflow());
+
+		std::vector<uint8_t> Bytes;
+		Writer Out(Bytes);
+		Out.Int32(-1);
+		std::string Value = "unchanged";
+		sct::ByteReader NegativeLength(Bytes.data(), Bytes.size());
+		NegativeLength >> Value;
+		SCT_CHECK(NegativeLength.HasOverflow() && Value == "unchanged");
+
+		Bytes.clear();
+		Out.Int32(100);
+		Out.Raw("abc", 3);
+		sct::ByteReader ShortString(Bytes.data(), Bytes.size());
+		ShortString >> Value;
+		SCT_CHECK(ShortString.HasOverflow() && Value == "unchanged");
+
+		Bytes.clear();
+		Out.Double(1.5);
+		Out.LittleEndianDouble(-2.25);
+		sct::ByteReader Doubles(Bytes.data(), Bytes.size());
+		double BigEndian = 0.0;
+		double LittleEndian = 0.0;
+		Doubles >> BigEndian;
+		Doubles.ReadLittleEndian(LittleEndian);
+		SCT_CHECK(BigEndian == 1.5 && LittleEndian == -2.25 && !Doubles.HasOverflow());
+	}
+
+	void TestFindLayout()
+	{
+		for (int32_t Version : { 202003, 202004 })
+		{
+			const sct::FrameLayout* Layout = sct::FindLayout(Version);
+			SCT_CHECK(Layout != nullptr);
+			if (Layout == nullptr)
+				continue;
+
+			SCT_CHECK(Layout->Version == Version);
+			SCT_CHECK(!Layout->bSkeletonCaptures);
+			SCT_CHECK(Layout->ReadUserAnchors == &sct::ReadNoUserAnchors);
+			SCT_CHECK(Layout->ReadCameraFrame == &sct::ReadLegacyCameraFrame);
+			SCT_CHECK(Layout->GetFrameSize(false, 0) == sct::CameraFrameSize);
+		}
+
+		const sct::FrameLayout* Current = sct::FindLayout(sct::ProtocolVersion);
+		SCT_CHECK(Current != nullptr);
+		if (Current != nullptr)
+		{
+			SCT_CHECK(Current->bSkeletonCaptures);
+			SCT_CHECK(Current->ReadUserAnchors == &sct::ReadUserAnchors);
+			SCT_CHECK(Current->ReadCameraFrame == &sct::ReadCameraFrame);
+			SCT_CHECK(Current->GetFrameSize(true, 3) == 4 + 3 * sct::SkeletonJointSize + sct::CameraFrameSize);
+		}
+
+		for (int32_t Version = sct::OldestProtocolVersion; Version <= sct::ProtocolVersion; ++Version)
+		{
+			SCT_CHECK(sct::FindLayout(Version) != nullptr);
+		}
+		SCT_CHECK(sct::FindLayout(sct::OldestProtocolVersion - 1) == nullptr);
+		SCT_CHECK(sct::FindLayout(sct::ProtocolVersion + 1) == nullptr);
+		SCT_CHECK(sct::FindLayout(0) == nullptr);
+
+		// Legacy headers can say Skeleton, those captures only ever held the camera
+		std::vector<uint8_t> Bytes;
+		Writer Out(Bytes);
+		Out.Int32(202004);
+		for (int i = 0; i < 6; ++i)
+		{
+			Out.Int32(0);
+		}
+		Out.Int32(static_cast<int32_t>(sct::CaptureType::Skeleton));
+		sct::ByteReader Reader(Bytes.data(), Bytes.size());
+		sct::CaptureHeader Header;
+		sct::ReadHeader(Reader, Header);
+		SCT_CHECK(!Header.IsSkeleton() && !Reader.HasOverflow());
+	}
+
+	void TestParseCaptureTruncated()
+	{
+		const int32_t FrameCount = 4;
+		const int32_t JointCount = 3;
+		std::vector<uint8_t> Bytes;
+		const size_t FramesOffset = WriteSkeletonCapture(Bytes, FrameCount, JointCount);
+
+		sct::Capture Capture;
+		std::string Error;
+		SCT_CHECK(sct::ParseCapture(Bytes.data(), Bytes.size(), Capture, Error));
+		SCT_CHECK(Capture.IsSkeleton() && Capture.GetJointCount() == JointCount && Capture.UserAnchors.size() == 1);
+		SCT_CHECK(Capture.FrameCount == FrameCount && Capture.FrameData == Bytes.data() + FramesOffset);
+		const size_t FrameSize = static_cast<size_t>(Capture.FrameSize);
+
+		// Every cut before the first frame is an error
+		for (size_t Size = 0; Size < FramesOffset; ++Size)
+		{
+			Error.clear();
+			const bool bParsed = sct::ParseCapture(Bytes.data(), Size, Capture, Error);
+			SCT_CHECK(!bParsed && !Error.empty());
+			if (bParsed)
+			{
+				std::fprintf(stderr, "parsed a capture cut to %zu of %zu header bytes\n", Size, FramesOffset);
+				break;
+			}
+		}
+
+		// A cut inside the frames keeps the complete ones
+		for (int32_t Complete = 0; Complete < FrameCount; ++Complete)
+		{
+			const size_t Size = FramesOffset + static_cast<size_t>(Complete + 1) * FrameSize - 1;
+			SCT_CHECK(sct::ParseCapture(Bytes.data(), Size, Capture, Error));
+			SCT_CHECK(Capture.FrameCount == Complete && Capture.Header.FrameCount == FrameCount);
+		}
+
+		// The last complete frame still decodes
+		SCT_CHECK(sct::ParseCapture(Bytes.data(), Bytes.size() - 1, Capture, Error));
+		std::vector<sct::Matrix4> Joints(JointCount);
+		sct::CameraFrame Camera;
+		Capture.ReadFrame(Capture.FrameCount - 1, Camera, Joints.data());
+		SCT_CHECK(Camera.Timestamp == (FrameCount - 2) / 60.0 && Joints[2].M[3][1] == FrameCount - 2 + 2);
+
+		Bytes[0] = 0x10;
+		SCT_CHECK(!sct::ParseCapture(Bytes.data(), Bytes.size(), Capture, Error) && Error.find("Unsupported version") == 0);
+	}
+
+	void TestRotateRoundTrip(const char* Path)
+	{
+		std::ifstream File(Path, std::ios::binary);
+		SCT_CHECK(File.good());
+		if (!File)
+			return;
+		const std::vector<uint8_t> Bytes((std::istreambuf_iterator<char>(File)), std::istreambuf_iterator<char>());
+
+		sct::Capture Capture;
+		std::string Error;
+		SCT_CHECK(sct::ParseCapture(Bytes.data(), Bytes.size(), Capture, Error));
+		if (Capture.Layout == nullptr)
+			return;
+
+		SCT_CHECK(Capture.Header.Version == 202004);
+		SCT_CHECK(!Capture.IsSkeleton() && Capture.UserAnchors.empty());
+		SCT_CHECK(Capture.FrameData == Bytes.data() + sct::HeaderSize);
+		SCT_CHECK(Capture.FrameSize == sct::CameraFrameSize);
+		SCT_CHECK(Capture.FrameCount == 362 && Capture.Header.FrameCount == Capture.FrameCount);
+		SCT_CHECK(std::fabs(Capture.ReadTimestamp(0) - 248153.489) < 1e-3);
+
+		// Decoding and writing every frame back in the legacy encoding must give the recorded bytes
+		double LastTimestamp = 0.0;
+		for (int32_t Frame = 0; Frame < Capture.FrameCount; ++Frame)
+		{
+			sct::CameraFrame Camera;
+			Capture.ReadFrame(Frame, Camera, nullptr);
+			SCT_CHECK(Camera.Timestamp >= LastTimestamp && Camera.Timestamp == Capture.ReadTimestamp(Frame));
+			LastTimestamp = Camera.Timestamp;
+
+			std::vector<uint8_t> Encoded;
+			Writer Out(Encoded);
+			Out.LittleEndianDouble(Camera.Timestamp);
+			Out.Raw(&Camera.Position, sizeof(Camera.Position));
+			Out.Raw(&Camera.Rotation, sizeof(Camera.Rotation));
+			Out.Float(Camera.ExposureOffset);
+			Out.LittleEndianDouble(Camera.ExposureDuration);
+
+			const bool bSame = Encoded.size() == static_cast<size_t>(Capture.FrameSize) && std::memcmp(Encoded.data(), Capture.GetFrame(Frame), Encoded.size()) == 0;
+			SCT_CHECK(bSame);
+			if (!bSame)
+			{
+				std::fprintf(stderr, "frame %d doesn't round trip\n", Frame);
+				break;
+			}
+		}
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	const std::string Test = Argc > 1 ? Argv[1] : "";
+	if (Test == "ByteReaderOverflow") TestByteReaderOverflow();
+	else if (Test == "FindLayout") TestFindLayout();
+	else if (Test == "ParseCaptureTruncated") TestParseCaptureTruncated();
+	else if (Test == "RotateRoundTrip" && Argc > 2) TestRotateRoundTrip(Argv[2]);
+	else
+	{
+		std::fprintf(stderr, "Usage: %s ByteReaderOverflow|FindLayout|ParseCaptureTruncated|RotateRoundTrip rotate.dat\n", Argv[0]);
+		return 1;
+	}
+
+	return Failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,642 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Converts SCT captures to a columnar file that tools outside Unreal can seek into, with the header as a JSON
+// sidecar and optionally a CSV for a quick look. See "Columnar Export" in Protocol.md.
+//
+// SCTConvert <capture.dat or directory>... [--out directory] [--csv] [--threads N]
+//
+// Directories are searched for .dat files, not recursively. Captures are converted in parallel, one per thread.
+
+#include "sct/Capture.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+	const uint32_t ColumnarMagic = 0x43544353; // SCTC
+	const int32_t ColumnarVersion = 1;
+	const size_t ColumnarHeaderSize = 24;
+	const size_t ChannelEntrySize = 56;
+	// Channels and the index start on this boundary so they can be mapped and read as arrays
+	const size_t ColumnarAlignment = 64;
+
+	enum class ChannelType : int32_t
+	{
+		Float32 = 0,
+		Float64 = 1
+	};
+
+	/** One column of the output, Components values of Type per frame */
+	struct Channel
+	{
+		std::string Name;
+		ChannelType Type;
+		int32_t Components;
+		const void* Data;
+		uint64_t Offset;
+
+		uint64_t GetSize(int32_t FrameCount) const { return uint64_t(FrameCount) * Components * (Type == ChannelType::Float64 ? 8 : 4); }
+	};
+
+	/** The decoded frames of one capture, a column per field. Kept per thread and reused between captures */
+	struct Columns
+	{
+		std::vector<double> Timestamps;
+		std::vector<sct::Vec3> Positions;
+		std::vector<sct::Vec3> Rotations;
+		std::vector<float> ExposureOffsets;
+		std::vector<double> ExposureDurations;
+		std::vector<sct::Matrix4> Joints;
+		std::vector<uint8_t> FileData;
+
+		void Decode(const sct::Capture& Capture)
+		{
+			const size_t FrameCount = static_cast<size_t>(Capture.FrameCount);
+			const size_t JointCount = static_cast<size_t>(Capture.GetJointCount());
+			Timestamps.resize(FrameCount);
+			Positions.resize(FrameCount);
+			Rotations.resize(FrameCount);
+			ExposureOffsets.resize(FrameCount);
+			ExposureDurations.resize(FrameCount);
+			Joints.resize(FrameCount * JointCount);
+
+			sct::CameraFrame Camera;
+			for (size_t i = 0; i < FrameCount; ++i)
+			{
+				Capture.ReadFrame(static_cast<int32_t>(i), Camera, Joints.data() + i * JointCount);
+				Timestamps[i] = Camera.Timestamp;
+				Positions[i] = Camera.Position;
+				Rotations[i] = Camera.Rotation;
+				ExposureOffsets[i] = Camera.ExposureOffset;
+				ExposureDurations[i] = Camera.ExposureDuration;
+			}
+		}
+	};
+
+	struct Options
+	{
+		std::string OutDirectory;
+		bool bCsv = false;
+	};
+
+	double Seconds()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	bool IsDirectory(const std::string& Path)
+	{
+#if defined(_WIN32)
+		const DWORD Attributes = GetFileAttributesA(Path.c_str());
+		return Attributes != INVALID_FILE_ATTRIBUTES && (Attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+#else
+		struct stat Stat;
+		return stat(Path.c_str(), &Stat) == 0 && S_ISDIR(Stat.st_mode);
+#endif
+	}
+
+	bool MakeDirectory(const std::string& Path)
+	{
+		if (IsDirectory(Path))
+			return true;
+#if defined(_WIN32)
+		return CreateDirectoryA(Path.c_str(), nullptr) != 0;
+#else
+		return mkdir(Path.c_str(), 0777) == 0;
+#endif
+	}
+
+	bool EndsWith(const std::string& Value, const char* Suffix)
+	{
+		const size_t Length = std::strlen(Suffix);
+		return Value.size() >= Length && Value.compare(Value.size() - Length, Length, Suffix) == 0;
+	}
+
+	/** The .dat files directly in a directory, sorted so the output order is stable */
+	void FindCaptures(const std::string& Directory, std::vector<std::string>& OutFiles)
+	{
+		std::vector<std::string> Found;
+#if defined(_WIN32)
+		WIN32_FIND_DATAA FindData;
+		HANDLE Find = FindFirstFileA((Directory + "\\*.dat").c_str(), &FindData);
+		if (Find != INVALID_HANDLE_VALUE)
+		{
+			do
+			{
+				if ((FindData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+					Found.push_back(Directory + "\\" + FindData.cFileName);
+			} while (FindNextFileA(Find, &FindData));
+			FindClose(Find);
+		}
+#else
+		if (DIR* Dir = opendir(Directory.c_str()))
+		{
+			while (dirent* Entry = readdir(Dir))
+			{
+				const std::string Name = Entry->d_name;
+				if (EndsWith(Name, ".dat") && !IsDirectory(Directory + "/" + Name))
+					Found.push_back(Directory + "/" + Name);
+			}
+			closedir(Dir);
+		}
+#endif
+		std::sort(Found.begin(), Found.end());
+		OutFiles.insert(OutFiles.end(), Found.begin(), Found.end());
+	}
+
+	/** The output path without an extension: the capture name in the output directory, or next to the capture */
+	std::string GetOutputStem(const std::string& Input, const Options& Options)
+	{
+		const size_t Slash = Input.find_last_of("/\\");
+		std::string Name = Slash == std::string::npos ? Input : Input.substr(Slash + 1);
+		if (EndsWith(Name, ".dat"))
+			Name.resize(Name.size() - 4);
+
+		if (Options.OutDirectory.empty())
+			return (Slash == std::string::npos ? std::string() : Input.substr(0, Slash + 1)) + Name;
+		return Options.OutDirectory + "/" + Name;
+	}
+
+	bool ReadFile(const std::string& Path, std::vector<uint8_t>& OutData)
+	{
+		FILE* File = std::fopen(Path.c_str(), "rb");
+		if (File == nullptr)
+			return false;
+
+		std::fseek(File, 0, SEEK_END);
+		const long Size = std::ftell(File);
+		std::fseek(File, 0, SEEK_SET);
+
+		OutData.resize(Size > 0 ? static_cast<size_t>(Size) : 0);
+		const bool bRead = Size >= 0 && std::fread(OutData.data(), 1, OutData.size(), File) == OutData.size();
+		std::fclose(File);
+		return bRead;
+	}
+
+	/** Writes through a large buffer, remembering the first error so callers check once at the end */
+	class FileWriter
+	{
+	public:
+		explicit FileWriter(const std::string& Path)
+			: File(std::fopen(Path.c_str(), "wb"))
+		{
+			if (File != nullptr)
+				std::setvbuf(File, nullptr, _IOFBF, 1 << 20);
+		}
+
+		~FileWriter()
+		{
+			Close();
+		}
+
+		void Write(const void* Data, size_t Size)
+		{
+			if (File != nullptr && Size > 0 && std::fwrite(Data, 1, Size, File) != Size)
+				bError = true;
+			Position += Size;
+		}
+
+		template<typename T>
+		void WriteValue(const T& Value)
+		{
+			Write(&Value, sizeof(Value));
+		}
+
+		void Print(const char* Format, ...)
+#if defined(__GNUC__)
+			__attribute__((format(printf, 2, 3)))
+#endif
+		;
+
+		void PadTo(uint64_t Offset)
+		{
+			static const uint8_t Zeros[ColumnarAlignment] = {};
+			while (Position < Offset)
+				Write(Zeros, static_cast<size_t>(std::min<uint64_t>(Offset - Position, sizeof(Zeros))));
+		}
+
+		bool Close()
+		{
+			if (File != nullptr)
+			{
+				bError |= std::fclose(File) != 0;
+				File = nullptr;
+				return !bError;
+			}
+			return false;
+		}
+
+		bool IsOpen() const { return File != nullptr; }
+
+	private:
+		FILE* File;
+		uint64_t Position = 0;
+		bool bError = false;
+	};
+
+	void FileWriter::Print(const char* Format, ...)
+	{
+		char Line[1024];
+		va_list Args;
+		va_start(Args, Format);
+		const int Length = std::vsnprintf(Line, sizeof(Line), Format, Args);
+		va_end(Args);
+		if (Length > 0)
+			Write(Line, std::min<size_t>(static_cast<size_t>(Length), sizeof(Line) - 1));
+	}
+
+	uint64_t Align(uint64_t Value)
+	{
+		return (Value + ColumnarAlignment - 1) & ~uint64_t(ColumnarAlignment - 1);
+	}
+
+	std::string EscapeJson(const std::string& Value)
+	{
+		std::string Escaped;
+		Escaped.reserve(Value.size());
+		for (const char Char : Value)
+		{
+			if (Char == '"' || Char == '\\')
+			{
+				Escaped += '\\';
+				Escaped += Char;
+			}
+			else if (static_cast<unsigned char>(Char) < 0x20)
+			{
+				char Code[8];
+				std::snprintf(Code, sizeof(Code), "\\u%04x", Char);
+				Escaped += Code;
+			}
+			else
+			{
+				Escaped += Char;
+			}
+		}
+		return Escaped;
+	}
+
+	/**
+	 * Writes the columnar file: a header and channel table, each channel as one array, then the frame index.
+	 * Fills in the channel offsets. FramesOffset is where the first frame starts in the capture file
+	 */
+	bool WriteColumnar(const std::string& Path, const sct::Capture& Capture, int64_t FramesOffset, const Columns& Columns, std::vector<Channel>& Channels, uint64_t& OutIndexOffset)
+	{
+		const int32_t FrameCount = Capture.FrameCount;
+		uint64_t Offset = Align(ColumnarHeaderSize + Channels.size() * ChannelEntrySize);
+		for (Channel& Channel : Channels)
+		{
+			Channel.Offset = Offset;
+			Offset = Align(Offset + Channel.GetSize(FrameCount));
+		}
+		OutIndexOffset = Offset;
+
+		FileWriter Writer(Path);
+		if (!Writer.IsOpen())
+			return false;
+
+		Writer.WriteValue(ColumnarMagic);
+		Writer.WriteValue(ColumnarVersion);
+		Writer.WriteValue(FrameCount);
+		Writer.WriteValue(static_cast<int32_t>(Channels.size()));
+		Writer.WriteValue(OutIndexOffset);
+
+		for (const Channel& Channel : Channels)
+		{
+			char Name[32] = {};
+			std::strncpy(Name, Channel.Name.c_str(), sizeof(Name) - 1);
+			Writer.Write(Name, sizeof(Name));
+			Writer.WriteValue(static_cast<int32_t>(Channel.Type));
+			Writer.WriteValue(Channel.Components);
+			Writer.WriteValue(Channel.Offset);
+			Writer.WriteValue(Channel.GetSize(FrameCount));
+		}
+
+		for (const Channel& Channel : Channels)
+		{
+			Writer.PadTo(Channel.Offset);
+			Writer.Write(Channel.Data, static_cast<size_t>(Channel.GetSize(FrameCount)));
+		}
+
+		// The same entries as the .idx next to recordings: where the frame is in the capture and its timestamp
+		Writer.PadTo(OutIndexOffset);
+		for (int32_t i = 0; i < FrameCount; ++i)
+		{
+			Writer.WriteValue(static_cast<int64_t>(FramesOffset + int64_t(i) * Capture.FrameSize));
+			Writer.WriteValue(Columns.Timestamps[i]);
+		}
+
+		return Writer.Close();
+	}
+
+	bool WriteJson(const std::string& Path, const std::string& Source, const sct::Capture& Capture, const Columns& Columns, const std::vector<Channel>& Channels, uint64_t IndexOffset)
+	{
+		FileWriter Writer(Path);
+		if (!Writer.IsOpen())
+			return false;
+
+		const sct::CaptureHeader& Header = Capture.Header;
+		const int32_t FrameCount = Capture.FrameCount;
+		const double Duration = FrameCount > 1 ? Columns.Timestamps[FrameCount - 1] - Columns.Timestamps[0] : 0.0;
+
+		Writer.Print("{\n");
+		Writer.Print("\t\"source\": \"%s\",\n", EscapeJson(Source).c_str());
+		Writer.Print("\t\"version\": %d,\n", Header.Version);
+		Writer.Print("\t\"capture_type\": \"%s\",\n", Capture.IsSkeleton() ? "skeleton" : "camera");
+		Writer.Print("\t\"frame_count\": %d,\n", FrameCount);
+		Writer.Print("\t\"header_frame_count\": %d,\n", Header.FrameCount);
+		Writer.Print("\t\"duration\": %.9g,\n", Duration);
+		Writer.Print("\t\"frame_rate\": %.9g,\n", Duration > 0.0 ? (FrameCount - 1) / Duration : 0.0);
+		Writer.Print("\t\"device_orientation\": %d,\n", Header.DeviceOrientation);
+		Writer.Print("\t\"horizontal_fov\": %.9g,\n", Header.HorizontalFOV);
+		Writer.Print("\t\"vertical_fov\": %.9g,\n", Header.VerticalFOV);
+		Writer.Print("\t\"focal_length_x\": %.9g,\n", Header.FocalLengthX);
+		Writer.Print("\t\"focal_length_y\": %.9g,\n", Header.FocalLengthY);
+
+		Writer.Print("\t\"user_anchors\": [");
+		for (size_t i = 0; i < Capture.UserAnchors.size(); ++i)
+		{
+			const sct::Vec3& Anchor = Capture.UserAnchors[i];
+			Writer.Print("%s[%.9g, %.9g, %.9g]", i > 0 ? ", " : "", Anchor.X, Anchor.Y, Anchor.Z);
+		}
+		Writer.Print("],\n");
+
+		if (Capture.IsSkeleton())
+		{
+			const sct::SkeletonDefinition& Skeleton = Capture.Skeleton;
+			Writer.Print("\t\"skeleton\": {\n\t\t\"joint_names\": [");
+			for (size_t i = 0; i < Skeleton.JointNames.size(); ++i)
+			{
+				Writer.Print("%s\"%s\"", i > 0 ? ", " : "", EscapeJson(Skeleton.JointNames[i]).c_str());
+			}
+			Writer.Print("],\n\t\t\"parent_indices\": [");
+			for (size_t i = 0; i < Skeleton.ParentIndices.size(); ++i)
+			{
+				Writer.Print("%s%d", i > 0 ? ", " : "", Skeleton.ParentIndices[i]);
+			}
+			Writer.Print("],\n\t\t\"neutral_transforms\": [");
+			for (size_t i = 0; i < Skeleton.NeutralTransforms.size(); ++i)
+			{
+				const float* M = &Skeleton.NeutralTransforms[i].M[0][0];
+				Writer.Print("%s\n\t\t\t[", i > 0 ? "," : "");
+				for (int32_t Value = 0; Value < 16; ++Value)
+				{
+					Writer.Print("%s%.9g", Value > 0 ? ", " : "", M[Value]);
+				}
+				Writer.Print("]");
+			}
+			Writer.Print("\n\t\t]\n\t},\n");
+		}
+
+		Writer.Print("\t\"index_offset\": %llu,\n", static_cast<unsigned long long>(IndexOffset));
+		Writer.Print("\t\"channels\": [\n");
+		for (size_t i = 0; i < Channels.size(); ++i)
+		{
+			const Channel& Channel = Channels[i];
+			Writer.Print("\t\t{ \"name\": \"%s\", \"type\": \"%s\", \"components\": %d, \"offset\": %llu, \"size\": %llu }%s\n",
+				Channel.Name.c_str(), Channel.Type == ChannelType::Float64 ? "float64" : "float32", Channel.Components,
+				static_cast<unsigned long long>(Channel.Offset), static_cast<unsigned long long>(Channel.GetSize(FrameCount)),
+				i + 1 < Channels.size() ? "," : "");
+		}
+		Writer.Print("\t]\n}\n");
+
+		return Writer.Close();
+	}
+
+	/** One row per frame with the camera fields and the position of every joint */
+	bool WriteCsv(const std::string& Path, const sct::Capture& Capture, const Columns& Columns)
+	{
+		FileWriter Writer(Path);
+		if (!Writer.IsOpen())
+			return false;
+
+		const int32_t JointCount = Capture.GetJointCount();
+		Writer.Print("frame,timestamp,position_x,position_y,position_z,roll,pitch,yaw,exposure_offset,exposure_duration");
+		for (int32_t Joint = 0; Joint < JointCount; ++Joint)
+		{
+			const char* Name = Capture.Skeleton.JointNames[Joint].c_str();
+			Writer.Print(",%s_x,%s_y,%s_z", Name, Name, Name);
+		}
+		Writer.Print("\n");
+
+		for (int32_t i = 0; i < Capture.FrameCount; ++i)
+		{
+			const sct::Vec3& Position = Columns.Positions[i];
+			const sct::Vec3& Rotation = Columns.Rotations[i];
+			Writer.Print("%d,%.17g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.17g", i, Columns.Timestamps[i],
+				Position.X, Position.Y, Position.Z, Rotation.X, Rotation.Y, Rotation.Z,
+				Columns.ExposureOffsets[i], Columns.ExposureDurations[i]);
+
+			const sct::Matrix4* Joints = Columns.Joints.data() + size_t(i) * JointCount;
+			for (int32_t Joint = 0; Joint < JointCount; ++Joint)
+			{
+				const float* Translation = Joints[Joint].M[3];
+				Writer.Print(",%.9g,%.9g,%.9g", Translation[0], Translation[1], Translation[2]);
+			}
+			Writer.Print("\n");
+		}
+
+		return Writer.Close();
+	}
+
+	struct Result
+	{
+		bool bSuccess = false;
+		std::string Message;
+		int32_t FrameCount = 0;
+		uint64_t BytesRead = 0;
+	};
+
+	Result ConvertCapture(const std::string& Input, const Options& Options, Columns& Columns)
+	{
+		Result Result;
+		if (!ReadFile(Input, Columns.FileData))
+		{
+			Result.Message = "Could not read the file";
+			return Result;
+		}
+		Result.BytesRead = Columns.FileData.size();
+
+		sct::Capture Capture;
+		if (!sct::ParseCapture(Columns.FileData.data(), Columns.FileData.size(), Capture, Result.Message))
+			return Result;
+
+		Columns.Decode(Capture);
+
+		const int32_t JointCount = Capture.GetJointCount();
+		std::vector<Channel> Channels =
+		{
+			{ "timestamp", ChannelType::Float64, 1, Columns.Timestamps.data(), 0 },
+			{ "camera_position", ChannelType::Float32, 3, Columns.Positions.data(), 0 },
+			{ "camera_rotation", ChannelType::Float32, 3, Columns.Rotations.data(), 0 },
+			{ "exposure_offset", ChannelType::Float32, 1, Columns.ExposureOffsets.data(), 0 },
+			{ "exposure_duration", ChannelType::Float64, 1, Columns.ExposureDurations.data(), 0 },
+		};
+		if (JointCount > 0)
+		{
+			Channels.push_back({ "joint_transforms", ChannelType::Float32, 16 * JointCount, Columns.Joints.data(), 0 });
+		}
+
+		const std::string Stem = GetOutputStem(Input, Options);
+		const int64_t FramesOffset = static_cast<int64_t>(Capture.FrameData - Columns.FileData.data());
+		uint64_t IndexOffset = 0;
+		if (!WriteColumnar(Stem + ".sctc", Capture, FramesOffset, Columns, Channels, IndexOffset))
+		{
+			Result.Message = "Could not write " + Stem + ".sctc";
+			return Result;
+		}
+		if (!WriteJson(Stem + ".json", Input, Capture, Columns, Channels, IndexOffset))
+		{
+			Result.Message = "Could not write " + Stem + ".json";
+			return Result;
+		}
+		if (Options.bCsv && !WriteCsv(Stem + ".csv", Capture, Columns))
+		{
+			Result.Message = "Could not write " + Stem + ".csv";
+			return Result;
+		}
+
+		Result.bSuccess = true;
+		Result.FrameCount = Capture.FrameCount;
+		if (Capture.FrameCount != Capture.Header.FrameCount)
+		{
+			Result.Message = "header says " + std::to_string(Capture.Header.FrameCount) + " frames, converted the " + std::to_string(Capture.FrameCount) + " in the file";
+		}
+		return Result;
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	if (Argc < 2)
+	{
+		std::fprintf(stderr, "Usage: %s <capture.dat or directory>... [--out directory] [--csv] [--threads N]\n", Argv[0]);
+		return 1;
+	}
+
+	Options Options;
+	int Threads = static_cast<int>(std::thread::hardware_concurrency());
+	std::vector<std::string> Inputs;
+
+	for (int i = 1; i < Argc; ++i)
+	{
+		const std::string Arg = Argv[i];
+		const bool bHasValue = i + 1 < Argc;
+		if (Arg == "--out" && bHasValue) Options.OutDirectory = Argv[++i];
+		else if (Arg == "--threads" && bHasValue) Threads = std::atoi(Argv[++i]);
+		else if (Arg == "--csv") Options.bCsv = true;
+		else if (Arg.compare(0, 2, "--") == 0)
+		{
+			std::fprintf(stderr, "Unknown argument %s\n", Arg.c_str());
+			return 1;
+		}
+		else if (IsDirectory(Arg)) FindCaptures(Arg, Inputs);
+		else Inputs.push_back(Arg);
+	}
+
+	if (Inputs.empty())
+	{
+		std::fprintf(stderr, "No captures found\n");
+		return 1;
+	}
+
+	if (!Options.OutDirectory.empty() && !MakeDirectory(Options.OutDirectory))
+	{
+		std::fprintf(stderr, "Could not create %s\n", Options.OutDirectory.c_str());
+		return 1;
+	}
+
+	Threads = std::max(1, std::min(Threads, static_cast<int>(Inputs.size())));
+	std::printf("Converting %zu captures on %d threads\n", Inputs.size(), Threads);
+	std::fflush(stdout);
+
+	std::atomic<size_t> NextInput(0);
+	std::atomic<int> Failures(0);
+	std::atomic<uint64_t> TotalFrames(0);
+	std::atomic<uint64_t> TotalBytes(0);
+	std::mutex PrintLock;
+	const double StartTime = Seconds();
+
+	// Captures are independent, each thread takes the next one until none are left
+	auto Work = [&]()
+	{
+		Columns Columns;
+		for (size_t Index = NextInput++; Index < Inputs.size(); Index = NextInput++)
+		{
+			const Result Result = ConvertCapture(Inputs[Index], Options, Columns);
+			if (Result.bSuccess)
+			{
+				TotalFrames += static_cast<uint64_t>(Result.FrameCount);
+				TotalBytes += Result.BytesRead;
+			}
+			else
+			{
+				++Failures;
+			}
+
+			std::lock_guard<std::mutex> Lock(PrintLock);
+			if (Result.bSuccess)
+				std::printf("%s: %d frames%s%s\n", Inputs[Index].c_str(), Result.FrameCount, Result.Message.empty() ? "" : ", ", Result.Message.c_str());
+			else
+				std::fprintf(stderr, "%s: %s\n", Inputs[Index].c_str(), Result.Message.c_str());
+			std::fflush(stdout);
+		}
+	};
+
+	std::vector<std::thread> Workers;
+	for (int i = 1; i < Threads; ++i)
+	{
+		Workers.emplace_back(Work);
+	}
+	Work();
+	for (std::thread& Worker : Workers)
+	{
+		Worker.join();
+	}
+
+	const double Elapsed = std::max(Seconds() - StartTime, 1e-6);
+	std::printf("Converted %zu of %zu captures, %llu frames in %.2f s, %.1f MB/s converted\n", Inputs.size() - Failures, Inputs.size(),
+		static_cast<unsigned long long>(TotalFrames.load()), Elapsed, TotalBytes / Elapsed / (1024.0 * 1024.0));
+
+	return Failures > 0 ? 1 : 0;
+}
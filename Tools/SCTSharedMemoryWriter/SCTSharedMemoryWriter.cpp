@@ -0,0 +1,486 @@
+/*
+MIT License
+
+Copyright (c) 2020 Kodholmen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Writes an SCT capture into the shared memory ring read by the SCT Live Link source, as a stand-in for a
+// companion process on the same machine. See "Shared Memory" in Protocol.md.
+//
+// SCTSharedMemoryWriter <capture.dat> [--name SCTLive] [--size bytes] [--streams N] [--speed X] [--fast] [--loop] [--duration seconds]
+//
+// Start the source first with the connection string "SharedMemory=SCTLive", the writer only attaches to its ring and
+// --size must match the source's SharedMemorySize. The writer reports the achieved frame rate and how long records
+// sat in the ring before the source released them.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <intrin.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// Must match kh::FSpscByteRing in Plugins/SCT/Source/SCT/Private/SCTSpscRing.h
+	const uint32_t RingMagic = 0x53435452;
+	const uint32_t WrapMarker = 0xFFFFFFFF;
+	const uint32_t RecordHeaderSize = 8;
+
+	struct RingHeader
+	{
+		uint32_t Magic;
+		uint32_t Capacity;
+		uint8_t Pad0[56];
+		volatile int64_t WriteOffset;
+		uint8_t Pad1[56];
+		volatile int64_t ReadOffset;
+		uint8_t Pad2[56];
+	};
+	static_assert(sizeof(RingHeader) == 192, "Ring header layout is shared with the plugin");
+
+	const uint8_t PacketHeader = 0;
+	const uint8_t PacketCameraFrame = 1;
+	const uint8_t PacketSkeletonFrame = 2;
+	const int32_t CameraFrameSize = 44;
+	const int32_t SkeletonJointSize = 64;
+
+	int64_t LoadAcquire(volatile int64_t* Ptr)
+	{
+#if defined(_MSC_VER)
+		const int64_t Value = *Ptr;
+		_ReadWriteBarrier();
+		return Value;
+#else
+		return __atomic_load_n(Ptr, __ATOMIC_ACQUIRE);
+#endif
+	}
+
+	void StoreRelease(volatile int64_t* Ptr, int64_t Value)
+	{
+#if defined(_MSC_VER)
+		_ReadWriteBarrier();
+		*Ptr = Value;
+#else
+		__atomic_store_n(Ptr, Value, __ATOMIC_RELEASE);
+#endif
+	}
+
+	uint32_t AlignRecord(uint32_t Size)
+	{
+		return (RecordHeaderSize + Size + 7) & ~7u;
+	}
+
+	/** Producer side of the plugin's single producer, single consumer ring */
+	class RingWriter
+	{
+	public:
+		/** The source initializes the ring, the writer only attaches to one of the size it expects */
+		bool Attach(void* Memory, size_t MemorySize)
+		{
+			RingHeader* NewHeader = static_cast<RingHeader*>(Memory);
+			const uint32_t Magic = NewHeader->Magic;
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			if (Magic != RingMagic)
+			{
+				std::fprintf(stderr, "Shared memory holds no ring, start the source first\n");
+				return false;
+			}
+
+			const uint32_t ExpectedCapacity = static_cast<uint32_t>((MemorySize - sizeof(RingHeader)) & ~size_t(7));
+			if (NewHeader->Capacity != ExpectedCapacity)
+			{
+				std::fprintf(stderr, "Ring holds %u bytes but %u were expected, match --size to the source's SharedMemorySize\n", NewHeader->Capacity, ExpectedCapacity);
+				return false;
+			}
+
+			Header = NewHeader;
+			Data = static_cast<uint8_t*>(Memory) + sizeof(RingHeader);
+			Capacity = Header->Capacity;
+			LastWriteEnd = LoadAcquire(&Header->WriteOffset);
+			return true;
+		}
+
+		/** Returns false if the record doesn't fit right now */
+		bool Write(const uint8_t* Prefix, uint32_t PrefixSize, const uint8_t* Payload, uint32_t PayloadSize)
+		{
+			const uint32_t Size = PrefixSize + PayloadSize;
+			const uint32_t RecordSize = AlignRecord(Size);
+			if (RecordSize > Capacity / 2)
+				return false;
+
+			int64_t WriteOffset = Header->WriteOffset;
+			const int64_t ReadOffset = LoadAcquire(&Header->ReadOffset);
+
+			uint32_t Pos = static_cast<uint32_t>(WriteOffset % Capacity);
+			const uint32_t ToEnd = Capacity - Pos;
+			const uint32_t Needed = ToEnd < RecordSize ? ToEnd + RecordSize : RecordSize;
+			if (Capacity - (WriteOffset - ReadOffset) < Needed)
+				return false;
+
+			if (ToEnd < RecordSize)
+			{
+				*reinterpret_cast<uint32_t*>(Data + Pos) = WrapMarker;
+				WriteOffset += ToEnd;
+				Pos = 0;
+			}
+
+			*reinterpret_cast<uint32_t*>(Data + Pos) = Size;
+			std::memcpy(Data + Pos + RecordHeaderSize, Prefix, PrefixSize);
+			std::memcpy(Data + Pos + RecordHeaderSize + PrefixSize, Payload, PayloadSize);
+
+			LastWriteEnd = WriteOffset + RecordSize;
+			StoreRelease(&Header->WriteOffset, LastWriteEnd);
+			return true;
+		}
+
+		int64_t GetReadOffset() const { return LoadAcquire(&Header->ReadOffset); }
+		int64_t GetLastWriteEnd() const { return LastWriteEnd; }
+
+	private:
+		RingHeader* Header = nullptr;
+		uint8_t* Data = nullptr;
+		uint32_t Capacity = 0;
+		int64_t LastWriteEnd = 0;
+	};
+
+	/** Opens the region the source created, never creates it */
+	void* MapSharedMemory(const std::string& Name, size_t Size)
+	{
+#if defined(_WIN32)
+		HANDLE Mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, Name.c_str());
+		if (Mapping == nullptr)
+			return nullptr;
+		return MapViewOfFile(Mapping, FILE_MAP_ALL_ACCESS, 0, 0, Size);
+#else
+		// Unreal prefixes the name with a slash on POSIX platforms
+		const std::string PosixName = "/" + Name;
+		const int Handle = shm_open(PosixName.c_str(), O_RDWR, 0);
+		if (Handle < 0)
+			return nullptr;
+
+		struct stat Stat;
+		if (fstat(Handle, &Stat) != 0 || static_cast<size_t>(Stat.st_size) < Size)
+		{
+			close(Handle);
+			return nullptr;
+		}
+
+		void* Memory = mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_SHARED, Handle, 0);
+		close(Handle);
+		return Memory == MAP_FAILED ? nullptr : Memory;
+#endif
+	}
+
+	struct Capture
+	{
+		std::vector<uint8_t> Bytes;
+		size_t HeaderEnd = 0;
+		size_t FrameSize = 0;
+		size_t FrameCount = 0;
+		bool bIsSkeleton = false;
+
+		const uint8_t* GetFrame(size_t Index) const { return Bytes.data() + HeaderEnd + Index * FrameSize; }
+
+		/** Camera timestamps are stored as big endian doubles */
+		double GetTimestamp(size_t Index) const
+		{
+			const uint8_t* Camera = GetFrame(Index) + FrameSize - CameraFrameSize;
+			uint64_t Bits = 0;
+			for (int i = 0; i < 8; ++i)
+			{
+				Bits = (Bits << 8) | Camera[i];
+			}
+			double Value;
+			std::memcpy(&Value, &Bits, sizeof(Value));
+			return Value;
+		}
+	};
+
+	bool ReadInt32(const std::vector<uint8_t>& Bytes, size_t& Offset, int32_t& OutValue)
+	{
+		if (Offset + 4 > Bytes.size())
+			return false;
+		std::memcpy(&OutValue, Bytes.data() + Offset, 4);
+		Offset += 4;
+		return true;
+	}
+
+	bool LoadCapture(const char* Path, Capture& Out)
+	{
+		std::ifstream File(Path, std::ios::binary);
+		if (!File)
+			return false;
+		Out.Bytes.assign(std::istreambuf_iterator<char>(File), std::istreambuf_iterator<char>());
+
+		// [Header][User Anchors][Skeleton Definition, skeleton captures only][Frames]
+		const size_t HeaderSize = 32;
+		size_t Offset = HeaderSize;
+		if (Out.Bytes.size() < HeaderSize)
+			return false;
+
+		int32_t CaptureType = 0;
+		std::memcpy(&CaptureType, Out.Bytes.data() + 28, 4);
+		Out.bIsSkeleton = CaptureType == 0;
+
+		int32_t AnchorCount = 0;
+		if (!ReadInt32(Out.Bytes, Offset, AnchorCount) || AnchorCount < 0)
+			return false;
+		Offset += size_t(AnchorCount) * 12;
+
+		int32_t JointCount = 0;
+		if (Out.bIsSkeleton)
+		{
+			if (!ReadInt32(Out.Bytes, Offset, JointCount) || JointCount < 0)
+				return false;
+			for (int32_t i = 0; i < JointCount; ++i)
+			{
+				int32_t Length = 0;
+				if (!ReadInt32(Out.Bytes, Offset, Length) || Length < 0)
+					return false;
+				Offset += Length;
+			}
+
+			int32_t ParentCount = 0;
+			if (!ReadInt32(Out.Bytes, Offset, ParentCount) || ParentCount < 0)
+				return false;
+			Offset += size_t(ParentCount) * 4 + size_t(JointCount) * SkeletonJointSize;
+		}
+
+		if (Offset > Out.Bytes.size())
+			return false;
+
+		Out.HeaderEnd = Offset;
+		Out.FrameSize = CameraFrameSize + (Out.bIsSkeleton ? 4 + size_t(JointCount) * SkeletonJointSize : 0);
+		Out.FrameCount = (Out.Bytes.size() - Offset) / Out.FrameSize;
+		return Out.FrameCount > 0;
+	}
+
+	double Seconds()
+	{
+		using namespace std::chrono;
+		return duration<double>(steady_clock::now().time_since_epoch()).count();
+	}
+
+	struct PendingRecord
+	{
+		int64_t WriteEnd;
+		double WriteTime;
+	};
+
+	double Percentile(std::vector<double>& Values, double P)
+	{
+		if (Values.empty())
+			return 0.0;
+		const size_t Index = std::min(Values.size() - 1, static_cast<size_t>(P * (Values.size() - 1) + 0.5));
+		std::nth_element(Values.begin(), Values.begin() + Index, Values.end());
+		return Values[Index];
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	if (Argc < 2)
+	{
+		std::fprintf(stderr, "Usage: %s <capture.dat> [--name SCTLive] [--size bytes] [--streams N] [--speed X] [--fast] [--loop] [--duration seconds]\n", Argv[0]);
+		return 1;
+	}
+
+	std::string Name = "SCTLive";
+	size_t MemorySize = sizeof(RingHeader) + 4 * 1024 * 1024;
+	int Streams = 1;
+	double Speed = 1.0;
+	bool bFast = false;
+	bool bLoop = false;
+	double Duration = 0.0;
+
+	for (int i = 2; i < Argc; ++i)
+	{
+		const std::string Arg = Argv[i];
+		const bool bHasValue = i + 1 < Argc;
+		if (Arg == "--name" && bHasValue) Name = Argv[++i];
+		else if (Arg == "--size" && bHasValue) MemorySize = sizeof(RingHeader) + std::strtoull(Argv[++i], nullptr, 10);
+		else if (Arg == "--streams" && bHasValue) Streams = std::max(1, std::atoi(Argv[++i]));
+		else if (Arg == "--speed" && bHasValue) Speed = std::max(0.01, std::atof(Argv[++i]));
+		else if (Arg == "--duration" && bHasValue) Duration = std::atof(Argv[++i]);
+		else if (Arg == "--fast") bFast = true;
+		else if (Arg == "--loop") bLoop = true;
+		else
+		{
+			std::fprintf(stderr, "Unknown argument %s\n", Arg.c_str());
+			return 1;
+		}
+	}
+
+	Capture Capture;
+	if (!LoadCapture(Argv[1], Capture))
+	{
+		std::fprintf(stderr, "Could not read capture %s\n", Argv[1]);
+		return 1;
+	}
+
+	void* Memory = MapSharedMemory(Name, MemorySize);
+	if (Memory == nullptr)
+	{
+		std::fprintf(stderr, "Could not open shared memory %s of %zu bytes, start the source first with a matching SharedMemorySize\n", Name.c_str(), MemorySize);
+		return 1;
+	}
+
+	RingWriter Ring;
+	if (!Ring.Attach(Memory, MemorySize))
+		return 1;
+
+	std::printf("Writing %zu %s frames to %s as %d streams\n", Capture.FrameCount, Capture.bIsSkeleton ? "skeleton" : "camera", Name.c_str(), Streams);
+
+	// Records are [Stream Id uint32][Packet Type uint8][Sequence uint32][Payload]
+	std::vector<uint8_t> HeaderPayload(Capture.Bytes.begin(), Capture.Bytes.begin() + Capture.HeaderEnd);
+	uint8_t Prefix[9];
+	uint32_t Sequence = 0;
+
+	std::deque<PendingRecord> Pending;
+	std::vector<double> Latencies;
+	uint64_t FullStalls = 0;
+
+	auto CollectLatencies = [&]()
+	{
+		const int64_t ReadOffset = Ring.GetReadOffset();
+		const double Now = Seconds();
+		while (!Pending.empty() && Pending.front().WriteEnd <= ReadOffset)
+		{
+			Latencies.push_back(Now - Pending.front().WriteTime);
+			Pending.pop_front();
+		}
+	};
+
+	const double StartTime = Seconds();
+	auto IsPastDuration = [&]()
+	{
+		return Duration > 0.0 && Seconds() - StartTime >= Duration;
+	};
+
+	// Returns false if the duration ran out while waiting for room
+	auto WriteRecord = [&](uint32_t StreamId, uint8_t PacketType, uint32_t PacketSequence, const uint8_t* Payload, size_t PayloadSize)
+	{
+		std::memcpy(Prefix, &StreamId, 4);
+		Prefix[4] = PacketType;
+		std::memcpy(Prefix + 5, &PacketSequence, 4);
+
+		// The ring is lossless, wait for the source to catch up rather than drop
+		while (!Ring.Write(Prefix, sizeof(Prefix), Payload, static_cast<uint32_t>(PayloadSize)))
+		{
+			++FullStalls;
+			CollectLatencies();
+			if (IsPastDuration())
+				return false;
+			std::this_thread::yield();
+		}
+		Pending.push_back(PendingRecord{ Ring.GetLastWriteEnd(), Seconds() });
+		return true;
+	};
+
+	const double FirstTimestamp = Capture.GetTimestamp(0);
+	const double LoopLength = Capture.FrameCount > 1 ? (Capture.GetTimestamp(Capture.FrameCount - 1) - FirstTimestamp) * Capture.FrameCount / (Capture.FrameCount - 1) : 1.0 / 60.0;
+	double LastHeaderTime = -1.0;
+	uint64_t FramesWritten = 0;
+	const uint8_t FramePacketType = Capture.bIsSkeleton ? PacketSkeletonFrame : PacketCameraFrame;
+
+	for (size_t Loop = 0; ; ++Loop)
+	{
+		for (size_t Frame = 0; Frame < Capture.FrameCount; ++Frame)
+		{
+			const double CaptureTime = Capture.GetTimestamp(Frame) - FirstTimestamp + Loop * LoopLength;
+			if (!bFast)
+			{
+				const double DueTime = StartTime + CaptureTime / Speed;
+				while (Seconds() < DueTime)
+				{
+					CollectLatencies();
+					std::this_thread::sleep_for(std::chrono::microseconds(100));
+				}
+			}
+
+			const double Now = Seconds();
+			if (IsPastDuration())
+				goto Done;
+
+			// Resend the header once a second so a source that starts later picks the streams up
+			if (LastHeaderTime < 0.0 || Now - LastHeaderTime >= 1.0)
+			{
+				for (int Stream = 0; Stream < Streams; ++Stream)
+				{
+					if (!WriteRecord(Stream, PacketHeader, 0, HeaderPayload.data(), HeaderPayload.size()))
+						goto Done;
+				}
+				LastHeaderTime = Now;
+			}
+
+			++Sequence;
+			for (int Stream = 0; Stream < Streams; ++Stream)
+			{
+				if (!WriteRecord(Stream, FramePacketType, Sequence, Capture.GetFrame(Frame), Capture.FrameSize))
+					goto Done;
+			}
+			++FramesWritten;
+			CollectLatencies();
+		}
+
+		if (!bLoop)
+			break;
+	}
+
+Done:
+	// Give the source a moment to drain so the last records are measured too
+	const double DrainStart = Seconds();
+	while (!Pending.empty() && Seconds() - DrainStart < 1.0)
+	{
+		CollectLatencies();
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+
+	const double Elapsed = std::max(1e-9, Seconds() - StartTime);
+	std::printf("Wrote %llu frames per stream in %.2f s, %.1f frames/s per stream, %.1f frames/s total\n",
+		static_cast<unsigned long long>(FramesWritten), Elapsed, FramesWritten / Elapsed, FramesWritten * Streams / Elapsed);
+	std::printf("Ring full stalls: %llu, records never released: %zu\n", static_cast<unsigned long long>(FullStalls), Pending.size());
+	if (!Latencies.empty())
+	{
+		std::printf("Time in ring (ms): p50 %.3f, p99 %.3f, max %.3f\n", Percentile(Latencies, 0.5) * 1000.0, Percentile(Latencies, 0.99) * 1000.0, Percentile(Latencies, 1.0) * 1000.0);
+	}
+
+	return 0;
+}